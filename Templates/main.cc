@@ -32,7 +32,11 @@ void usage(char* name)
 		 << "\t\t\t  The format of the string is " << endl
 		 << "\t\t\t  \"analyzerName:param=val;param=val&analyzerName:param=val&...\"" << endl;
 	cout << "  -d/--downscaling\t: Activate downscaling (dowscaling factor in .settingsna62file)." << endl;
+	cout << "  --sample fraction\t: Process a uniform sample of this fraction of the events of all the input files." << endl
+		 << "\t\t\t  Whole clusters of entries are selected, the others are not read (SamplingSeed in .settingsna62)." << endl;
 	cout << "  --histo\t\t: Read histograms only and bypass TTree reading." << endl;
+	cout << "  --columns\t\t: Read column files (written with --make-columns) instead of TTrees." << endl
+		 << "\t\t\t  The analyzers access the columns with GetColumn()." << endl;
 	cout << "  --start int\t\t: Index of the first event to process." << endl
 		 << "\t\t\t  Event index starts at 0." << endl;
 	cout << "  --config path\t\t: Path to a configuration file containing analyzers parameters." << endl;
@@ -40,8 +44,46 @@ void usage(char* name)
 	cout << "  --ignore\t\t: Ignore non-existing trees and continue processing." << endl;
 	cout << "  --logtofile path\t: Write the log output to the specified file instead of standard output." << endl;
 	cout << "  --fast-start\t: Start processing immediately without reading input files headers." << endl;
-	cout << "  --prim path\t: Path to a primitive ROOT file." << endl;
 	cout << "\t\t\t Can be useful on CASTOR but total number of events is not known a priori" << endl;
+	cout << "\t\t\t (the files are counted in background, see ScanThreads in the settings file)" << endl;
+	cout << "  --stream\t\t: Read the input files one at a time, opening the next one in advance." << endl
+		 << "\t\t\t  The memory used does not depend on the number of files. Implies --fast-start." << endl;
+	cout << "  --prim path\t: Path to a primitive ROOT file." << endl;
+	cout << "  --latency path\t: Dump the event processing time distribution and the burst rates in a JSON file." << endl;
+	cout << "  --trace path\t: Record the timeline of the processing in a Chrome trace-event JSON file." << endl;
+	cout << "  --count-alloc\t: Count the heap allocations per event and per analyzer (framework built with --count-allocations)." << endl;
+	cout << "  --compression string\t: Compression settings of the output trees (overrides the settings file)." << endl
+		 << "\t\t\t  The format of the string is" << endl
+		 << "\t\t\t  \"TreeName=algorithm:level[:basketSize[:autoFlush]],...\"" << endl
+		 << "\t\t\t  TreeName can be Default (all trees) or File (output file)." << endl;
+	cout << "  --skim-entrylist\t: Write the (file, entry) list of the exported events instead of copying them." << endl;
+	cout << "  --friend path\t: Path to a ROOT file containing friend trees (written with Analyzer::OpenFriendTree)." << endl
+		 << "\t\t\t  The requested trees found in this file are read alongside the input files." << endl
+		 << "\t\t\t  Can be used several times." << endl;
+	cout << "  --checkpoint int\t: Write the histograms, counters and last processed event in a checkpoint file" << endl
+		 << "\t\t\t  (outFile.checkpoint.root) every int events." << endl;
+	cout << "  --resume\t\t: Restore the histograms and counters from the checkpoint file and continue" << endl
+		 << "\t\t\t  from the next event. The events exported before the checkpoint are not restored." << endl;
+	cout << "  --events path\t: Path to a text file listing the events to read, one per line:" << endl
+		 << "\t\t\t  \"run burst eventNumber\" or \"run burst timeStampMin timeStampMax\"." << endl
+		 << "\t\t\t  The events are located with the event index (EventIndex in the settings file)." << endl;
+	cout << "  --make-columns path\t: Write the projections requested by the analyzers (RequestProjection) and the" << endl
+		 << "\t\t\t  --column-fields of each processed event in a column file, read with --columns." << endl;
+	cout << "  --column-fields string: Comma separated list of data members written with --make-columns:" << endl
+		 << "\t\t\t  \"Tree:Branch.member,...\" (e.g. Reco:Spectrometer.fCandidates.fMomentum)." << endl;
+	cout << "  --profile-branches path: Record which requested branches are retrieved by each analyzer and write" << endl
+		 << "\t\t\t  the branch usage profile in this file at the end of the processing." << endl;
+	cout << "  --use-profile path\t: Do not read the requested branches never retrieved according to this branch" << endl
+		 << "\t\t\t  usage profile (--profile-branches) and prefetch exactly the used ones." << endl;
+	cout << "  --make-tags path\t: Write the tags set by the analyzers (Analyzer::SetTag) for each processed event" << endl
+		 << "\t\t\t  in a tag file, used by later jobs with --tags and --tag-select." << endl;
+	cout << "  --tags path\t\t: Path to a tag file written with --make-tags, used with --tag-select." << endl;
+	cout << "  --tag-select string\t: Only read the events of the tag file matching this tag expression" << endl
+		 << "\t\t\t  (tag names combined with !, &&, || and parenthesis, quote the names with spaces)." << endl;
+	cout << "  --scan string\t\t: Process several parameter sets of the same analyzers in a single pass." << endl
+		 << "\t\t\t  The format is the format of -p with comma separated values:" << endl
+		 << "\t\t\t  \"analyzerName:param=val1,val2;param=val1,val2&analyzerName:...\" (or a config file)." << endl
+		 << "\t\t\t  One copy of the analyzer (analyzerName_scanN) is created per combination of values." << endl;
 	cout << endl;
 	cout << "Mutually exclusive options groups:" << endl;
 	cout << " Group1:" << endl;
@@ -52,6 +94,9 @@ void usage(char* name)
 	cout << "  -B/-b/--nfiles int\t: Maximum number of files to process from the list. (Default: All)" << endl
 		 << "\t\t\t  !Warning. When using -g option, do not use the -b but -B or --nfiles." << endl;
 	cout << "  --continous \t\t: Use continuous reading (automatically enables -g" << endl;
+	cout << " Group3:" << endl;
+	cout << "  --entrylist path\t: Path to a ROOT file containing an entry list written with --skim-entrylist." << endl
+		 << "\t\t\t  Only the listed events are read." << endl;
 	cout << endl << endl;
 }
 
@@ -86,6 +131,9 @@ int main(int argc, char** argv){
 	TString argTS;
 	TString logFile;
 	TString primFile;
+	TString latencyFile;
+	TString traceFile;
+	TString compression;
 
 	int NEvt = 0;
 	int evtNb = -1;
@@ -107,6 +155,24 @@ int main(int argc, char** argv){
 	int flIgnoreNonExisting = 0;
 	int flContinuousReading = 0;
 	int flFastStart = 0;
+	int flStream = 0;
+	int flCountAlloc = 0;
+	int flSkimEntryList = 0;
+	int flResume = 0;
+	int flColumns = 0;
+	Long64_t checkpoint = -1;
+	bool entryList = false;
+	std::vector<TString> friendFiles;
+	TString eventSelection;
+	TString columnFile;
+	TString columnFields;
+	TString branchProfileOutput;
+	TString branchProfile;
+	double sampling = 0;
+	TString tagOutput;
+	TString tagFile;
+	TString tagExpression;
+	TString parameterScan;
 
 	struct option longopts[] = {
 			{ "list",		required_argument,	NULL,					'l'},
@@ -123,11 +189,32 @@ int main(int argc, char** argv){
 			{ "logtofile",	required_argument,	NULL,					'3'},
 			{ "continuous",	no_argument,		&flContinuousReading,	1},
 			{ "fast-start",	no_argument,		&flFastStart,			1},
+			{ "stream",		no_argument,		&flStream,				1},
 			{ "prim",		required_argument,	NULL,					'4'},
+			{ "latency",	required_argument,	NULL,					'5'},
+			{ "trace",		required_argument,	NULL,					'6'},
+			{ "count-alloc",no_argument,		&flCountAlloc,			1},
+			{ "compression",required_argument,	NULL,					'7'},
+			{ "entrylist",	required_argument,	NULL,					'8'},
+			{ "skim-entrylist",no_argument,		&flSkimEntryList,		1},
+			{ "friend",		required_argument,	NULL,					'9'},
+			{ "checkpoint",	required_argument,	NULL,					'c'},
+			{ "resume",		no_argument,		&flResume,				1},
+			{ "events",		required_argument,	NULL,					'e'},
+			{ "columns",	no_argument,		&flColumns,				1},
+			{ "make-columns",required_argument,	NULL,					'm'},
+			{ "column-fields",required_argument,NULL,					'f'},
+			{ "profile-branches",required_argument,NULL,				'r'},
+			{ "use-profile",required_argument,	NULL,					'u'},
+			{ "sample",		required_argument,	NULL,					's'},
+			{ "make-tags",	required_argument,	NULL,					't'},
+			{ "tags",		required_argument,	NULL,					'a'},
+			{ "tag-select",	required_argument,	NULL,					'x'},
+			{ "scan",		required_argument,	NULL,					'k'},
 			{0,0,0,0}
 	};
 
-	while ((opt = getopt_long(argc, argv, "hi:v:gl:B:b:n:o:p:0:1:2:3:4:d", longopts, NULL)) != -1) {
+	while ((opt = getopt_long(argc, argv, "hi:v:gl:B:b:n:o:p:0:1:2:3:4:5:6:7:8:9:c:e:m:f:r:u:s:t:a:x:k:d", longopts, NULL)) != -1) {
 		n_options_read++;
 		switch (opt) {
 		// Short options only cases
@@ -189,6 +276,57 @@ int main(int argc, char** argv){
 			primFile = TString(optarg);
 			usePrim = true;
 			break;
+		case '5': /* latency JSON file, long_option: latency */
+			latencyFile = TString(optarg);
+			break;
+		case '6': /* trace JSON file, long_option: trace */
+			traceFile = TString(optarg);
+			break;
+		case '7': /* output trees compression, long_option: compression */
+			compression = TString(optarg);
+			break;
+		case '8': /* entry list input file, long_option: entrylist */
+			if(!NFiles) NFiles = -1;
+			inFileName = TString(optarg);
+			fromList = true;
+			entryList = true;
+			break;
+		case '9': /* friend trees file, long_option: friend */
+			friendFiles.push_back(TString(optarg));
+			break;
+		case 'c': /* checkpoint interval, long_option: checkpoint */
+			checkpoint = TString(optarg).Atoll();
+			break;
+		case 'e': /* event selection file, long_option: events */
+			eventSelection = TString(optarg);
+			break;
+		case 'm': /* column file to write, long_option: make-columns */
+			columnFile = TString(optarg);
+			break;
+		case 'f': /* fields of the column file, long_option: column-fields */
+			columnFields = TString(optarg);
+			break;
+		case 'r': /* branch usage profile to write, long_option: profile-branches */
+			branchProfileOutput = TString(optarg);
+			break;
+		case 'u': /* branch usage profile to apply, long_option: use-profile */
+			branchProfile = TString(optarg);
+			break;
+		case 's': /* fraction of the events to process, long_option: sample */
+			sampling = TString(optarg).Atof();
+			break;
+		case 't': /* tag file to write, long_option: make-tags */
+			tagOutput = TString(optarg);
+			break;
+		case 'a': /* tag file to read, long_option: tags */
+			tagFile = TString(optarg);
+			break;
+		case 'x': /* tag expression, long_option: tag-select */
+			tagExpression = TString(optarg);
+			break;
+		case 'k': /* parameter scan specification, long_option: scan */
+			parameterScan = TString(optarg);
+			break;
 
 		case 0: /* getopt_long() set a variable, continue */
 			break;
@@ -210,6 +348,11 @@ int main(int argc, char** argv){
 		return EXIT_FAILURE;
 	}
 
+	if((tagFile.Length()>0) != (tagExpression.Length()>0)){
+		cerr << "Options --tags and --tag-select must be used together" << endl;
+		return EXIT_FAILURE;
+	}
+
 	ignoreNonExisting = flIgnoreNonExisting;
 	readPlots = flReadPlots;
 	continuousReading = flContinuousReading;
@@ -226,10 +369,32 @@ int main(int argc, char** argv){
 	ban->SetGraphicMode(graphicMode);
 	ban->SetDownscaling(downscaling);
 	if(readPlots) ban->SetReadType(NA62Analysis::Core::IOHandlerType::kHISTO);
+	else if(flColumns) ban->SetReadType(NA62Analysis::Core::IOHandlerType::kCOLUMNS);
 	else ban->SetReadType(NA62Analysis::Core::IOHandlerType::kTREE);
 	if(usePrim) ban->InitPrimitives();
 	if(fastStart) ban->SetFastStart(fastStart);
 	if(continuousReading) ban->SetContinuousReading(flContinuousReading);
+	if(latencyFile.Length()>0) ban->SetLatencyFile(latencyFile);
+	if(traceFile.Length()>0) ban->SetTraceFile(traceFile);
+	if(flCountAlloc) ban->SetAllocationCounting(true);
+	if(compression.Length()>0) ban->SetOutputSettings(compression);
+	if(entryList) ban->SetEntryListInput(true);
+	if(flSkimEntryList) ban->SetEntryListExport(true);
+	if(flStream) ban->SetStreaming(true);
+	for(auto friendFile : friendFiles) ban->AddFriendFile(friendFile);
+	if(checkpoint>=0) ban->SetCheckpoint(checkpoint);
+	if(flResume) ban->SetResume(true);
+	if(eventSelection.Length()>0) ban->SetEventSelection(eventSelection);
+	if(columnFile.Length()>0) ban->SetColumnOutput(columnFile, columnFields);
+	if(sampling>0) ban->SetSampling(sampling);
+	if(branchProfileOutput.Length()>0) ban->SetBranchProfileOutput(branchProfileOutput);
+	if(tagOutput.Length()>0) ban->SetTagOutput(tagOutput);
+	if(tagFile.Length()>0) ban->SetTagSelection(tagFile, tagExpression);
+	if(parameterScan.Length()>0) ban->SetParameterScan(parameterScan);
+	if(branchProfile.Length()>0 && !ban->UseBranchProfile(branchProfile)){
+		delete ban;
+		return EXIT_FAILURE;
+	}
 	//DEF_ANALYZER is the ClassName of the analyzer. Defined by Makefile target
 /*$$ANALYZERSNEW$$*/
 
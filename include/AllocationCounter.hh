@@ -0,0 +1,131 @@
+/*
+ * AllocationCounter.hh
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ncl
+ */
+
+#ifndef ALLOCATIONCOUNTER_HH_
+#define ALLOCATIONCOUNTER_HH_
+
+#include <cstddef>
+#include <vector>
+
+#include <TString.h>
+
+namespace NA62Analysis {
+namespace Core {
+
+/// \class AllocationCounter
+/// \Brief
+/// Count the heap allocations and attribute them to the running analyzer
+/// \EndBrief
+///
+/// \Detailed
+/// With the ALLOCATION_COUNTER build option, the global operator new and operator delete are
+/// replaced (in src/alloc/AllocationHooks.cc, linked in the executable) by versions calling
+/// malloc/free and reporting to this class. Without it, IsAvailable() is false and nothing is
+/// counted. The allocations are counted
+/// only between Start() and Stop() and only for the thread that called Start(); the cost
+/// when not counting is a single test of a thread-local flag.\n
+/// Allocations are attributed to the current slot (see SetSlot()). The processing loop
+/// sets the slot to the framework while reading and writing events, and to the index of
+/// the analyzer before calling it. The number of allocations per event is obtained by
+/// calling EndEvent() at the end of each event.\n
+/// Only allocations going through operator new are seen (not direct malloc calls from C
+/// libraries).
+/// \EndDetailed
+class AllocationCounter {
+public:
+	static const int fgMaxSlots = 256; ///< Maximum number of slots
+
+	static void Start();
+	static void Stop();
+	static void Reset();
+	static void EndEvent(Long64_t iEvent);
+	static void Print(const std::vector<TString> &slotNames, Long64_t nEvents);
+
+	static bool IsAvailable() {
+		/// \MemberDescr
+		/// \return True if the allocation functions are replaced (ALLOCATION_COUNTER build option)
+		/// \EndMemberDescr
+		return fAvailable;
+	}
+	static void SetAvailable() {
+		/// \MemberDescr
+		/// Called when the replaced allocation functions are loaded
+		/// \EndMemberDescr
+		fAvailable = true;
+	}
+	static bool IsCounting() {
+		/// \MemberDescr
+		/// \return True if the allocations of the calling thread are being counted
+		/// \EndMemberDescr
+		return fCounting;
+	}
+	static void SetSlot(int slot) {
+		/// \MemberDescr
+		/// \param slot : Index of the slot to which the following allocations are attributed
+		/// \EndMemberDescr
+		fSlot = (slot>=0 && slot<fgMaxSlots) ? slot : fgMaxSlots-1;
+	}
+	static void RecordAllocation(std::size_t size) {
+		/// \MemberDescr
+		/// \param size : Number of bytes requested
+		///
+		/// Called by operator new
+		/// \EndMemberDescr
+		if(!fCounting) return;
+		++fNAllocations[fSlot];
+		fBytes[fSlot] += size;
+		++fTotalAllocations;
+	}
+	static void RecordFree() {
+		/// \MemberDescr
+		/// Called by operator delete
+		/// \EndMemberDescr
+		if(!fCounting) return;
+		++fNFrees[fSlot];
+	}
+
+	static Long64_t GetNAllocations(int slot) {
+		/// \MemberDescr
+		/// \param slot : Index of the slot
+		/// \return Number of allocations in the slot
+		/// \EndMemberDescr
+		return fNAllocations[slot];
+	}
+	static Long64_t GetNFrees(int slot) {
+		/// \MemberDescr
+		/// \param slot : Index of the slot
+		/// \return Number of deallocations in the slot
+		/// \EndMemberDescr
+		return fNFrees[slot];
+	}
+	static Long64_t GetBytes(int slot) {
+		/// \MemberDescr
+		/// \param slot : Index of the slot
+		/// \return Number of bytes allocated in the slot
+		/// \EndMemberDescr
+		return fBytes[slot];
+	}
+
+private:
+	AllocationCounter(); ///< Non implemented constructor (static class)
+
+	static bool fAvailable; ///< Are the allocation functions replaced
+	static thread_local bool fCounting; ///< Are the allocations of this thread counted
+	static int fSlot; ///< Slot to which the allocations are currently attributed
+	static Long64_t fNAllocations[fgMaxSlots]; ///< Number of allocations per slot
+	static Long64_t fNFrees[fgMaxSlots]; ///< Number of deallocations per slot
+	static Long64_t fBytes[fgMaxSlots]; ///< Number of bytes allocated per slot
+	static Long64_t fTotalAllocations; ///< Number of allocations in all slots
+	static Long64_t fLastEventAllocations; ///< Value of fTotalAllocations at the end of the previous event
+	static Long64_t fMaxEventAllocations; ///< Largest number of allocations in a single event
+	static Long64_t fMaxEvent; ///< Index of the event with the largest number of allocations
+};
+
+} /* namespace Core */
+} /* namespace NA62Analysis */
+
+#endif /* ALLOCATIONCOUNTER_HH_ */
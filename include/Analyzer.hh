@@ -6,6 +6,8 @@
 #include "NA62Constants.hh"
 #include "UserMethods.hh"
 #include "IOHandler.hh"
+#include "TimeCounter.h"
+#include "OutputTreeSettings.hh"
 #include "containers.hh"
 
 //TODO remove these 2 lines
@@ -29,6 +31,8 @@ class Analyzer : public UserMethods
 public:
 	/// Possible states for the analyzer
 	enum AnalyzerState {kReady, kUninit};
+	/// Processing phases of the analyzer for which the time is measured
+	enum TimingPhase {kTimeProcess, kTimePostProcess, kTimeUpdatePlots, kTimeStartOfBurst, kTimeEndOfBurst, kTimeMCSimple, kTimeNPhases};
 
 	Analyzer(Core::BaseAnalysis* ba);
 	Analyzer(Core::BaseAnalysis* ba, std::string name);
@@ -70,15 +74,64 @@ public:
 		/// \MemberDescr Executed at start of burst (new file). No default action to do.
 		/// \EndMemberDescr
 	};
+	virtual void EndOfPassUser() {
+		/// \MemberDescr Executed at the end of each pass of a multi-pass analysis (see EnableMultiPass()).
+		/// No default action to do.
+		/// \EndMemberDescr
+	};
 
 	//Analyzer name
 	void PrintName() const;
 	TString GetAnalyzerName() const ;
+	void SetAnalyzerName(TString name);
 	void PrintInitSummary() const;
 
 	//Methods for exporting an event
 	void ExportEvent();
+	void ExportEvent(TString streamName);
 	bool GetExportEvent() const;
+	const std::vector<TString>& GetExportStreams() const {
+		/// \MemberDescr
+		/// \return Names of the streams to which the current event is exported
+		/// \EndMemberDescr
+		return fExportStreams;
+	}
+
+	Core::HistoHandler* GetHistoHandler() {
+		/// \MemberDescr
+		/// \return Pointer to the plots booked by the analyzer
+		/// \EndMemberDescr
+		return &fHisto;
+	}
+
+	//Methods for event tags
+	void DefineTag(TString name);
+	void SetTag(TString name, bool value=true);
+
+	//Methods for multi-pass analysis
+	void EnableMultiPass(bool selectEvents=false);
+	void CacheEvent();
+	void RequestAnotherPass();
+	int GetPass() const;
+	bool EndOfPass();
+	bool IsMultiPass() const {
+		/// \MemberDescr
+		/// \return True if the analyzer called EnableMultiPass()
+		/// \EndMemberDescr
+		return fMultiPass;
+	}
+	bool GetSelectCachedEvents() const {
+		/// \MemberDescr
+		/// \return True if the analyzer selects the events kept for the next passes with CacheEvent()
+		/// \EndMemberDescr
+		return fSelectCachedEvents;
+	}
+	bool GetCacheEvent() const {
+		/// \MemberDescr
+		/// \return True if the analyzer called CacheEvent() for the current event
+		/// \EndMemberDescr
+		return fCacheEvent;
+	}
 
 	//Methods for output trees
 	void OpenNewTree(TString name, TString title);
@@ -96,10 +149,19 @@ public:
 		}
 		else{
 			fOutTree[name]->Branch(branchName, pointer);
+			Core::OutputTreeSettings::GetInstance()->Apply(fOutTree[name]);
 		}
 	}
 	void FillTrees();
 	void WriteTrees();
+	void OpenFriendTree(TString name, TString title);
+	void FillFriendTrees();
+	bool HasFriendTrees() const {
+		/// \MemberDescr
+		/// \return True if the analyzer created friend trees with OpenFriendTree()
+		/// \EndMemberDescr
+		return fFriendTree.size()>0;
+	}
 	void CreateStandardTree(TString name, TString title);
 	KinePart* CreateStandardCandidate(TString treeName);
 
@@ -136,6 +198,16 @@ public:
 	double compareToReferencePlot(TString h1, bool KS);
 	void FillMCSimple(Event* mcTruthEvent);
 
+	//Timing
+	TimeCounter& GetTimeCounter(TimingPhase phase) {
+		/// \MemberDescr
+		/// \param phase : Processing phase
+		/// \return Reference to the time counter of the requested processing phase
+		/// \EndMemberDescr
+		return fTimeCounter[phase];
+	}
+	static TString GetTimingPhaseName(TimingPhase phase);
+
 
 protected:
 	//Internal methods used for setting parameters
@@ -153,6 +225,7 @@ protected:
 	DetectorAcceptance *fDetectorAcceptanceInstance; ///< Pointer to DetectorAcceptance instance. Initialize if used.
 
 	std::map<TString,TTree*> fOutTree; ///< Container for the output TTrees
+	std::map<TString,TTree*> fFriendTree; ///< Output TTrees filled for every event (subset of fOutTree)
 
 	//Parameters container
 	std::map<TString,param_t, NA62CaseIgnorecomp> fParams; ///< Container for parameters
@@ -160,6 +233,12 @@ protected:
 	AnalyzerState fState; ///< State of the analyzer
 
 	bool fExportEvent; ///< Do we request to export this event?
+	std::vector<TString> fExportStreams; ///< Named streams to which this event is exported
+
+	bool fMultiPass; ///< Does the analyzer need the events in several passes?
+	bool fSelectCachedEvents; ///< Are the events kept for the next passes selected with CacheEvent()?
+	bool fCacheEvent; ///< Do we keep this event for the next passes?
+	bool fAnotherPass; ///< Do we request another pass over the events?
 
 	std::map<TString, TClonesArray> fExportCandidates; ///< Array containing candidates to be recorded in the standard output tree
 	std::map<TString, int> fExportCandidatesNumber; ///< Number of Export candidates
@@ -167,6 +246,8 @@ protected:
 	ParticleInterface *fParticleInterface; ///< Pointer to the ParticleInterface instance
 
 	MCSimple fMCSimple; ///< MCSimple instance
+
+	TimeCounter fTimeCounter[kTimeNPhases]; ///< Time counters for each processing phase
 };
 
 } /* namespace NA62Analysis */
@@ -10,6 +10,10 @@
 #include "containers.hh"
 #include "Verbose.hh"
 #include "TimeCounter.h"
+#include "LatencyMonitor.hh"
+#include "OutputTreeSettings.hh"
+#include "EventTags.hh"
+#include "ParameterScan.hh"
 
 #include <TSemaphore.h>
 
@@ -29,6 +33,7 @@ namespace Core {
 
 class OMMainWindow;
 class IOPrimitive;
+class IOColumns;
 
 class BaseAnalysis: public Verbose {
 public:
@@ -36,6 +41,24 @@ public:
 	~BaseAnalysis();
 
 	void AddAnalyzer(Analyzer * const an);
+	void SetParameterScan(TString scan);
+	template <class T>
+	void AddScanCopies(T * const an) {
+		/// \MemberDescr
+		/// \param an : Pointer to the analyzer, already added with AddAnalyzer
+		///
+		/// If the analyzer is scanned (see SetParameterScan), it processes the first scan point
+		/// and a copy is created for each other point, named analyzerName_scanN. The copies are
+		/// added right after the analyzer and are deleted with BaseAnalysis.
+		/// \EndMemberDescr
+		TString name = an->GetAnalyzerName();
+		int nPoints = fParameterScan.GetNPoints(name);
+		if (nPoints == 0)
+			return;
+		fScanPoints[name] = std::make_pair(name, 0);
+		for (int i = 1; i < nPoints; i++)
+			AddScanCopy(an, new T(this), i);
+	}
 	void StartContinuous(TString inFileList);
 	void Init(TString inFileName, TString outFileName, TString params,
 			TString configFile, Int_t NFiles, TString refFile,
@@ -52,15 +75,24 @@ public:
 	DetectorAcceptance *IsDetectorAcceptanceInstanciated() const;
 
 	void PrintInitSummary() const;
+	void PrintTimingSummary(Long64_t nEvents, float loopTime) const;
+	void WriteTimingSummary(Long64_t nEvents) const;
 
 	void CheckNewFileOpened();
 
 	IOHandler * GetIOHandler();
 	IOTree * GetIOTree();
 	IOHisto * GetIOHisto();
+	IOColumns * GetIOColumns();
 	IOPrimitive * GetIOPrimitive();
 
 	CounterHandler* GetCounterHandler();
+	EventTags* GetEventTags() {
+		/// \MemberDescr
+		/// \return Pointer to the tags of the current event
+		/// \EndMemberDescr
+		return &fEventTags;
+	}
 
 	Long64_t GetNEvents();
 	TChain* GetTree(TString name);
@@ -80,6 +112,12 @@ public:
 		return fIOHandler->GetIOType() == IOHandlerType::kTREE;
 	}
 	;
+	bool IsColumnType() {
+		/// \MemberDescr
+		/// \return true if IO Handler reads column files
+		/// \EndMemberDescr
+		return fIOHandler->GetIOType() == IOHandlerType::kCOLUMNS;
+	}
 
 	void SetGraphicMode(bool bVal) {
 		/// \MemberDescr
@@ -91,6 +129,7 @@ public:
 	void SetReadType(IOHandlerType type);
 	void SetContinuousReading(bool flagContinuousReading);
 	void SetDownscaling(bool flagDownscaling);
+	void SetSampling(double fraction);
 	void SetFastStart(bool bVal) {
 		/// \MemberDescr
 		/// \param bVal : true/false
@@ -100,6 +139,92 @@ public:
 		fIOHandler->SetFastStart(bVal);
 	}
 	void SetPrimitiveFile(TString fileName);
+	void SetTraceFile(TString fileName);
+	void SetEntryListInput(bool bVal);
+	void SetEntryListExport(bool bVal);
+	void SetStreaming(bool bVal);
+	void SetColumnOutput(TString fileName, TString fieldList);
+	void SetBranchProfileOutput(TString fileName);
+	bool UseBranchProfile(TString fileName);
+	void AddFriendFile(TString fileName);
+	void SetLatencyFile(TString fileName) {
+		/// \MemberDescr
+		/// \param fileName : Path to the JSON file
+		///
+		/// Dump the event processing time distribution and the burst rates in this JSON file
+		/// at the end of the processing
+		/// \EndMemberDescr
+		fLatencyFile = fileName;
+	}
+	void SetEventSelection(TString fileName) {
+		/// \MemberDescr
+		/// \param fileName : Path to a text file listing the events to read
+		///
+		/// Only read the listed events (run, burst, event number or timestamp ranges),
+		/// located with the event index (see EventIndex)
+		/// \EndMemberDescr
+		fIOHandler->SetEventSelection(fileName);
+	}
+	void SetTagOutput(TString fileName) {
+		/// \MemberDescr
+		/// \param fileName : Path of the tag file to write
+		///
+		/// Write the tags set by the analyzers for each processed event in this file
+		/// (see EventTags)
+		/// \EndMemberDescr
+		fTagOutput = fileName;
+	}
+	void SetTagSelection(TString tagFile, TString expression) {
+		/// \MemberDescr
+		/// \param tagFile : Path to a tag file written with --make-tags
+		/// \param expression : Tag expression the events must match
+		///
+		/// Only read the events matching the tag expression according to the tag file
+		/// \EndMemberDescr
+		fIOHandler->SetTagSelection(tagFile, expression);
+	}
+	void SetOutputSettings(TString settingsList) {
+		/// \MemberDescr
+		/// \param settingsList : Comma separated list of TreeName=algorithm:level[:basketSize[:autoFlush]]
+		///
+		/// Set the compression settings of the output trees (overrides the settings file)
+		/// \EndMemberDescr
+		OutputTreeSettings::GetInstance()->SetSettingsList(settingsList);
+	}
+	void SetCheckpoint(Long64_t nEvents) {
+		/// \MemberDescr
+		/// \param nEvents : Number of events between two checkpoints (disabled if 0)
+		///
+		/// Periodically write the histograms, the counters and the last processed entry
+		/// in OutputFile.checkpoint.root (overrides the CheckpointEvents setting)
+		/// \EndMemberDescr
+		fCheckpointEvents = nEvents;
+	}
+	void SetResume(bool bVal) {
+		/// \MemberDescr
+		/// \param bVal : true/false
+		///
+		/// Restore the histograms and counters from the checkpoint file and continue the
+		/// processing from the entry following the last checkpointed one
+		/// \EndMemberDescr
+		fResume = bVal;
+	}
+	void SetAllocationCounting(bool bVal) {
+		/// \MemberDescr
+		/// \param bVal : true/false
+		///
+		/// Enable/Disable the counting of the heap allocations during the event loop
+		/// \EndMemberDescr
+		fCountAllocations = bVal;
+	}
+
+	int GetPass() const {
+		/// \MemberDescr
+		/// \return Index of the current pass over the events (0 for the first pass, see
+		/// Analyzer::EnableMultiPass)
+		/// \EndMemberDescr
+		return fPass;
+	}
 
 	void ReconfigureAnalyzer(TString analyzerName, TString parameterName,
 			TString parameter);
@@ -108,11 +233,28 @@ private:
 	BaseAnalysis(const BaseAnalysis&); ///< Prevents copy construction
 	BaseAnalysis& operator=(const BaseAnalysis&); ///< Prevents copy assignment
 	void PreProcess();
+	bool ProcessEvent(Long64_t iEvent);
+	Long64_t ProcessNextPasses(int i_offset, int defaultPrecision,
+			TimeCounter &processTime);
+	bool EndOfPass();
 	void printCurrentEvent(Long64_t iEvent, Long64_t totalEvents,
 			int defaultPrecision, std::string displayType,
 			TimeCounter startTime);
 	static void ContinuousLoop(void* args);
 	void CreateOMWindow();
+	void PrintAllocationSummary(Long64_t nEvents) const;
+	void WriteEventStreams();
+	TString GetCheckpointFileName() const;
+	void WriteCheckpoint(Long64_t lastEntry);
+	Long64_t ReadCheckpoint();
+	bool IsClusterSampled(Long64_t clusterEnd) const;
+	void AddScanCopy(Analyzer * const reference, Analyzer * const copy, int point);
+
+	/// \enum AllocationSlot
+	/// \Brief
+	/// Slots of AllocationCounter used by the event loop
+	/// \EndBrief
+	enum AllocationSlot {kAllocLoadEvent, kAllocWriteEvent, kAllocAnalyzers};
 
 	/// \struct ThreadArgs_t
 	/// \Brief
@@ -125,12 +267,22 @@ private:
 protected:
 	Long64_t fNEvents; ///< Number of events available in the TChains
 	int fEventsDownscaling; ///< Downscaling. Read 1 out of x events
+	double fSamplingFraction; ///< Fraction of the clusters processed (sampling disabled if 0)
 	bool fGraphicMode; ///< Indicating if we only want output file or display
 	bool fInitialized; ///< Indicate if BaseAnalysis has been initialized
 	bool fContinuousReading; ///< Continuous reading enabled?
 	bool fSignalStop; ///< Stop signal for the Thread
+	bool fCountAllocations; ///< Count the heap allocations during the event loop
+	Long64_t fCheckpointEvents; ///< Number of events between two checkpoints (disabled if 0)
+	int fCheckpointBursts; ///< Number of bursts between two checkpoints (disabled if 0)
+	int fBurstsSinceCheckpoint; ///< Number of bursts since the last checkpoint
+	bool fResume; ///< Resume the processing from the checkpoint file
+	int fPass; ///< Index of the current pass over the events (multi-pass analysis)
 
 	std::vector<Analyzer*> fAnalyzerList; ///< Container for the analyzers
+	std::vector<Analyzer*> fScanCopies; ///< Copies of the scanned analyzers (owned by BaseAnalysis)
+	Configuration::ParameterScan fParameterScan; ///< Parameter scan specification
+	NA62Analysis::NA62Map<TString, std::pair<TString, int> >::type fScanPoints; ///< Scanned analyzer and scan point of each instance of a scanned analyzer
 
 	NA62Analysis::NA62Map<TString, const void* const >::type fOutput; ///< Container for outputs of all analyzers
 	NA62Analysis::NA62Map<TString, Analyzer::OutputState>::type fOutputStates; ///< Container for output states for all analyzers
@@ -142,6 +294,10 @@ protected:
 	IOPrimitive* fIOPrimitive; ///< Pointer to IOPrimitive instance
 
 	TimeCounter fInitTime; ///< Time counter for the initialisation step (from constructor to end of Init())
+	LatencyMonitor fLatency; ///< Distribution of the event processing time and burst rates
+	TString fLatencyFile; ///< Path to the JSON file where fLatency is dumped
+	EventTags fEventTags; ///< Tags of the current event set by the analyzers
+	TString fTagOutput; ///< Path of the tag file to write (disabled if empty)
 
 	TMutex fGraphicalMutex; ///< Mutex to prevent TApplication and BaseAnalysis to perform graphical operation at the same time
 	TThread *fRunThread; ///< Thread for Process during Online Monitor
@@ -0,0 +1,92 @@
+/*
+ * BranchUsageProfile.hh
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ncl
+ */
+
+#ifndef BRANCHUSAGEPROFILE_HH_
+#define BRANCHUSAGEPROFILE_HH_
+
+#include <vector>
+
+#include <TString.h>
+
+#include "containers.hh"
+
+namespace NA62Analysis {
+namespace Core {
+
+/// \class BranchUsageProfile
+/// \Brief
+/// Record which requested branches are used by the analyzers
+/// \EndBrief
+///
+/// \Detailed
+/// In profiling mode (--profile-branches), each retrieval of a requested event or object
+/// (GetEvent, GetObject, GetMCEvent, GetRawHeader, ...) is recorded for the analyzer being
+/// processed (or for the framework outside of Process/PostProcess), and the number of events in
+/// which each analyzer retrieved each branch is written in a text file at the end of the run:
+/// \code
+/// Events	nEvents
+/// Analyzers	Framework	analyzer1	analyzer2 ...
+/// Tree:Branch	nFramework	nAnalyzer1	nAnalyzer2 ...
+/// \endcode
+/// In production mode (--use-profile), the profile is loaded: the requested branches that were
+/// never retrieved are not read, and the TTreeCache is trained with the used branches only.
+/// Branches absent from the profile are considered used. The events and objects of the pruned
+/// branches stay empty, and these branches are not exported.
+/// \EndDetailed
+class BranchUsageProfile {
+public:
+	BranchUsageProfile();
+	virtual ~BranchUsageProfile();
+
+	//Profiling
+	void SetAnalyzers(const std::vector<TString> &names);
+	void SetCurrentAnalyzer(int index) {
+		/// \MemberDescr
+		/// \param index : Index of the analyzer being processed, -1 for the framework
+		/// \EndMemberDescr
+		fCurrentAnalyzer = index+1;
+	}
+	void NewEvent() {
+		/// \MemberDescr
+		/// Signal that a new event is processed
+		/// \EndMemberDescr
+		++fNEvents;
+	}
+	int AddBranch(TString treeName, TString branchName);
+	void Accessed(int branch);
+	bool Save(TString fileName) const;
+	void Print() const;
+
+	//Production
+	bool Load(TString fileName);
+	bool IsUsed(TString treeName, TString branchName) const;
+
+private:
+	BranchUsageProfile(const BranchUsageProfile&); ///< Non implemented copy-constructor (prevents copy)
+	BranchUsageProfile& operator=(const BranchUsageProfile&); ///< Non implemented copy-assignment operator (prevents copy)
+
+	/// \struct Usage
+	/// \Brief
+	/// Usage of a branch by an analyzer
+	/// \EndBrief
+	struct Usage {
+		Long64_t fEvents; ///< Number of events in which the branch was retrieved
+		Long64_t fLastEvent; ///< Last event in which the branch was retrieved
+	};
+
+	Long64_t fNEvents; ///< Number of processed events
+	int fCurrentAnalyzer; ///< Index in fAnalyzers of the analyzer being processed
+	std::vector<TString> fAnalyzers; ///< Framework followed by the analyzers
+	std::vector<TString> fBranches; ///< Recorded branches (Tree:Branch)
+	std::vector<std::vector<Usage> > fUsage; ///< Usage of each branch by each analyzer
+	NA62Analysis::NA62Map<TString, bool>::type fUsed; ///< Loaded profile: is the branch (Tree:Branch) used?
+};
+
+} /* namespace Core */
+} /* namespace NA62Analysis */
+
+#endif /* BRANCHUSAGEPROFILE_HH_ */
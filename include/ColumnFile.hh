@@ -0,0 +1,130 @@
+/*
+ * ColumnFile.hh
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ncl
+ */
+
+#ifndef COLUMNFILE_HH_
+#define COLUMNFILE_HH_
+
+#include <cstddef>
+
+#include <Rtypes.h>
+
+namespace NA62Analysis {
+namespace Core {
+
+/// \struct ColumnFileHeader
+/// \Brief
+/// Header at the beginning of a column file
+/// \EndBrief
+///
+/// \Detailed
+/// A column file contains the values of a fixed list of fields (projected data members, see
+/// IOTree::SetColumnOutput) for each event. The file is made of this header, followed by
+/// fNFields ColumnFileField descriptors, followed by the arrays of each field:
+/// - fNEvents+1 ULong64_t offsets: the values of event i are the values offsets[i] to offsets[i+1]-1
+/// - the values of all the events, as contiguous doubles
+///
+/// All the positions are in bytes from the beginning of the file and are multiples of 8, so
+/// that the arrays can be used in place once the file is mapped in memory (see ColumnReader).
+/// The numbers are written in the byte order of the machine writing the file.
+/// \EndDetailed
+struct ColumnFileHeader {
+	char fMagic[8]; ///< kColumnFileMagic
+	UInt_t fVersion; ///< Version of the format (kColumnFileVersion)
+	UInt_t fNFields; ///< Number of fields
+	ULong64_t fNEvents; ///< Number of events
+};
+
+/// \struct ColumnFileField
+/// \Brief
+/// Descriptor of a field in a column file
+/// \EndBrief
+struct ColumnFileField {
+	char fName[112]; ///< Name of the field (Tree:Branch.member), null-terminated
+	ULong64_t fOffsets; ///< Position of the offsets array
+	ULong64_t fValues; ///< Position of the values array
+	ULong64_t fNValues; ///< Number of values
+};
+
+static const char kColumnFileMagic[8] = {'N','A','6','2','C','O','L','S'}; ///< First bytes of a column file
+static const UInt_t kColumnFileVersion = 1; ///< Version of the column file format written
+
+/// \class ColumnView
+/// \Brief
+/// Read-only view of the values of a field for one event
+/// \EndBrief
+///
+/// \Detailed
+/// The view points directly to the values (mapped column file or loaded projection) and is
+/// valid until the next event is loaded.
+/// \EndDetailed
+class ColumnView {
+public:
+	ColumnView() :
+		fData(nullptr),
+		fSize(0)
+	{
+		/// \MemberDescr
+		/// Constructor of an empty view
+		/// \EndMemberDescr
+	}
+	ColumnView(const double *data, size_t size) :
+		fData(data),
+		fSize(size)
+	{
+		/// \MemberDescr
+		/// \param data : Pointer to the first value
+		/// \param size : Number of values
+		/// \EndMemberDescr
+	}
+
+	size_t size() const {
+		/// \MemberDescr
+		/// \return Number of values
+		/// \EndMemberDescr
+		return fSize;
+	}
+	bool empty() const {
+		/// \MemberDescr
+		/// \return True if there is no value
+		/// \EndMemberDescr
+		return fSize==0;
+	}
+	const double* data() const {
+		/// \MemberDescr
+		/// \return Pointer to the first value
+		/// \EndMemberDescr
+		return fData;
+	}
+	const double* begin() const {
+		/// \MemberDescr
+		/// \return Pointer to the first value
+		/// \EndMemberDescr
+		return fData;
+	}
+	const double* end() const {
+		/// \MemberDescr
+		/// \return Pointer after the last value
+		/// \EndMemberDescr
+		return fData+fSize;
+	}
+	double operator[](size_t i) const {
+		/// \MemberDescr
+		/// \param i : Index of the value
+		/// \return Value (not checked)
+		/// \EndMemberDescr
+		return fData[i];
+	}
+
+private:
+	const double *fData; ///< Pointer to the first value
+	size_t fSize; ///< Number of values
+};
+
+} /* namespace Core */
+} /* namespace NA62Analysis */
+
+#endif /* COLUMNFILE_HH_ */
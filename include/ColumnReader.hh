@@ -0,0 +1,75 @@
+/*
+ * ColumnReader.hh
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ncl
+ */
+
+#ifndef COLUMNREADER_HH_
+#define COLUMNREADER_HH_
+
+#include <TString.h>
+
+#include "ColumnFile.hh"
+
+namespace NA62Analysis {
+namespace Core {
+
+/// \class ColumnReader
+/// \Brief
+/// Read a column file mapped in memory
+/// \EndBrief
+///
+/// \Detailed
+/// The file (see ColumnFileHeader) is mapped read-only in memory and checked when opened. The
+/// values of a field for an event are returned as a ColumnView pointing directly in the mapped
+/// file: nothing is copied or deserialised, the pages are read by the system when first accessed.
+/// Only local files can be mapped.
+/// \EndDetailed
+class ColumnReader {
+public:
+	ColumnReader();
+	virtual ~ColumnReader();
+
+	bool Open(TString fileName);
+	void Close();
+
+	Long64_t GetNEvents() const {
+		/// \MemberDescr
+		/// \return Number of events in the file
+		/// \EndMemberDescr
+		return fHeader ? fHeader->fNEvents : 0;
+	}
+	unsigned int GetNFields() const {
+		/// \MemberDescr
+		/// \return Number of fields in the file
+		/// \EndMemberDescr
+		return fHeader ? fHeader->fNFields : 0;
+	}
+	TString GetFieldName(unsigned int field) const {
+		/// \MemberDescr
+		/// \param field : Index of the field
+		/// \return Name of the field
+		/// \EndMemberDescr
+		return fFields[field].fName;
+	}
+	int GetFieldIndex(TString name) const;
+	ColumnView GetValues(unsigned int field, Long64_t iEvent) const;
+
+private:
+	ColumnReader(const ColumnReader&); ///< Non implemented copy-constructor (prevents copy)
+	ColumnReader& operator=(const ColumnReader&); ///< Non implemented copy-assignment operator (prevents copy)
+
+	bool CheckLayout() const;
+
+	TString fFileName; ///< Path of the mapped file
+	char *fData; ///< Beginning of the mapped file
+	size_t fSize; ///< Size of the mapped file
+	const ColumnFileHeader *fHeader; ///< Header of the mapped file
+	const ColumnFileField *fFields; ///< Field descriptors of the mapped file
+};
+
+} /* namespace Core */
+} /* namespace NA62Analysis */
+
+#endif /* COLUMNREADER_HH_ */
@@ -0,0 +1,74 @@
+/*
+ * ColumnWriter.hh
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ncl
+ */
+
+#ifndef COLUMNWRITER_HH_
+#define COLUMNWRITER_HH_
+
+#include <cstdio>
+#include <vector>
+
+#include <TString.h>
+
+#include "ColumnFile.hh"
+
+namespace NA62Analysis {
+namespace Core {
+
+/// \class ColumnWriter
+/// \Brief
+/// Write the values of a list of fields event by event in a column file
+/// \EndBrief
+///
+/// \Detailed
+/// The values and offsets of each field are appended to anonymous temporary files while the
+/// events are filled, so that the memory used does not depend on the number of events. The
+/// column file (see ColumnFileHeader) is assembled from them by Close().
+/// \EndDetailed
+class ColumnWriter {
+public:
+	ColumnWriter();
+	virtual ~ColumnWriter();
+
+	bool Open(TString fileName, const std::vector<TString> &fields);
+	bool Fill(const std::vector<const std::vector<double>*> &values);
+	bool Close();
+
+	Long64_t GetNEvents() const {
+		/// \MemberDescr
+		/// \return Number of events filled
+		/// \EndMemberDescr
+		return fNEvents;
+	}
+
+private:
+	ColumnWriter(const ColumnWriter&); ///< Non implemented copy-constructor (prevents copy)
+	ColumnWriter& operator=(const ColumnWriter&); ///< Non implemented copy-assignment operator (prevents copy)
+
+	static bool Copy(FILE *source, FILE *target);
+	void CloseTemporaryFiles();
+
+	/// \struct Field
+	/// \Brief
+	/// Field being written
+	/// \EndBrief
+	struct Field {
+		TString fName; ///< Name of the field
+		ULong64_t fNValues; ///< Number of values written
+		FILE *fOffsets; ///< Temporary file of the offsets (end of each event)
+		FILE *fValues; ///< Temporary file of the values
+	};
+
+	bool fFailed; ///< A write failed, the file will not be written
+	TString fFileName; ///< Path of the column file
+	Long64_t fNEvents; ///< Number of events filled
+	std::vector<Field> fFields; ///< Fields written
+};
+
+} /* namespace Core */
+} /* namespace NA62Analysis */
+
+#endif /* COLUMNWRITER_HH_ */
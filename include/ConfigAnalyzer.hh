@@ -48,7 +48,7 @@ public:
 	ConfigAnalyzer(const ConfigAnalyzer& c);
 	virtual ~ConfigAnalyzer();
 
-	void ApplyParams(Analyzer* const analyzer) const;
+	void ApplyParams(Analyzer* const analyzer, TString name="") const;
 	void ParseCLI(TString params);
 };
 
@@ -26,6 +26,30 @@ namespace Configuration {
 /// ProcessOutputNewLine = true|false
 /// SkippedName = NA62Analysis
 /// EventsDownscaling = integer
+/// SkimBranches = Tree:Branch,Branch,...
+/// FastSkim = true|false
+/// WriterQueueSize = integer
+/// RollSize = integer
+/// RollBursts = integer
+/// RollHistograms = true|false
+/// CheckpointEvents = integer
+/// CheckpointBursts = integer
+/// FileCatalog = path
+/// ScanThreads = integer
+/// EventIndex = path
+/// EventCacheSize = integer
+/// EventCacheDir = path
+/// SamplingSeed = integer
+/// StagingDir = path
+/// StagingSize = integer
+/// StagingRemote = prefix,prefix,...
+/// StagingVerify = true|false
+///
+/// [Output]
+/// TreeName = algorithm:level[:basketSize[:autoFlush]]
+///
+/// [Streams]
+/// StreamName = fileName[,Tree:Branch,Branch,...]
 /// \endcode
 /// The currently available settings for NA62Analysis are<br>
 /// UseColors: If true the terminal output can use colors.<br>
@@ -34,7 +58,29 @@ namespace Configuration {
 /// SkippedName: Name for the output file containing the list of skipped input files. The file is named
 /// SkippedName.skipped<br>
 /// EventsDownscaling: Process only 1 events out of EventsDownscaling. This option is activated
-/// with the -d/--downscaling option
+/// with the -d/--downscaling option<br>
+/// SkimBranches: Branches written in the exported trees (all if empty)<br>
+/// FastSkim: Copy the compressed baskets of the input files where all events are exported<br>
+/// WriterQueueSize: Fill the output trees in a background thread with a queue of this size (disabled if 0)<br>
+/// RollSize: Write the exported trees in successive files of about this size in MB (disabled if 0)<br>
+/// RollBursts: Write the exported trees in successive files of this number of bursts (disabled if 0)<br>
+/// RollHistograms: Write a snapshot of the histograms in each of these files<br>
+/// CheckpointEvents: Write a checkpoint every CheckpointEvents processed events (disabled if 0)<br>
+/// CheckpointBursts: Write a checkpoint every CheckpointBursts bursts (disabled if 0)<br>
+/// FileCatalog: Path to the catalog of the input files metadata (see FileCatalog, disabled if empty)<br>
+/// ScanThreads: Number of threads counting the entries of the input files in background with --fast-start (disabled if 0)<br>
+/// EventIndex: Path to the run/burst/event index of the input files used by --events (see EventIndex, not stored if empty)<br>
+/// EventCacheSize: Memory in MB used to keep the events for the next passes of a multi-pass analysis, the
+/// rest is written in a temporary file (see EventCache)<br>
+/// EventCacheDir: Directory of this temporary file (system temporary directory if empty)<br>
+/// SamplingSeed: Seed of the selection of the clusters processed with --sample (the same seed selects the same events)<br>
+/// StagingDir: Directory of the local copies of the remote input files (see StagingCache, disabled if empty)<br>
+/// StagingSize: Maximum size in MB of this directory (the least recently used copies are removed)<br>
+/// StagingRemote: Prefixes of the paths of the remote input files<br>
+/// StagingVerify: Check the MD5 checksum of the local copies before using them (else only their size)<br>
+/// The [Output] section contains the compression settings of the output trees (see OutputTreeSettings).<br>
+/// The [Streams] section defines the output file and the exported branches (SkimBranches if none is given)
+/// of the named export streams (see Analyzer::ExportEvent).
 /// \EndDetailed
 
 class ConfigSettings : public ConfigParser{
@@ -58,6 +104,48 @@ public:
 		static std::string fSkippedName; ///< Name of the .skipped file
 		static std::string fSvcClass; ///< Name of the svcClass
 		static int fEventsDownscaling; ///< Events downscaling. Process only 1 out of fEventsDownscaling
+		static std::string fSkimBranches; ///< Comma separated list of branches written in the exported trees (all if empty)
+		static bool fFastSkim; ///< Copy the compressed baskets of the input files where all events are exported
+		static int fWriterQueueSize; ///< Size of the queue of the background output writer (disabled if 0)
+		static int fRollSize; ///< Size in MB after which the exported trees are written in a new file (disabled if 0)
+		static int fRollBursts; ///< Number of bursts after which the exported trees are written in a new file (disabled if 0)
+		static bool fRollHistograms; ///< Write a snapshot of the histograms in each rolled file
+		static int fCheckpointEvents; ///< Number of events between two checkpoints (disabled if 0)
+		static int fCheckpointBursts; ///< Number of bursts between two checkpoints (disabled if 0)
+		static std::string fFileCatalog; ///< Path to the catalog of the input files metadata (disabled if empty)
+		static int fScanThreads; ///< Number of threads scanning the input files with --fast-start (disabled if 0)
+		static std::string fEventIndex; ///< Path to the run/burst/event index of the input files (not stored if empty)
+		static int fEventCacheSize; ///< Memory in MB of the event cache of multi-pass analyses
+		static std::string fEventCacheDir; ///< Directory of the temporary file of the event cache (system temporary directory if empty)
+		static int fSamplingSeed; ///< Seed of the selection of the sampled clusters
+		static std::string fStagingDir; ///< Directory of the local copies of the remote input files (disabled if empty)
+		static int fStagingSize; ///< Maximum size in MB of the local copies
+		static std::string fStagingRemote; ///< Comma separated list of prefixes of the remote input files
+		static bool fStagingVerify; ///< Check the MD5 checksum of the local copies before using them
+	};
+
+	/// \struct output
+	/// \Brief
+	/// Structure for the output settings.
+	/// \EndBrief
+	///
+	/// \Detailed
+	/// Structure containing the settings from the "Output" section in the settings file.
+	/// \EndDetailed
+	struct output {
+		static std::map<TString, TString> fTreeSettings; ///< Compression settings for each tree name
+	};
+
+	/// \struct streams
+	/// \Brief
+	/// Structure for the export streams settings.
+	/// \EndBrief
+	///
+	/// \Detailed
+	/// Structure containing the settings from the "Streams" section in the settings file.
+	/// \EndDetailed
+	struct streams {
+		static std::map<TString, TString> fStreams; ///< Definition (fileName[,branches]) of each export stream
 	};
 };
 
@@ -13,6 +13,8 @@
 #include "EventFraction.hh"
 #include "containers.hh"
 
+class TDirectory;
+
 namespace NA62Analysis {
 
 /// \class CounterHandler
@@ -50,6 +52,8 @@ public:
 
 	//Output and printing
 	void WriteEventFraction(TString fileName) const;
+	void WriteCounters(TDirectory* dir) const;
+	void ReadCounters(TDirectory* dir);
 	void PrintInitSummary() const;
 
 private:
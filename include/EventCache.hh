@@ -0,0 +1,94 @@
+/*
+ * EventCache.hh
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ncl
+ */
+
+#ifndef EVENTCACHE_HH_
+#define EVENTCACHE_HH_
+
+#include <cstdio>
+#include <vector>
+
+#include <TString.h>
+#include <TBufferFile.h>
+
+namespace NA62Analysis {
+namespace Core {
+
+/// \class EventCache
+/// \Brief
+/// Decompressed copy of the events kept for the next passes of a multi-pass analysis
+/// \EndBrief
+///
+/// \Detailed
+/// During the first pass, the requested events and objects of each selected event are streamed
+/// (decompressed) in a buffer with StartEvent()/EndEvent(). The buffers are kept in memory up to
+/// the given limit, the next ones are appended to a temporary file in the given directory (deleted
+/// with the cache).\n
+/// The next passes read the buffers back with GetEvent() instead of the input files. The index
+/// of each cached event in the first pass is always kept: if the temporary file cannot be written,
+/// the buffers are dropped and GetEvent() returns nullptr, the events must then be read again
+/// from the input files.
+/// \EndDetailed
+class EventCache {
+public:
+	EventCache(Long64_t memoryLimit, TString spillDir);
+	virtual ~EventCache();
+
+	TBufferFile* StartEvent();
+	void EndEvent(Long64_t iEvent);
+
+	Long64_t GetNEvents() const {
+		/// \MemberDescr
+		/// \return Number of cached events
+		/// \EndMemberDescr
+		return fEvents.size();
+	}
+	Long64_t GetEventIndex(Long64_t index) const {
+		/// \MemberDescr
+		/// \param index : Index of the event in the cache
+		/// \return Index of the event in the first pass
+		/// \EndMemberDescr
+		return fEvents[index].fEvent;
+	}
+	TBufferFile* GetEvent(Long64_t index);
+	void PrintSummary() const;
+
+private:
+	EventCache(const EventCache&); ///< Non implemented copy-constructor (prevents copy)
+	EventCache& operator=(const EventCache&); ///< Non implemented copy-assignment operator (prevents copy)
+
+	bool Spill(const char* data, UInt_t size);
+	void DropData();
+
+	/// \struct CachedEvent
+	/// \Brief
+	/// Position of a cached event
+	/// \EndBrief
+	struct CachedEvent {
+		Long64_t fEvent; ///< Index of the event in the first pass
+		Long64_t fMemoryIndex; ///< Index of the buffer in fMemory, -1 if in the temporary file
+		Long64_t fSpillOffset; ///< Position of the buffer in the temporary file
+		UInt_t fSize; ///< Size of the buffer
+	};
+
+	bool fFailed; ///< The buffers could not be kept, only the event indices are available
+	Long64_t fMemoryLimit; ///< Maximum size in bytes of the buffers kept in memory
+	Long64_t fMemorySize; ///< Size in bytes of the buffers kept in memory
+	Long64_t fSpillSize; ///< Size in bytes of the buffers written in the temporary file
+	TString fSpillDir; ///< Directory of the temporary file
+	TString fSpillName; ///< Path of the temporary file (empty if not created)
+	FILE *fSpillFile; ///< Temporary file
+	std::vector<CachedEvent> fEvents; ///< Cached events
+	std::vector<std::vector<char> > fMemory; ///< Buffers kept in memory
+	std::vector<char> fSpillBuffer; ///< Buffer read back from the temporary file
+	TBufferFile fWriteBuffer; ///< Buffer in which the event is streamed
+	TBufferFile fReadBuffer; ///< Buffer from which the event is read back
+};
+
+} /* namespace Core */
+} /* namespace NA62Analysis */
+
+#endif /* EVENTCACHE_HH_ */
@@ -0,0 +1,92 @@
+/*
+ * EventIndex.hh
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ncl
+ */
+
+#ifndef EVENTINDEX_HH_
+#define EVENTINDEX_HH_
+
+#include <vector>
+
+#include <TString.h>
+
+class TEntryList;
+
+namespace NA62Analysis {
+namespace Core {
+
+/// \class EventIndex
+/// \Brief
+/// Persistent index of the events of the input files by run, burst and event number
+/// \EndBrief
+///
+/// \Detailed
+/// For each event of the input files, the index contains the run, burst, event number
+/// and timestamp read from the RawHeader, and the position of the event (file and entry).\n
+/// The index is stored in a ROOT file (EventIndex setting, not stored if empty) with the
+/// size and modification time of each indexed file: when it is updated for a list of input
+/// files, only the new or modified files are read (RawHeader branch only).\n
+/// Select() builds the TEntryList of the events requested in a selection file, so that
+/// only these events are read (see IOHandler::SetEventSelection). Each line of the
+/// selection file is either
+/// \code
+/// run burst eventNumber
+/// run burst timeStampMin timeStampMax
+/// \endcode
+/// where the timestamps are those of the RawHeader. Lines starting with # are ignored.
+/// \EndDetailed
+class EventIndex {
+public:
+	EventIndex();
+	virtual ~EventIndex();
+
+	bool Load(TString fileName);
+	bool Save();
+	bool Update(const std::vector<TString> &inputFiles);
+	TEntryList* Select(TString selectionFile, const std::vector<TString> &inputFiles) const;
+
+private:
+	EventIndex(const EventIndex&); ///< Non implemented copy-constructor (prevents copy)
+	EventIndex& operator=(const EventIndex&); ///< Non implemented copy-assignment operator (prevents copy)
+
+	/// \struct IndexedFile
+	/// \Brief
+	/// Input file in the index
+	/// \EndBrief
+	struct IndexedFile {
+		TString fName; ///< Path of the file
+		TString fTreeName; ///< Name of the tree containing the RawHeader
+		Long64_t fSize; ///< Size of the file when it was indexed
+		Long_t fModTime; ///< Modification time of the file when it was indexed
+		bool fUpdated; ///< Indexed by this job since the index was loaded (not stored)
+	};
+
+	/// \struct IndexedEvent
+	/// \Brief
+	/// Event in the index
+	/// \EndBrief
+	struct IndexedEvent {
+		Int_t fFile; ///< Index of the file in fFiles
+		Long64_t fEntry; ///< Entry of the event in the file
+		Int_t fRun; ///< Run number
+		Int_t fBurst; ///< Burst number
+		UInt_t fEventNumber; ///< Event number
+		UInt_t fTimeStamp; ///< Timestamp of the event in the burst
+	};
+
+	bool IndexFile(TString fileName, Int_t fileIndex);
+	static bool ReadIndex(TString fileName, std::vector<IndexedFile> &indexFiles,
+			std::vector<IndexedEvent> &indexEvents);
+
+	TString fFileName; ///< Path of the index file
+	bool fModified; ///< Has the index been modified since loaded
+	std::vector<IndexedFile> fFiles; ///< Indexed files
+	std::vector<IndexedEvent> fEvents; ///< Indexed events
+};
+
+} /* namespace Core */
+} /* namespace NA62Analysis */
+
+#endif /* EVENTINDEX_HH_ */
@@ -0,0 +1,103 @@
+/*
+ * EventTags.hh
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ncl
+ */
+
+#ifndef EVENTTAGS_HH_
+#define EVENTTAGS_HH_
+
+#include <vector>
+
+#include <TString.h>
+
+#include "containers.hh"
+
+class TFile;
+class TTree;
+class TEntryList;
+
+namespace NA62Analysis {
+namespace Core {
+
+/// \class EventTags
+/// \Brief
+/// Named boolean tags set by the analyzers for each event, written as a bitmask per input entry
+/// \EndBrief
+///
+/// \Detailed
+/// The analyzers define up to 64 named tags (Analyzer::DefineTag) and set them for the events
+/// they are interested in (Analyzer::SetTag). With --make-tags, the tags of each processed event
+/// are written in the tag file: the TTree EventTags contains, for each entry, the index of the
+/// input file, the entry in this file and the 64-bit mask of the tags. The names of the tags
+/// (TList TagNames, bit i for the i-th name) and of the input files and trees (TList TagFiles)
+/// are written in the same file.\n
+/// With --tags and --tag-select, only the tags column of the tag file is read: the entries
+/// matching the expression are selected and only these entries of the input files are read, as
+/// with an entry list. The expression combines tag names with !, &&, || and parenthesis. Names
+/// containing spaces or operators are quoted:
+/// \code
+/// "1 track" && (MuonMUV3 || !GoodVertex)
+/// \endcode
+/// \EndDetailed
+class EventTags {
+public:
+	EventTags();
+	virtual ~EventTags();
+
+	//Tags
+	int DefineTag(TString name);
+	bool SetTag(TString name, bool value);
+	bool IsTagged(TString name) const;
+	void Reset() {
+		/// \MemberDescr
+		/// Clear the tags of the current event
+		/// \EndMemberDescr
+		fTags = 0;
+	}
+	ULong64_t GetTags() const {
+		/// \MemberDescr
+		/// \return Mask of the tags of the current event
+		/// \EndMemberDescr
+		return fTags;
+	}
+
+	//Tag file output
+	bool OpenOutput(TString fileName);
+	bool IsOutputOpen() const {
+		/// \MemberDescr
+		/// \return True if a tag file is being written
+		/// \EndMemberDescr
+		return fTree!=nullptr;
+	}
+	void Fill(TString fileName, TString treeName, Long64_t entry);
+	void CloseOutput();
+
+	//Selection
+	static TEntryList* Select(TString tagFile, TString expression, const std::vector<TString> &inputFiles);
+
+private:
+	EventTags(const EventTags&); ///< Non implemented copy-constructor (prevents copy)
+	EventTags& operator=(const EventTags&); ///< Non implemented copy-assignment operator (prevents copy)
+
+	static bool Compile(TString expression, const std::vector<TString> &names, std::vector<int> &program);
+	static bool Evaluate(const std::vector<int> &program, ULong64_t tags);
+
+	std::vector<TString> fNames; ///< Names of the tags (bit i for the i-th name)
+	ULong64_t fTags; ///< Tags of the current event
+
+	TFile *fFile; ///< Tag file being written
+	TTree *fTree; ///< EventTags tree being written
+	TString fFileName; ///< Path of the tag file being written
+	Int_t fFileIndex; ///< Buffer of the file branch
+	Long64_t fEntry; ///< Buffer of the entry branch
+	ULong64_t fTagsBuffer; ///< Buffer of the tags branch
+	std::vector<std::pair<TString, TString> > fFiles; ///< Input files and trees of the tag file
+	NA62Analysis::NA62Map<TString, int>::type fFileIndices; ///< Index of each input file in fFiles
+};
+
+} /* namespace Core */
+} /* namespace NA62Analysis */
+
+#endif /* EVENTTAGS_HH_ */
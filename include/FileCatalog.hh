@@ -0,0 +1,99 @@
+/*
+ * FileCatalog.hh
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ncl
+ */
+
+#ifndef FILECATALOG_HH_
+#define FILECATALOG_HH_
+
+#include <vector>
+
+#include <TString.h>
+
+#include "containers.hh"
+
+namespace NA62Analysis {
+namespace Core {
+
+/// \class FileCatalog
+/// \Brief
+/// Persistent catalog of the input files metadata
+/// \EndBrief
+///
+/// \Detailed
+/// Unique instance storing, for each input file already opened once, the number of entries
+/// and the top-level branches of each of its trees, and whether the file could be opened.
+/// The records are keyed on the path of the file and are only used if the size and the
+/// modification time of the file did not change.\n
+/// The catalog is a text file (FileCatalog setting, disabled if empty) read when the
+/// instance is created and saved (merged with the records of concurrent jobs, through an
+/// atomic rename) after the input files are registered. The files that could not be opened
+/// are only skipped by the current job. With the catalog, the input files are added to the TChains with their number
+/// of entries and do not need to be opened during the initialisation, giving exact event
+/// counts immediately on reruns (including with --fast-start).
+/// \EndDetailed
+class FileCatalog {
+public:
+	/// \struct TreeInfo
+	/// \Brief
+	/// Metadata of one tree of a file
+	/// \EndBrief
+	struct TreeInfo {
+		Long64_t fEntries; ///< Number of entries
+		std::vector<TString> fBranches; ///< Top-level branches
+	};
+
+	/// \struct FileRecord
+	/// \Brief
+	/// Metadata of one file
+	/// \EndBrief
+	struct FileRecord {
+		Long64_t fSize; ///< Size of the file when it was scanned
+		Long_t fModTime; ///< Modification time of the file when it was scanned
+		bool fValid; ///< Could the file be opened
+		NA62Analysis::NA62Map<TString, TreeInfo>::type fTrees; ///< Trees of the file
+
+		Long64_t GetEntries(TString treeName) const;
+		bool HasBranch(TString treeName, TString branchName) const;
+	};
+
+	virtual ~FileCatalog();
+	static FileCatalog* GetInstance();
+
+	bool Load(TString fileName);
+	bool Save();
+
+	const FileRecord* Find(TString fileName);
+	const FileRecord* Scan(TString fileName);
+	void PrintSummary() const;
+	static bool GetFileInfo(TString fileName, Long64_t &size, Long_t &modTime);
+
+	bool IsEnabled() const {
+		/// \MemberDescr
+		/// \return True if a catalog file is used
+		/// \EndMemberDescr
+		return fFileName.Length()>0;
+	}
+
+private:
+	FileCatalog();
+	FileCatalog(const FileCatalog&); ///< Non implemented copy-constructor (prevents copy)
+	FileCatalog& operator=(const FileCatalog&); ///< Non implemented copy-assignment operator (prevents copy)
+
+	static bool ReadRecords(TString fileName, NA62Analysis::NA62Map<TString, FileRecord>::type &records);
+
+	TString fFileName; ///< Path of the catalog file
+	bool fModified; ///< Has the catalog been modified since loaded
+	int fNHits; ///< Number of files found in the catalog
+	int fNScanned; ///< Number of files scanned and added to the catalog
+	NA62Analysis::NA62Map<TString, FileRecord>::type fRecords; ///< Records for each file path
+
+	static FileCatalog *fFileCatalog; ///< static pointer to unique instance of the class
+};
+
+} /* namespace Core */
+} /* namespace NA62Analysis */
+
+#endif /* FILECATALOG_HH_ */
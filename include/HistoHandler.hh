@@ -20,6 +20,8 @@
 #include "containers.hh"
 #include "CanvasOrganizer.hh"
 
+class TDirectory;
+
 namespace NA62Analysis {
 namespace Core {
 
@@ -138,6 +140,10 @@ public:
 	//Save all plots into output file
 	void SaveAllPlots(TString analyzerName);
 
+	//Snapshot of the graphs (checkpoints and rolled files)
+	void WriteSnapshot(TDirectory* target) const;
+	void RestoreSnapshot(TDirectory* source);
+
 	void PrintInitSummary() const;
 	void SetPlotAutoUpdate(TString name, TString analyzerName);
 	bool SetCanvasAutoUpdate(TString canvasName);
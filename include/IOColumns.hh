@@ -0,0 +1,63 @@
+/*
+ * IOColumns.hh
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ncl
+ */
+
+#ifndef IOCOLUMNS_HH_
+#define IOCOLUMNS_HH_
+
+#include <vector>
+
+#include "IOHandler.hh"
+#include "ColumnReader.hh"
+
+namespace NA62Analysis {
+namespace Core {
+
+/// \class IOColumns
+/// \Brief
+/// Class reading the events from column files
+/// \EndBrief
+///
+/// \Detailed
+/// Inherits IOHandler and serves the events of a list of column files (see ColumnFileHeader,
+/// written with --make-columns) instead of the input TTrees. The files are mapped in memory
+/// and the analyzers access the values of the fields of the current event with
+/// UserMethods::GetColumn, as views in the mapped files (no copy, no ROOT deserialisation).\n
+/// The fields of the first file are available. A file missing one of them is skipped. Each
+/// file is a burst for the analyzers.
+/// \EndDetailed
+class IOColumns : public IOHandler {
+public:
+	IOColumns();
+	virtual ~IOColumns();
+
+	bool OpenInput(TString inFileName, int nFiles);
+	bool CheckNewFileOpened();
+	bool LoadEvent(Long64_t iEvent);
+	Long64_t GetNEvents();
+
+	int GetFieldIndex(TString name) const;
+	ColumnView GetValues(int field) const;
+
+	void PrintInitSummary() const;
+
+private:
+	IOColumns(const IOColumns&); ///< Non implemented copy-constructor (prevents copy)
+	IOColumns& operator=(const IOColumns&); ///< Non implemented copy-assignment operator (prevents copy)
+
+	std::vector<TString> fFieldNames; ///< Names of the available fields (fields of the first file)
+	std::vector<ColumnReader*> fReaders; ///< Mapped files, in the order of fInputfiles
+	std::vector<std::vector<int> > fFieldIndices; ///< Index in each file of each available field
+	std::vector<Long64_t> fOffsets; ///< Index of the first event of each file, followed by the total number of events
+	int fCurrentReader; ///< Index of the file of the current event
+	Long64_t fCurrentLocalEvent; ///< Index of the current event in its file
+	bool fNewFileOpened; ///< Indicates if a new file has been reached
+};
+
+} /* namespace Core */
+} /* namespace NA62Analysis */
+
+#endif /* IOCOLUMNS_HH_ */
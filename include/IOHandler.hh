@@ -9,18 +9,25 @@
 #define IOHANDLER_HH_
 
 #include <fstream>
+#include <set>
 
 #include <TString.h>
 #include <TFile.h>
 #include "TMutex.h"
 #include "Verbose.hh"
 #include "TimeCounter.h"
+#include "containers.hh"
+
+class TEntryList;
 
 namespace NA62Analysis {
 namespace Core {
 
-/// Type of IOHandler: Not specified yet, histogram IO, TTree IO
-enum class IOHandlerType {kNOIO, kHISTO, kTREE};
+class StagingCache;
+class HistoHandler;
+
+/// Type of IOHandler: Not specified yet, histogram IO, TTree IO, column files IO
+enum class IOHandlerType {kNOIO, kHISTO, kTREE, kCOLUMNS};
 
 /// \class IOHandler
 /// \Brief
@@ -91,14 +98,29 @@ public:
 
 	bool CheckDirExists(TString dir) const;
 	void FileSkipped(TString fileName);
+	TString GetOriginalFileName(TString fileName) const;
+	TString GetInputFileList() const;
 	bool IsLastFileReached() const;
 
 	//Writing
 	void MkOutputDir(TString name) const;
 	void Finalise();
+	void WriteSnapshot(TDirectory* target) const;
+	void RestoreSnapshot(TDirectory* source);
+	void AddSnapshotHistos(TString directory, HistoHandler* histos) {
+		/// \MemberDescr
+		/// \param directory : Output directory of the analyzer
+		/// \param histos : Plots booked by the analyzer
+		///
+		/// Include the graphs booked by the analyzer, which are not attached to the output
+		/// file, in the snapshots
+		/// \EndMemberDescr
+		fSnapshotHistos[directory] = histos;
+	}
 
 	//Printing
 	virtual void PrintInitSummary() const;
+	virtual void PrintIOSummary() const;
 
 	IOHandlerType GetIOType() const {
 		/// \MemberDescr
@@ -139,6 +161,9 @@ public:
 	}
 
 	int ReadCurrentFileRevision();
+	bool ReadEntryList(TString fileName, int nFiles);
+	bool SelectEvents();
+	bool SelectTaggedEvents();
 
 	void SetMutex(TMutex *m){
 		/// \MemberDescr
@@ -166,11 +191,47 @@ public:
 		return fFastStart;
 	}
 
+	void SetEntryListInput(bool entryList) {
+		/// \MemberDescr
+		/// \param entryList : true/false
+		///
+		/// If enabled, the input file given to OpenInput is a ROOT file containing the
+		/// TEntryList "EntryList" (as written by an entry list skim) and only the listed
+		/// entries of the listed files are read.
+		/// \EndMemberDescr
+		fEntryListInput = entryList;
+	}
+
+	void SetEventSelection(TString fileName) {
+		/// \MemberDescr
+		/// \param fileName : Path to a text file listing the events to read (see EventIndex)
+		///
+		/// Only the listed events (run, burst, event number) or timestamp ranges of the input
+		/// files are read. They are located with the event index (EventIndex setting).
+		/// \EndMemberDescr
+		fEventSelection = fileName;
+	}
+
+	void SetTagSelection(TString tagFile, TString expression) {
+		/// \MemberDescr
+		/// \param tagFile : Path to a tag file written with --make-tags (see EventTags)
+		/// \param expression : Tag expression the events must match
+		///
+		/// Only the events of the input files matching the tag expression are read. The tags
+		/// column of the tag file is read first to select them.
+		/// \EndMemberDescr
+		fTagFile = tagFile;
+		fTagExpression = expression;
+	}
+
 protected:
 	void NewFileOpened(int index, TFile* currFile);
+	void StageInputFiles();
+	void UseSelectedEvents(TEntryList *list);
 
 	bool fContinuousReading; ///< Continuous reading enabled?
 	bool fFastStart; ///< Fast start flag enabled? (Start processing directly without checking files)
+	bool fEntryListInput; ///< Is the input file an entry list?
 	mutable bool fSignalExit; ///< Signal from main thread to exit
 	IOHandlerType fIOType; ///< Type of IO handler
 
@@ -183,11 +244,19 @@ protected:
 	TFile *fCurrentFile; ///< Pointer to the currently opened file in the TChain
 
 	std::vector<TString> fInputfiles; ///< Vector of input file path
+	TEntryList *fEntryList; ///< Entries to read (entry list input mode)
+	TString fEventSelection; ///< File listing the events to read (event selection mode)
+	TString fTagFile; ///< Tag file used to select the events to read (tag selection mode)
+	TString fTagExpression; ///< Tag expression the events to read must match (tag selection mode)
+	StagingCache *fStagingCache; ///< Local copies of the remote input files (disabled if nullptr)
+	NA62Analysis::NA62Map<TString, TString>::type fStagedFiles; ///< Remote path of each staged copy read instead of the remote file
 
 	std::ofstream fSkippedFD; ///< Skipped files output stream
+	std::set<TString> fSkippedFiles; ///< Files already written in the skipped files output stream
 
 	mutable TimeCounter fIOTimeCount; ///< Counter for the time spent in IO
 	TMutex *fGraphicalMutex; ///< Mutex to prevent graphical objects to change while processing GUI events
+	NA62Analysis::NA62Map<TString, HistoHandler*>::type fSnapshotHistos; ///< Plots booked by each analyzer, by output directory
 };
 
 bool TestIsTextFile(TString fileName);
@@ -8,14 +8,24 @@
 #ifndef IOTREE_HH_
 #define IOTREE_HH_
 
+#include <vector>
+
 #include "TDetectorVEvent.hh"
 #include "Event.hh"
 
 #include "IOHisto.hh"
 #include "RawHeader.hh"
+#include "FileCatalog.hh"
+#include "InputScanner.hh"
+#include "EventCache.hh"
+#include "ColumnWriter.hh"
+#include "BranchUsageProfile.hh"
 
 class TChain;
 class TTree;
+class TBranch;
+class TLeaf;
+class TClass;
 
 namespace NA62Analysis {
 namespace Core {
@@ -37,12 +47,14 @@ public:
 
 	//IO Files
 	bool OpenInput(TString inFileName, int nFiles);
-	bool checkInputFile(TString fileName);
+	bool checkInputFile(TString fileName, const FileCatalog::FileRecord *record=nullptr);
 	bool CheckNewFileOpened();
 
 	//TTree
 	void RequestTree(TString detectorName, TDetectorVEvent* const evt, TString outputStage="");
 	bool RequestTree(TString treeName, TString branchName, TString className, void* const obj);
+	void RequestProjection(TString treeName, TString branchName, TString member);
+	void SetColumnOutput(TString fileName, TString fieldList);
 	Long64_t BranchTrees(Long64_t eventNb);
 	TChain* GetTree(TString name);
 	void SetIgnoreNonExisting(bool bFlag);
@@ -50,6 +62,7 @@ public:
 	//Events
 	TDetectorVEvent *GetEvent(TString detName, TString outputName="");
 	void* GetObject(TString name, TString branchName="");
+	const std::vector<double>* GetProjection(TString treeName, TString branchName, TString member) const;
 	Long64_t FillMCTruth();
 	Long64_t FillRawHeader();
 	bool LoadEvent(Long64_t iEvent);
@@ -58,17 +71,171 @@ public:
 	RawHeader* GetRawHeaderEvent(TString treeName = "Reco");
 	bool GetWithRawHeader() const;
 	Long64_t GetNEvents();
+	Long64_t GetNEventsEstimate();
+	Long64_t GetClusterEnd(Long64_t iEvent);
+	bool GetCurrentEntry(TString &fileName, TString &treeName, Long64_t &localEntry) const;
+	void UpdateInputScan();
+
+	//Event cache (multi-pass)
+	bool StartEventCache();
+	void CacheEvent(Long64_t iEvent);
+	Long64_t GetNCachedEvents() const;
+	Long64_t LoadCachedEvent(Long64_t index);
+	void StopEventCache();
 
 	//Writing
 	void WriteEvent();
-	void WriteTree() const;
+	void WriteEvent(TString streamName);
+	void WriteTree();
+	void WriteColumns();
+	void CloseColumnOutput();
+	void SetSkimBranches(TString branchList);
+	bool AddExportStream(TString streamName, TString definition);
+	void SetFastSkim(bool fastSkim) {
+		/// \MemberDescr
+		/// \param fastSkim : true/false
+		///
+		/// Enable/Disable the copy of the compressed baskets when all the events of an input file are exported
+		/// \EndMemberDescr
+		fFastSkim = fastSkim;
+	}
+	void AddFriendFile(TString fileName) {
+		/// \MemberDescr
+		/// \param fileName : Path to a ROOT file containing friend trees
+		///
+		/// The requested trees found in this file are read from it instead of the input files,
+		/// entry by entry with the input trees (their chains are loaded with the same entry).
+		/// \EndMemberDescr
+		fFriendFiles.push_back(fileName);
+	}
+	void SetEntryListExport(bool entryList) {
+		/// \MemberDescr
+		/// \param entryList : true/false
+		///
+		/// If enabled, the exported events are not copied in output trees: only their
+		/// (input file, entry) pairs are written in the TEntryList "EntryList" of the output file.
+		/// This file can be given back as input with --entrylist.
+		/// \EndMemberDescr
+		fEntryListExport = entryList;
+	}
+	void SetStreaming(bool streaming) {
+		/// \MemberDescr
+		/// \param streaming : true/false
+		///
+		/// If enabled, the chains contain only the file being read: the next file replaces it
+		/// when its last event is reached (and is opened in advance), so that the memory used
+		/// does not depend on the number of input files. Implies --fast-start.
+		/// \EndMemberDescr
+		fStreaming = streaming;
+	}
+
+	//Branch usage profile
+	void SetBranchProfileOutput(TString fileName);
+	bool UseBranchProfile(TString fileName);
+	BranchUsageProfile* GetBranchUsage() {
+		/// \MemberDescr
+		/// \return Profile recording the retrieved branches, nullptr if not profiling
+		/// \EndMemberDescr
+		return fBranchUsage;
+	}
+	void WriteBranchUsage();
 
 	//Printing
 	void PrintInitSummary() const;
+	void PrintIOSummary() const;
 
 private:
 	void FindAndBranchTree(TChain* tree, TString branchName, TString branchClass, void* const evt);
 	TString DetermineMainTree(TString detName);
+	void CreateExportTrees(const std::vector<TString> &skimBranches, NA62Analysis::NA62Map<TString,TTree*>::type &exportTrees);
+	void FillExportTrees();
+	bool DeferExportEvent();
+	void FlushDeferredEvents();
+	void CopyDeferredEntries(TString treeName, TTree* inTree, Long64_t nEvents, Option_t* option);
+	void CopyDeferredFriendEntries(TString treeName, Long64_t nEvents);
+	Long64_t GetEntryListEntry(Long64_t iEvent);
+	void ReadFriendFiles();
+	void StartInputScan(const std::vector<const FileCatalog::FileRecord*> &records);
+	void LoadStreamFile(int index);
+	Long64_t GetStreamEntry(Long64_t iEvent);
+	int GetCurrentFileIndex() const;
+	Long64_t GetCurrentFileOffset() const;
+	void LoadProjections(TChain *chain, TString treeName, Long64_t localEntry, int treeNumber);
+	bool IsBranchRequested(TString treeName, TString branchName);
+	static void SetSubBranchStatus(TBranch *branch, bool status);
+	void RecordUsage(int &usageIndex, TString treeName, TString branchName);
+	void TrainCache(TChain *chain, TString treeName);
+	void OpenRollFile();
+	void CloseRollFile();
+	static std::vector<TString> ParseBranchList(TString branchList);
+	static bool IsSkimBranch(const std::vector<TString> &skimBranches, TString treeName, TString branchName);
+
+	/// \struct ExportStream
+	/// \Brief
+	/// Named export stream, written in its own output file
+	/// \EndBrief
+	struct ExportStream {
+		TString fFileName; ///< Path of the output file
+		TFile *fFile; ///< Output file (opened with the first exported event)
+		std::vector<TString> fSkimBranches; ///< Branches to export. All if empty
+		NA62Analysis::NA62Map<TString,TTree*>::type fTrees; ///< Exported trees
+		Long64_t fNExported; ///< Number of exported events
+		TEntryList *fEntryList; ///< Entry list of the exported events (entry list export)
+		bool fDisabled; ///< The output file could not be opened: events are not exported
+	};
+
+	/// \struct Projection
+	/// \Brief
+	/// Data member of a requested branch read as an array of values
+	/// \EndBrief
+	struct Projection {
+		TString fTreeName; ///< Name of the tree
+		TString fBranchName; ///< Name of the top-level branch
+		TString fMember; ///< Name of the split sub-branch, relative to the top-level branch
+		std::vector<double> fValues; ///< Values of the current event
+		int fTreeNumber; ///< Index of the file for which the branches below are valid
+		TBranch *fTop; ///< Top-level branch to read (nullptr if already read as a requested branch)
+		TBranch *fBranch; ///< Sub-branch of the member
+		TLeaf *fLeaf; ///< Leaf of the member
+	};
+
+	/// \class BranchStats
+	/// \Brief
+	/// Class accounting the reading of a requested branch
+	/// \EndBrief
+	///
+	/// \Detailed
+	/// Count the entries, the uncompressed bytes returned by GetEntry, the baskets loaded and their
+	/// compressed size (summed over all the sub-branches of a split branch), the total time spent in
+	/// GetEntry and the part of it spent in calls that had to load (read and decompress) a new basket.
+	/// \EndDetailed
+	class BranchStats{
+	public:
+		BranchStats():
+			fEntries(0),
+			fBytes(0),
+			fZipBytes(0),
+			fBaskets(0),
+			fReadTime(0),
+			fBasketTime(0),
+			fTreeNumber(-1)
+		{
+			/// \MemberDescr
+			///	Constructor
+			///	\EndMemberDescr
+		};
+		Int_t Read(TBranch* branch, Long64_t entry, int treeNumber);
+
+		Long64_t fEntries; ///< Number of entries read
+		Long64_t fBytes; ///< Uncompressed bytes read
+		Long64_t fZipBytes; ///< Compressed size of the baskets read
+		Long64_t fBaskets; ///< Number of baskets read
+		double fReadTime; ///< Total time spent in GetEntry
+		double fBasketTime; ///< Time spent in GetEntry calls that loaded at least one new basket
+	private:
+		int fTreeNumber; ///< Index of the file in the TChain for which fLeaves is valid
+		std::vector<std::pair<TBranch*, int> > fLeaves; ///< Terminal sub-branches and index of the last basket read
+	};
 
 	/// \class ObjectTriplet
 	/// \Brief
@@ -85,7 +252,9 @@ private:
 		ObjectTriplet(TString c, TString branch, void* obj):
 			fClassName(c),
 			fBranchName(branch),
-			fObject(obj)
+			fObject(obj),
+			fUsageIndex(-1),
+			fPruned(false)
 		{
 			/// \MemberDescr
 			///	\param c : Class name of the object
@@ -97,6 +266,9 @@ private:
 		TString fClassName; ///< Class name of the object
 		TString fBranchName; ///< Branch name
 		void* fObject; ///< Pointer to the object
+		BranchStats fStats; ///< Reading statistics of the branch
+		int fUsageIndex; ///< Index of the branch in the branch usage profile (-1 if not yet recorded)
+		bool fPruned; ///< The branch is not read (never used according to the branch usage profile)
 	};
 
 	/// \class EventTriplet
@@ -112,7 +284,9 @@ private:
 		public:
 			EventTriplet(TString tree, TDetectorVEvent* obj):
 				fTreeName(tree),
-				fEvent(obj)
+				fEvent(obj),
+				fUsageIndex(-1),
+				fPruned(false)
 			{
 				/// \MemberDescr
 				///	\param tree : Name of the TTree
@@ -125,6 +299,9 @@ private:
 			}
 			TString fTreeName; ///< Branch name
 			TDetectorVEvent* fEvent; ///< Pointer to the event
+			BranchStats fStats; ///< Reading statistics of the branch
+			int fUsageIndex; ///< Index of the branch in the branch usage profile (-1 if not yet recorded)
+			bool fPruned; ///< The branch is not read (never used according to the branch usage profile)
 	};
 
 	typedef std::pair<TString, TChain*> chainPair; ///< typedef for elements of map of TChain
@@ -137,12 +314,61 @@ private:
 	NA62Analysis::NA62Map<TString,TChain*>::type fTree; ///< Container for the trees (Name, pointer)
 	NA62Analysis::NA62MultiMap<TString,EventTriplet*>::type fEvent; ///< Container for the events (Detector, EventTriplet)
 	NA62Analysis::NA62MultiMap<TString,ObjectTriplet*>::type fObject; ///< Container for the custom objects (Tree name, ObjectTriplet)
+	std::vector<Projection*> fProjections; ///< Projected data members
 
 	TChain *fMCTruthTree; ///< Pointer to (first) TTree containing MCTruth
 	TChain *fRawHeaderTree; ///< Pointer to (first) TTree containing RawHeader
 	TChain *fReferenceTree; ///< Pointer to the reference TTree used to retrieve common information
 
 	NA62Analysis::NA62Map<TString,TTree*>::type fExportTrees; ///< Container for TTrees for exporting
+	std::vector<TString> fSkimBranches; ///< Branches to export ("Tree:Branch" or "Branch"). All if empty
+	bool fFastSkim; ///< Copy the compressed baskets of input files where all events are exported
+	Long64_t fCurrentEntry; ///< Index of the currently loaded event
+	Long64_t fNExported; ///< Number of events exported by filling the output trees
+	Long64_t fNExportedFast; ///< Number of events exported by copying the compressed baskets
+	Long64_t fDeferredEvents; ///< Number of exported events (from the first of the file) not yet written
+	Long64_t fDeferredOffset; ///< Index of the first event of the file containing the deferred events
+	Long64_t fDeferredFileEntries; ///< Number of events in the file containing the deferred events
+	int fDeferredTreeNumber; ///< Index of the file containing the deferred events
+	TString fDeferredFileName; ///< Path of the file containing the deferred events
+	bool fEntryListExport; ///< Export the entry list of the events instead of the events
+	TEntryList *fExportEntryList; ///< Entry list of the exported events
+
+	std::vector<int> fEntryListTrees; ///< Index in the chains of the file of each entry list sub-list (-1 if not opened)
+	std::vector<Long64_t> fEntryListStarts; ///< Index of the first event of each entry list sub-list among the events read
+	Long64_t fEntryListEvents; ///< Number of entries of the entry list in the opened files
+	std::vector<Long64_t> fEntryListOffsets; ///< Start in the chains of the first files (used with an entry list)
+
+	NA62Analysis::NA62Map<TString,ExportStream*>::type fExportStreams; ///< Named export streams
+
+	Long64_t fRollSize; ///< Size in bytes after which the exported trees are written in a new file (disabled if 0)
+	int fRollBursts; ///< Number of bursts after which the exported trees are written in a new file (disabled if 0)
+	bool fRollHistograms; ///< Write a snapshot of the histograms in each rolled file
+	TFile *fRollFile; ///< Current file of the exported trees (rolling enabled)
+	int fRollIndex; ///< Index of the next rolled file
+	int fRollBurstCount; ///< Number of bursts since the last roll
+	Long64_t fRollEvents; ///< Number of events exported in the current rolled file
+	std::vector<TString> fFriendFiles; ///< Files containing friend trees
+	NA62Analysis::NA62Map<TString,TString>::type fFriendTrees; ///< File from which each friend tree is read (Tree name, file)
+	std::vector<Long64_t> fFileEntries; ///< Number of entries of each input file known with --fast-start (or InputScanner::ScanStatus)
+	InputScanner *fInputScanner; ///< Background scanning of the input files with --fast-start
+
+	bool fStreaming; ///< Read the input files one at a time (streaming reader)
+	int fStreamFile; ///< Index of the file in the chains (streaming reader)
+	Long64_t fStreamEntries; ///< Number of entries of the file in the chains, -1 if unknown (streaming reader)
+	std::vector<Long64_t> fStreamOffsets; ///< Index of the first event of each file already reached (streaming reader)
+
+	EventCache *fEventCache; ///< Events kept for the next passes (multi-pass analysis)
+	std::vector<TClass*> fEventCacheClasses; ///< Class of each requested object, in the order of fObject
+
+	TString fColumnFileName; ///< Path of the column file to write (disabled if empty)
+	ColumnWriter *fColumnWriter; ///< Writer of the column file (created with the first event)
+	std::vector<const std::vector<double>*> fColumnValues; ///< Values of each column (projections)
+
+	TString fBranchUsageFile; ///< Path of the branch usage profile to write (profiling disabled if empty)
+	BranchUsageProfile *fBranchUsage; ///< Branches retrieved by the analyzers (profiling)
+	BranchUsageProfile *fBranchProfile; ///< Loaded branch usage profile (pruning and cache training)
+	NA62Analysis::NA62Map<TString,int>::type fTrainedCache; ///< Index of the file for which the cache of each tree was trained
 
 	bool fWithMC; ///< Do we have MC in the file?
 	bool fWithRawHeader; ///< Do we have RawHeader in the file?
@@ -0,0 +1,72 @@
+/*
+ * InputScanner.hh
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ncl
+ */
+
+#ifndef INPUTSCANNER_HH_
+#define INPUTSCANNER_HH_
+
+#include <vector>
+
+#include <TString.h>
+#include <TMutex.h>
+
+class TThread;
+
+namespace NA62Analysis {
+namespace Core {
+
+/// \class InputScanner
+/// \Brief
+/// Check the input files and count their entries in background threads
+/// \EndBrief
+///
+/// \Detailed
+/// Used with --fast-start, where the files are added to the TChains without being opened.
+/// A pool of threads opens the input files one after the other (in the order of the list) while
+/// the event loop is running, and records the number of entries of the reference tree of each
+/// file, or that the file cannot be read.\n
+/// The results are only read from the event loop thread with GetEntries(). Nothing is
+/// modified in the TChains.
+/// \EndDetailed
+class InputScanner {
+public:
+	InputScanner();
+	virtual ~InputScanner();
+
+	bool Start(const std::vector<TString> &fileNames, const std::vector<Long64_t> &entries,
+			TString treeName, int nThreads);
+	void Stop();
+
+	Long64_t GetEntries(unsigned int index);
+	int GetNPending();
+
+	/// \enum ScanStatus
+	/// \Brief
+	/// Special values of the number of entries of a file
+	/// \EndBrief
+	enum ScanStatus {kInvalid=-1, kPending=-2};
+
+private:
+	InputScanner(const InputScanner&); ///< Non implemented copy-constructor (prevents copy)
+	InputScanner& operator=(const InputScanner&); ///< Non implemented copy-assignment operator (prevents copy)
+
+	Long64_t ScanFile(TString fileName) const;
+	static void Run(void* args);
+
+	bool fStop; ///< Stop signal for the threads
+	unsigned int fNext; ///< Index of the next file to scan
+	int fNPending; ///< Number of files not scanned yet
+	TString fTreeName; ///< Name of the tree whose entries are counted
+	std::vector<TString> fFileNames; ///< Input files
+	std::vector<Long64_t> fEntries; ///< Number of entries of each file (or ScanStatus)
+	std::vector<TThread*> fThreads; ///< Scanning threads
+	TMutex fMutex; ///< Mutex protecting the results and fNext
+};
+
+} /* namespace Core */
+} /* namespace NA62Analysis */
+
+#endif /* INPUTSCANNER_HH_ */
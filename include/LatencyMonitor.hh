@@ -0,0 +1,100 @@
+/*
+ * LatencyMonitor.hh
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ncl
+ */
+
+#ifndef LATENCYMONITOR_HH_
+#define LATENCYMONITOR_HH_
+
+#include <vector>
+
+#include <TString.h>
+
+#include "TimeCounter.h"
+
+namespace NA62Analysis {
+namespace Core {
+
+/// \class LatencyMonitor
+/// \Brief
+/// Distribution of the per-event processing time and throughput per burst
+/// \EndBrief
+///
+/// \Detailed
+/// The processing time of each event is accumulated in a fixed size histogram
+/// with logarithmic buckets (20 buckets per decade between 100ns and 1000s, i.e.
+/// a resolution of ~12%), from which the percentiles are computed at the end of
+/// the processing. The number of events and the time spent in each burst are
+/// recorded to obtain the number of events processed per second for each burst.
+/// The slowest events are also kept to identify pathological events.\n
+/// The results can be printed, written in the current ROOT directory and dumped
+/// in a JSON file.
+/// \EndDetailed
+class LatencyMonitor {
+public:
+	LatencyMonitor();
+	virtual ~LatencyMonitor();
+
+	void Reset();
+	void AddEvent(Long64_t iEvent, float time);
+	void NewBurst(int burstIndex);
+	void EndBurst();
+
+	float GetPercentile(double q) const;
+	float GetMax() const {
+		/// \MemberDescr
+		/// \return Largest recorded event processing time
+		/// \EndMemberDescr
+		return fMaxTime;
+	}
+	float GetMean() const {
+		/// \MemberDescr
+		/// \return Mean event processing time
+		/// \EndMemberDescr
+		return fNEvents>0 ? fTotalTime/fNEvents : 0;
+	}
+	Long64_t GetNEvents() const {
+		/// \MemberDescr
+		/// \return Number of recorded events
+		/// \EndMemberDescr
+		return fNEvents;
+	}
+
+	void Print() const;
+	void Write() const;
+	bool WriteJSON(TString fileName) const;
+
+	static const int fgBucketsPerDecade = 20; ///< Number of buckets per decade
+	static const int fgNDecades = 10; ///< Number of decades covered by the buckets
+	static const int fgMinExponent = -7; ///< Lower edge of the first bucket is 10^fgMinExponent seconds
+	static const unsigned int fgNSlowest = 10; ///< Number of slowest events to keep
+private:
+	static int GetBucket(float time);
+	static double GetBucketLowEdge(int bucket);
+
+	/// \struct BurstRecord
+	/// \Brief
+	/// Number of events and time spent in a burst
+	/// \EndBrief
+	struct BurstRecord {
+		int fBurstIndex; ///< Index of the burst (input file index)
+		Long64_t fNEvents; ///< Number of events processed in the burst
+		float fDuration; ///< Time spent in the burst
+		float fMaxTime; ///< Largest event processing time in the burst
+	};
+
+	Long64_t fNEvents; ///< Number of recorded events
+	double fTotalTime; ///< Sum of the processing time of all events
+	float fMaxTime; ///< Largest event processing time
+	std::vector<Long64_t> fBuckets; ///< Logarithmic buckets (underflow, buckets, overflow)
+	std::vector<BurstRecord> fBursts; ///< Records of all the bursts
+	std::vector<std::pair<float, Long64_t> > fSlowest; ///< Slowest events (time, event index)
+	TimeCounter fBurstTime; ///< Time counter for the current burst
+};
+
+} /* namespace Core */
+} /* namespace NA62Analysis */
+
+#endif /* LATENCYMONITOR_HH_ */
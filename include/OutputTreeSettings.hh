@@ -0,0 +1,104 @@
+/*
+ * OutputTreeSettings.hh
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ncl
+ */
+
+#ifndef OUTPUTTREESETTINGS_HH_
+#define OUTPUTTREESETTINGS_HH_
+
+#include <vector>
+
+#include <TString.h>
+#include <TMutex.h>
+
+#include "containers.hh"
+
+class TTree;
+class TFile;
+
+namespace NA62Analysis {
+namespace Core {
+
+/// \class OutputTreeSettings
+/// \Brief
+/// Compression and buffering settings of the output trees and file
+/// \EndBrief
+///
+/// \Detailed
+/// Unique instance holding the compression algorithm, compression level, basket size and
+/// auto-flush to use for each output tree (identified by its name). The settings are read
+/// from the [Output] section of the settings file and from the --compression command line
+/// option, with the format
+/// \code
+/// TreeName = algorithm:level[:basketSize[:autoFlush]]
+/// \endcode
+/// where algorithm is one of zlib, lzma, lz4, zstd or a ROOT algorithm number (lz4 and zstd
+/// require a recent ROOT version). The level defaults to 1 and empty fields leave the ROOT
+/// default unchanged (e.g. "lz4::64000"). The special names "Default" and "File" apply respectively to all
+/// the trees without specific settings and to the output file itself (histograms and trees
+/// created without specific settings).\n
+/// The size and writing time of each configured tree are collected before the output file is
+/// closed and printed at the end of the processing.
+/// \EndDetailed
+class OutputTreeSettings {
+public:
+	virtual ~OutputTreeSettings();
+	static OutputTreeSettings* GetInstance();
+
+	bool SetSettings(TString treeName, TString settings);
+	bool SetSettingsList(TString settingsList);
+
+	void ApplyToFile(TFile* fd);
+	void Apply(TTree* tree);
+	void AddFillTime(TTree* tree, double time);
+	void Collect();
+	void Collect(TTree* tree);
+	void Print() const;
+
+private:
+	OutputTreeSettings();
+	OutputTreeSettings(const OutputTreeSettings&); ///< Non implemented copy-constructor (prevents copy)
+	OutputTreeSettings& operator=(const OutputTreeSettings&); ///< Non implemented copy-assignment operator (prevents copy)
+
+	/// \struct Settings
+	/// \Brief
+	/// Settings of one output tree. Negative or null values are not applied
+	/// \EndBrief
+	struct Settings {
+		int fAlgorithm; ///< Compression algorithm
+		int fLevel; ///< Compression level
+		int fBasketSize; ///< Basket size
+		Long64_t fAutoFlush; ///< Auto-flush (entries if positive, bytes if negative)
+		TString fString; ///< Settings as given by the user
+	};
+
+	/// \struct TreeRecord
+	/// \Brief
+	/// Size and writing time of one output tree
+	/// \EndBrief
+	struct TreeRecord {
+		TString fName; ///< Name of the tree
+		TString fSettings; ///< Settings applied
+		Long64_t fEntries; ///< Number of entries
+		Long64_t fTotBytes; ///< Uncompressed size
+		Long64_t fZipBytes; ///< Compressed size
+		double fFillTime; ///< Time spent filling the tree
+	};
+
+	static int GetAlgorithm(TString name);
+	const Settings* GetSettings(TString treeName) const;
+
+	NA62Analysis::NA62Map<TString, Settings>::type fSettings; ///< Settings for each tree name
+	NA62Analysis::NA62Map<TTree*, TreeRecord>::type fTrees; ///< Trees to which settings were applied
+	std::vector<TreeRecord> fCollected; ///< Records collected before closing the output file
+	TMutex fMutex; ///< Mutex protecting fTrees (filled from the writer thread)
+
+	static OutputTreeSettings *fOutputTreeSettings; ///< static pointer to unique instance of the class
+};
+
+} /* namespace Core */
+} /* namespace NA62Analysis */
+
+#endif /* OUTPUTTREESETTINGS_HH_ */
@@ -0,0 +1,132 @@
+/*
+ * OutputWriter.hh
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ncl
+ */
+
+#ifndef OUTPUTWRITER_HH_
+#define OUTPUTWRITER_HH_
+
+#include <deque>
+#include <vector>
+
+#include <TString.h>
+#include <TMutex.h>
+#include <TCondition.h>
+
+#include "containers.hh"
+
+class TTree;
+class TThread;
+class TClass;
+class TBufferFile;
+
+namespace NA62Analysis {
+namespace Core {
+
+/// \class OutputWriter
+/// \Brief
+/// Fill the output TTrees in a background thread
+/// \EndBrief
+///
+/// \Detailed
+/// Unique instance moving the filling (and therefore the compression and writing of the
+/// baskets) of the output TTrees out of the event loop.\n
+/// When a tree is filled for the first time through Fill(), the objects and variables
+/// attached to its branches are recorded and the branches are redirected to copies owned
+/// by the writer. For each Fill(), the content of the original objects is streamed
+/// (without compression) in a buffer which is pushed in a bounded queue. The writer thread
+/// restores each buffer in the copies and fills the tree.\n
+/// When the queue is full, the event loop waits for the writer: the number of waits and the
+/// time spent waiting are reported by PrintSummary().\n
+/// Only branches containing objects (TBranchElement) and fixed size variables are supported.
+/// Trees containing other branches (variable size arrays, strings) are filled immediately.\n
+/// While the writer is running, nothing else than the trees going through Fill() should be
+/// written in the output file. Stop() restores the original branch addresses so that the
+/// trees can be filled and written normally afterwards.
+/// \EndDetailed
+class OutputWriter {
+public:
+	virtual ~OutputWriter();
+	static OutputWriter* GetInstance();
+
+	bool Start(unsigned int queueSize);
+	void Stop();
+	void Sync();
+	void Fill(TTree* tree);
+	void Release(TTree* tree);
+	void PrintSummary() const;
+
+	bool IsRunning() const {
+		/// \MemberDescr
+		/// \return True if the writer thread is running
+		/// \EndMemberDescr
+		return fRunning;
+	}
+
+private:
+	OutputWriter();
+	OutputWriter(const OutputWriter&); ///< Non implemented copy-constructor (prevents copy)
+	OutputWriter& operator=(const OutputWriter&); ///< Non implemented copy-assignment operator (prevents copy)
+
+	/// \struct TreeSlot
+	/// \Brief
+	/// Branches of a tree filled by the writer
+	/// \EndBrief
+	struct TreeSlot {
+		TTree* fTree; ///< Tree
+		bool fAsync; ///< Can the tree be filled by the writer thread
+		std::vector<TString> fBranchNames; ///< Names of the top-level branches
+		std::vector<TClass*> fClasses; ///< Class of the object of each branch (nullptr for variables)
+		std::vector<void*> fSources; ///< Original objects/variables attached to each branch
+		std::vector<void*> fAddresses; ///< Original branch addresses (pointer to the object pointer for objects)
+		std::vector<Int_t> fSizes; ///< Size in bytes of the variables
+		std::vector<void*> fTargets; ///< Copies owned by the writer and attached to each branch
+	};
+
+	/// \struct Job
+	/// \Brief
+	/// Content of one entry of a tree, waiting to be filled
+	/// \EndBrief
+	struct Job {
+		TreeSlot* fSlot; ///< Tree to fill
+		TBufferFile* fBuffer; ///< Streamed content of the branches
+	};
+
+	TreeSlot* GetSlot(TTree* tree);
+	void Attach(TreeSlot* slot);
+	void Detach(TreeSlot* slot);
+	void Process(Job& job);
+	void FillTree(TTree* tree);
+	static void Run(void* args);
+
+	bool fRunning; ///< Is the writer thread running
+	bool fStop; ///< Stop signal for the writer thread
+	bool fBusy; ///< Is the writer thread processing a job
+	unsigned int fQueueSize; ///< Maximum number of jobs in the queue
+	std::deque<Job> fQueue; ///< Jobs waiting to be processed
+	std::vector<TBufferFile*> fFreeBuffers; ///< Buffers available for new jobs
+	NA62Analysis::NA62Map<TTree*, TreeSlot*>::type fSlots; ///< Trees filled through the writer
+
+	TThread* fThread; ///< Writer thread
+	TMutex fQueueMutex; ///< Mutex protecting the queue
+	TMutex fFileMutex; ///< Mutex protecting the output file
+	TCondition fNotEmpty; ///< Signaled when a job is added to the queue
+	TCondition fNotFull; ///< Signaled when a job is removed from the queue
+	TCondition fIdle; ///< Signaled when the queue is empty and the writer is idle
+
+	Long64_t fNJobs; ///< Number of jobs processed by the writer
+	Long64_t fNSync; ///< Number of entries filled immediately
+	unsigned int fMaxDepth; ///< Largest number of jobs in the queue
+	Long64_t fNWaits; ///< Number of times the event loop waited for the writer
+	double fWaitTime; ///< Time spent by the event loop waiting for the writer
+	double fWriterTime; ///< Time spent by the writer thread filling the trees
+
+	static OutputWriter *fOutputWriter; ///< static pointer to unique instance of the class
+};
+
+} /* namespace Core */
+} /* namespace NA62Analysis */
+
+#endif /* OUTPUTWRITER_HH_ */
@@ -0,0 +1,60 @@
+/*
+ * ParameterScan.hh
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ncl
+ */
+
+#ifndef PARAMETERSCAN_HH_
+#define PARAMETERSCAN_HH_
+
+#include <vector>
+
+#include "ConfigAnalyzer.hh"
+
+namespace NA62Analysis {
+
+class Analyzer;
+
+namespace Configuration {
+
+/// \class ParameterScan
+/// \Brief
+/// Parse a parameter scan specification and give the parameters of each scan point
+/// \EndBrief
+///
+/// \Detailed
+/// The specification has the format of the analyzer parameters (command line string or
+/// configuration file), with a comma separated list of values for each scanned parameter:
+/// \code
+/// 	analyzerName1:param1=val1,val2,val3;param2=val1,val2&analyzerName2:param1=val1,val2
+/// \endcode
+/// The scan points of an analyzer are all the combinations of the values of its parameters
+/// (6 points for analyzerName1 above). The first parameter (in alphabetical order) varies the
+/// fastest. BaseAnalysis creates one instance of the analyzer per scan point (see
+/// BaseAnalysis::AddScanCopies).
+/// \EndDetailed
+
+class ParameterScan : public ConfigAnalyzer {
+public:
+	ParameterScan();
+	virtual ~ParameterScan();
+
+	void Parse(TString scan);
+	int GetNPoints(TString analyzerName) const;
+	std::vector<ParamPair> GetPoint(TString analyzerName, int point) const;
+	TString GetPointDescription(TString analyzerName, int point) const;
+	void ApplyPoint(Analyzer* const analyzer, TString analyzerName, int point) const;
+	virtual void Print() const;
+
+private:
+	ParameterScan(const ParameterScan&); ///< Non implemented copy-constructor (prevents copy)
+	ParameterScan& operator=(const ParameterScan&); ///< Non implemented copy-assignment operator (prevents copy)
+
+	static std::vector<TString> GetValues(TString values);
+};
+
+} /* namespace Configuration */
+} /* namespace NA62Analysis */
+
+#endif /* PARAMETERSCAN_HH_ */
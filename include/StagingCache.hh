@@ -0,0 +1,107 @@
+/*
+ * StagingCache.hh
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ncl
+ */
+
+#ifndef STAGINGCACHE_HH_
+#define STAGINGCACHE_HH_
+
+#include <vector>
+#include <set>
+
+#include <TString.h>
+#include <TMutex.h>
+
+#include "containers.hh"
+
+class TThread;
+
+namespace NA62Analysis {
+namespace Core {
+
+/// \class StagingCache
+/// \Brief
+/// Local disk copies of the remote input files, shared between successive runs
+/// \EndBrief
+///
+/// \Detailed
+/// Enabled with the StagingDir setting. An input file is remote if its path starts with one of
+/// the StagingRemote prefixes (root:// by default, a local directory can be given to emulate a
+/// remote store). When the input files are registered, Resolve() returns the local copy of each
+/// remote file already staged, after checking its size (and its MD5 checksum if StagingVerify is
+/// set). The other remote files are read remotely and copied in background by Start(), so that
+/// the next runs read them from the local disk.\n
+/// The copies are checked against the MD5 checksum computed while reading the remote file. The
+/// total size of the directory is limited to StagingSize MB: the least recently used copies are
+/// removed, except those used by a running job: each job lists the copies it uses in its lease
+/// file staging.lease.<pid>, removed at the end of the run (or by the other jobs once the process
+/// is no longer running). At the end of the run, the copy in progress is completed and the files
+/// not copied yet are left for the next runs.\n
+/// The staged files are listed in the index file staging.index of the directory (remote path,
+/// local name, size, checksum, last use). The index is updated under a lock (staging.lock) as
+/// soon as a file is copied, merged with the entries of the concurrent jobs, and the files of
+/// the directory missing from the index are removed.
+/// \EndDetailed
+class StagingCache {
+public:
+	StagingCache(TString directory, Long64_t maxSize, TString remotePrefixes, bool verify);
+	virtual ~StagingCache();
+
+	bool IsRemote(TString fileName) const;
+	TString Resolve(TString fileName);
+	bool Start();
+	void Stop();
+	void PrintSummary();
+
+private:
+	StagingCache(const StagingCache&); ///< Non implemented copy-constructor (prevents copy)
+	StagingCache& operator=(const StagingCache&); ///< Non implemented copy-assignment operator (prevents copy)
+
+	/// \struct StagedFile
+	/// \Brief
+	/// Local copy of a remote file
+	/// \EndBrief
+	struct StagedFile {
+		TString fLocalName; ///< Name of the copy in the staging directory
+		Long64_t fSize; ///< Size of the file in bytes
+		TString fChecksum; ///< MD5 checksum of the file
+		Long64_t fLastUse; ///< Time of the last use (seconds since epoch)
+		bool fInUse; ///< Used by the current run (cannot be removed, see WriteLease)
+	};
+
+	bool Load();
+	bool Save();
+	bool ReadIndex(NA62Analysis::NA62Map<TString, StagedFile>::type &files) const;
+	bool WriteIndex();
+	int LockIndex() const;
+	static void UnlockIndex(int fd);
+	TString GetLeaseName() const;
+	bool WriteLease() const;
+	void ReadLeases(std::set<TString> &localNames) const;
+	TString GetLocalName(TString fileName) const;
+	bool MakeRoom(Long64_t size);
+	bool Copy(TString fileName, StagedFile &staged);
+	static void Run(void* args);
+
+	TString fDirectory; ///< Staging directory
+	Long64_t fMaxSize; ///< Maximum total size of the copies in bytes
+	std::vector<TString> fRemotePrefixes; ///< Prefixes of the remote paths
+	bool fVerify; ///< Check the MD5 checksum of the copies before using them
+	NA62Analysis::NA62Map<TString, StagedFile>::type fFiles; ///< Staged files (remote path, copy)
+	std::vector<TString> fQueue; ///< Remote files to copy
+	unsigned int fNext; ///< Index of the next file to copy in fQueue
+	bool fStop; ///< Stop signal for the copying thread
+	TThread *fThread; ///< Copying thread
+	TMutex fMutex; ///< Mutex protecting fFiles, fNext, fStop and the counters
+	int fNHits; ///< Number of input files read from a local copy
+	int fNCopied; ///< Number of files copied
+	int fNFailed; ///< Number of files which could not be copied
+	Long64_t fBytesCopied; ///< Number of bytes copied
+};
+
+} /* namespace Core */
+} /* namespace NA62Analysis */
+
+#endif /* STAGINGCACHE_HH_ */
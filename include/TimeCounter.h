@@ -8,11 +8,11 @@
 #ifndef TIMECOUNTER_H_
 #define TIMECOUNTER_H_
 
-#include <sys/time.h>
+#include <time.h>
 
 namespace NA62Analysis {
 
-float operator-(struct timeval t1, struct timeval t2);
+double operator-(struct timespec t1, struct timespec t2);
 
 /// \class TimeCounter
 /// \Brief
@@ -22,7 +22,8 @@ float operator-(struct timeval t1, struct timeval t2);
 /// \Detailed
 /// This class provides a basic time counter. It starts running when Start()
 /// or the constructor TimeCounter(clock_t s) is called and stops when as many
-/// Stop() have been called.\n
+/// Stop() have been called. The time is measured with the monotonic clock
+/// (not affected by system time adjustments).\n
 /// Example:\n
 /// The following code will count the time elapsed between lines 2 and 7. Lines 3,4,5,6 and 8 have no effect.
 /// \code
@@ -46,7 +47,7 @@ public:
 	void Stop();
 	void Reset();
 
-	void AddTime(float v) {
+	void AddTime(double v) {
 		/// \MemberDescr
 		/// \param v: Amount of time to add
 		///
@@ -55,7 +56,7 @@ public:
 		fTotalTime+=v;
 	};
 
-	float GetTotalTime() const {
+	double GetTotalTime() const {
 		/// \MemberDescr
 		/// \return Total accumulated time up to now if still running, else total accumulated time up to last Stop()
 		/// \EndMemberDescr
@@ -63,7 +64,14 @@ public:
 		else return fTotalTime;
 	}
 
-	struct timeval GetStartTime() const {
+	int GetNCalls() const {
+		/// \MemberDescr
+		/// \return Number of time the counter has been started (nested Start() not counted)
+		/// \EndMemberDescr
+		return fNCalls;
+	}
+
+	struct timespec GetStartTime() const {
 		/// \MemberDescr
 		/// \return Timestamp when the counter started running
 		/// \EndMemberDescr
@@ -72,14 +80,15 @@ public:
 
 	void Print() const;
 
-	static struct timeval GetTime();
+	static struct timespec GetTime();
 private:
 	bool IncrementStart();
 	bool DecrementStart();
 
 	int fIsRunning; ///< Indicate how many Start() were requested without Stop() (#Start() - #Stop())
-	struct timeval fStartTime; ///< Timestamp when the counter started running
-	float fTotalTime; ///< Total accumulated time between all Start() and Stop()
+	int fNCalls; ///< Number of time the counter has been started
+	struct timespec fStartTime; ///< Timestamp when the counter started running
+	double fTotalTime; ///< Total accumulated time between all Start() and Stop()
 };
 } /* namespace NA62Analysis */
 
@@ -0,0 +1,109 @@
+/*
+ * TraceRecorder.hh
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ncl
+ */
+
+#ifndef TRACERECORDER_HH_
+#define TRACERECORDER_HH_
+
+#include <fstream>
+
+#include <TString.h>
+#include <TMutex.h>
+
+#include "TimeCounter.h"
+
+namespace NA62Analysis {
+namespace Core {
+
+/// \class TraceRecorder
+/// \Brief
+/// Record a timeline of the processing in the Chrome trace-event format
+/// \EndBrief
+///
+/// \Detailed
+/// Unique instance recording spans (Begin()/End() pairs) and instantaneous events
+/// (Instant()) in a JSON file that can be loaded in chrome://tracing or
+/// https://ui.perfetto.dev. Each record contains the thread id of the caller so that
+/// spans from different threads are displayed on separate tracks.\n
+/// The events are written to the file as they arrive (JSON array format), so the
+/// timeline remains readable even if the processing is interrupted. When no file has
+/// been opened, all the methods return immediately.\n
+/// Example:\n
+/// \code
+/// TraceRecorder *trace = TraceRecorder::GetInstance();
+/// trace->Begin("LoadEvent", "IO");
+/// ...
+/// trace->End("LoadEvent", "IO");
+/// \endcode
+/// \EndDetailed
+class TraceRecorder {
+public:
+	virtual ~TraceRecorder();
+	static TraceRecorder* GetInstance();
+
+	bool Open(TString fileName);
+	void Close();
+
+	bool IsEnabled() const {
+		/// \MemberDescr
+		/// \return True if a trace file is open
+		/// \EndMemberDescr
+		return fEnabled;
+	}
+
+	void Begin(const TString &name, const char* category, Long64_t iEvent=-1) {
+		/// \MemberDescr
+		/// \param name : Name of the span
+		/// \param category : Category of the span
+		/// \param iEvent : Event index attached to the span (not attached if negative)
+		///
+		/// Open a span on the calling thread
+		/// \EndMemberDescr
+		if(fEnabled) AddRecord('B', name, category, iEvent, "");
+	}
+	void End(const TString &name, const char* category) {
+		/// \MemberDescr
+		/// \param name : Name of the span
+		/// \param category : Category of the span
+		///
+		/// Close the last span opened on the calling thread
+		/// \EndMemberDescr
+		if(fEnabled) AddRecord('E', name, category, -1, "");
+	}
+	void Instant(const TString &name, const char* category, const TString &detail="") {
+		/// \MemberDescr
+		/// \param name : Name of the event
+		/// \param category : Category of the event
+		/// \param detail : Additional text attached to the event (e.g. file name)
+		///
+		/// Record an instantaneous event on the calling thread
+		/// \EndMemberDescr
+		if(fEnabled) AddRecord('i', name, category, -1, detail);
+	}
+	void SetThreadName(const TString &name);
+
+private:
+	TraceRecorder();
+	TraceRecorder(const TraceRecorder&); ///< Non implemented copy-constructor (prevents copy)
+	TraceRecorder& operator=(const TraceRecorder&); ///< Non implemented copy-assignment operator (prevents copy)
+
+	void AddRecord(char phase, const TString &name, const char* category, Long64_t iEvent, const TString &detail);
+	static TString Escape(const TString &s);
+
+	bool fEnabled; ///< Is a trace file open
+	bool fFirstRecord; ///< No record written yet (no separator needed)
+	int fPid; ///< Process id written in each record
+	struct timespec fOrigin; ///< Time origin of the trace
+	std::ofstream fFile; ///< Trace file
+	TMutex fMutex; ///< Mutex protecting the file from concurrent writes
+
+	static TraceRecorder *fTraceRecorder; ///< static pointer to unique instance of the class
+};
+
+} /* namespace Core */
+} /* namespace NA62Analysis */
+
+#endif /* TRACERECORDER_HH_ */
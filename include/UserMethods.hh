@@ -9,6 +9,7 @@
 #define USERMETHODS_HH_
 
 #include <map>
+#include <vector>
 #include <sstream>
 
 #include <TString.h>
@@ -23,6 +24,7 @@
 #include "FWEnums.hh"
 #include "MCSimple.hh"
 #include "IOHandler.hh"
+#include "ColumnFile.hh"
 #include "Verbose.hh"
 
 class RawHeader;
@@ -272,10 +274,13 @@ public:
 			delete obj;
 		}
 	}
+	void RequestProjection(TString detectorName, TString member, TString outputStage="Reco");
 	void AddPrimitiveReader(TString detName, bool sorted=false);
 
 	TChain* GetTree(TString name);
 	TDetectorVEvent *GetEvent(TString detName, TString outputName = "");
+	const std::vector<double>& GetProjection(TString detectorName, TString member, TString outputStage="Reco");
+	Core::ColumnView GetColumn(TString detectorName, TString member, TString outputStage="Reco");
 	Event* GetMCEvent();
 	RawHeader* GetRawHeader();
 	L0TPData* GetL0Data();
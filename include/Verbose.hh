@@ -57,6 +57,12 @@ public:
 		/// \EndMemberDescr
 		return fModuleName;
 	};
+	void SetModuleName(std::string name) {
+		/// \MemberDescr
+		/// \param name : Module display name
+		/// \EndMemberDescr
+		fModuleName = name;
+	};
 
 	void SetStream(std::ostream &s) const {
 		/// \MemberDescr
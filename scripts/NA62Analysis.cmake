@@ -62,6 +62,10 @@ if(CMAKE_COMPILER_IS_GNUCXX)
 		set(CMAKE_CXX_FLAGS "-Wall -Wno-long-long")
 	endif()
 	
+	if(ALLOCATION_COUNTER)
+		message("-- Using Flag: ALLOCATION_COUNTER")
+	endif()
+	
 	# Choose debug flags
 	if(NA62_DEBUG)
 		message("-- Using Flag: NA62_DEBUG")
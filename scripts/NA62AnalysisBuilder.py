@@ -762,6 +762,7 @@ Re-run without --strict-order if you want dependencies to be automatically solve
 		includesList += """#include "%s.hh"\n""" % an;
 		instancesAnalyzer += "\t%s *an_%s = new %s(ban);\n" % (an,an,an)
 		instancesAnalyzer += "\tban->AddAnalyzer(an_%s);\n" % an
+		instancesAnalyzer += "\tban->AddScanCopies(an_%s);\n" % an
 		deleteAnalyzer += "\tdelete an_%s;\n" % an
 	
 	readAndReplace("%s/Templates/main.cc" % FWPath, "%s/main.cc" % UserPath, {"$$ANALYZERSINCLUDE$$":includesList, "/*$$ANALYZERSNEW$$*/":instancesAnalyzer, "/*$$ANALYZERSDELETE$$*/":deleteAnalyzer})
@@ -876,6 +877,8 @@ def parseArgs():
 							dest="defines", help="Compile the framework and user directories with all the warning flags")
 	clean_group.add_argument('--shared', action="append_const", const="SHARED_LIB", 
 							dest="defines", help="Use shared libraries rather than static libraries")
+	clean_group.add_argument('--count-allocations', action="append_const", const="ALLOCATION_COUNTER", 
+							dest="defines", help="Replace the global allocation functions to count the heap allocations (needed by --count-alloc of the analysis executable)")
 	
 	parser = ArgumentParser(description=program_short_description, formatter_class=RawDescriptionHelpFormatter)
 	parser.add_argument('-V', '--version', action='version', version=program_version_message)
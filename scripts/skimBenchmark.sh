@@ -0,0 +1,65 @@
+#!/bin/bash
+#
+# Compare the throughput of the skimming modes of IOTree::WriteEvent.
+#
+# Usage: skimBenchmark.sh "branch1,branch2,..." executable [executable options]
+#
+# The executable (a skimming analysis built with the framework) is run three times
+# on the same input:
+#  - full:      all the input branches are exported, events filled one by one
+#  - selective: only the listed branches are exported (SkimBranches setting)
+#  - fast:      selective + copy of the compressed baskets (FastSkim setting)
+# For each mode the wall time, the number of events per second and the size of
+# the output file are printed. The output file is given with -o (default outFile.root)
+# and is overwritten by each run.
+
+if [ $# -lt 2 ]; then
+	echo "Usage: $0 \"branch1,branch2,...\" executable [executable options]"
+	exit 1
+fi
+
+BRANCHES=$1
+shift
+
+OUTFILE=outFile.root
+ARGS=("$@")
+for ((i=0; i<${#ARGS[@]}; i++)); do
+	if [ "${ARGS[$i]}" == "-o" ] || [ "${ARGS[$i]}" == "--output" ]; then
+		OUTFILE=${ARGS[$((i+1))]}
+	fi
+done
+
+USERDIR=${ANALYSISFW_USERDIR:-$PWD}
+WORKDIR=$(mktemp -d)
+trap "rm -rf $WORKDIR" EXIT
+
+run_mode() {
+	local mode=$1
+	local skimBranches=$2
+	local fastSkim=$3
+
+	if [ -f $USERDIR/.settingsna62 ]; then
+		grep -v -i "^ *\(SkimBranches\|FastSkim\) *=" $USERDIR/.settingsna62 > $WORKDIR/.settingsna62
+	else
+		echo "[Global]" > $WORKDIR/.settingsna62
+	fi
+	echo "SkimBranches = $skimBranches" >> $WORKDIR/.settingsna62
+	echo "FastSkim = $fastSkim" >> $WORKDIR/.settingsna62
+
+	local start=$(date +%s.%N)
+	ANALYSISFW_USERDIR=$WORKDIR "${ARGS[@]}" > $WORKDIR/$mode.log 2>&1
+	local ret=$?
+	local end=$(date +%s.%N)
+
+	local nevents=$(grep -o "Exported [0-9]*" $WORKDIR/$mode.log | awk '{print $2}')
+	local size=$(stat -c %s $OUTFILE 2>/dev/null)
+	echo "$mode $ret $start $end ${nevents:-0} ${size:-0}" | awk '{
+		t=$4-$3;
+		printf "%-10s exit %d  time %8.2f s  exported %10d events  %10.1f events/s  output %8.2f MB\n",
+			$1, $2, t, $5, (t>0 ? $5/t : 0), $6/1048576.
+	}'
+}
+
+run_mode full "" false
+run_mode selective "$BRANCHES" false
+run_mode fast "$BRANCHES" true
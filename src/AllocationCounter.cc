@@ -0,0 +1,114 @@
+/*
+ * AllocationCounter.cc
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ncl
+ */
+
+#include "AllocationCounter.hh"
+
+#include <iostream>
+
+#include "StringTable.hh"
+
+namespace NA62Analysis {
+namespace Core {
+
+bool AllocationCounter::fAvailable = false;
+thread_local bool AllocationCounter::fCounting = false;
+int AllocationCounter::fSlot = 0;
+Long64_t AllocationCounter::fNAllocations[AllocationCounter::fgMaxSlots];
+Long64_t AllocationCounter::fNFrees[AllocationCounter::fgMaxSlots];
+Long64_t AllocationCounter::fBytes[AllocationCounter::fgMaxSlots];
+Long64_t AllocationCounter::fTotalAllocations = 0;
+Long64_t AllocationCounter::fLastEventAllocations = 0;
+Long64_t AllocationCounter::fMaxEventAllocations = 0;
+Long64_t AllocationCounter::fMaxEvent = -1;
+
+void AllocationCounter::Start() {
+	/// \MemberDescr
+	/// Start counting the allocations made by the calling thread
+	/// \EndMemberDescr
+
+	fLastEventAllocations = fTotalAllocations;
+	fCounting = true;
+}
+
+void AllocationCounter::Stop() {
+	/// \MemberDescr
+	/// Stop counting the allocations made by the calling thread
+	/// \EndMemberDescr
+
+	fCounting = false;
+}
+
+void AllocationCounter::Reset() {
+	/// \MemberDescr
+	/// Reset all the counters
+	/// \EndMemberDescr
+
+	for(int i=0; i<fgMaxSlots; ++i){
+		fNAllocations[i] = 0;
+		fNFrees[i] = 0;
+		fBytes[i] = 0;
+	}
+	fSlot = 0;
+	fTotalAllocations = 0;
+	fLastEventAllocations = 0;
+	fMaxEventAllocations = 0;
+	fMaxEvent = -1;
+}
+
+void AllocationCounter::EndEvent(Long64_t iEvent) {
+	/// \MemberDescr
+	/// \param iEvent : Index of the event
+	///
+	/// Mark the end of an event and keep track of the event with the largest number
+	/// of allocations
+	/// \EndMemberDescr
+
+	Long64_t nAllocations = fTotalAllocations - fLastEventAllocations;
+	if(nAllocations>fMaxEventAllocations){
+		fMaxEventAllocations = nAllocations;
+		fMaxEvent = iEvent;
+	}
+	fLastEventAllocations = fTotalAllocations;
+}
+
+void AllocationCounter::Print(const std::vector<TString> &slotNames, Long64_t nEvents) {
+	/// \MemberDescr
+	/// \param slotNames : Names of the slots to print
+	/// \param nEvents : Number of processed events
+	///
+	/// Print the number of allocations, deallocations and allocated bytes per slot
+	/// (total and per event)
+	/// \EndMemberDescr
+
+	if(fTotalAllocations==0) return;
+	double n = nEvents>0 ? nEvents : 1;
+
+	StringTable allocTable("Heap allocations");
+	allocTable.AddColumn("slot", "Slot");
+	allocTable.AddColumn("allocs", "Allocations");
+	allocTable.AddColumn("allocsEvt", "Allocations/event");
+	allocTable.AddColumn("frees", "Frees/event");
+	allocTable.AddColumn("bytes", "Allocated (MB)");
+	allocTable.AddColumn("bytesEvt", "Allocated/event (kB)");
+	allocTable.AddColumn("share", "Share (%)");
+	allocTable << sepr;
+	for(unsigned int i=0; i<slotNames.size() && i<(unsigned int)fgMaxSlots; ++i){
+		allocTable << slotNames[i]
+				<< TString::Format("%lld", fNAllocations[i])
+				<< TString::Format("%.1f", fNAllocations[i]/n)
+				<< TString::Format("%.1f", fNFrees[i]/n)
+				<< TString::Format("%.2f", fBytes[i]/1048576.)
+				<< TString::Format("%.2f", fBytes[i]/1024./n)
+				<< TString::Format("%.1f", 100.*fNAllocations[i]/fTotalAllocations);
+	}
+	allocTable.Print("");
+
+	std::cout << "Largest number of allocations: " << fMaxEventAllocations << " in event " << fMaxEvent << std::endl;
+}
+
+} /* namespace Core */
+} /* namespace NA62Analysis */
@@ -2,6 +2,7 @@
 
 #include "BaseAnalysis.hh"
 #include "StringTable.hh"
+#include "OutputWriter.hh"
 
 namespace NA62Analysis {
 
@@ -12,6 +13,10 @@ Analyzer::Analyzer(Core::BaseAnalysis *ba) :
 		fDetectorAcceptanceInstance(NULL),
 		fState(kUninit),
 		fExportEvent(false),
+		fMultiPass(false),
+		fSelectCachedEvents(false),
+		fCacheEvent(false),
+		fAnotherPass(false),
 		fParticleInterface(ParticleInterface::GetParticleInterface())
 {
 	/// \MemberDescr
@@ -28,6 +33,10 @@ Analyzer::Analyzer(Core::BaseAnalysis *ba, std::string name) :
 		fDetectorAcceptanceInstance(NULL),
 		fState(kUninit),
 		fExportEvent(false),
+		fMultiPass(false),
+		fSelectCachedEvents(false),
+		fCacheEvent(false),
+		fAnotherPass(false),
 		fParticleInterface(ParticleInterface::GetParticleInterface())
 {
 	/// \MemberDescr
@@ -44,9 +53,15 @@ Analyzer::Analyzer(const Analyzer& c) :
 		fIncompleteMCWarned(c.fIncompleteMCWarned),
 		fDetectorAcceptanceInstance(c.fDetectorAcceptanceInstance),
 		fOutTree(c.fOutTree),
+		fFriendTree(c.fFriendTree),
 		fParams(c.fParams),
 		fState(c.fState),
 		fExportEvent(c.fExportEvent),
+		fExportStreams(c.fExportStreams),
+		fMultiPass(c.fMultiPass),
+		fSelectCachedEvents(c.fSelectCachedEvents),
+		fCacheEvent(c.fCacheEvent),
+		fAnotherPass(c.fAnotherPass),
 		fExportCandidates(c.fExportCandidates),
 		fExportCandidatesNumber(c.fExportCandidatesNumber),
 		fParticleInterface(ParticleInterface::GetParticleInterface())
@@ -79,6 +94,18 @@ TString Analyzer::GetAnalyzerName() const{
 	return fAnalyzerName;
 }
 
+void Analyzer::SetAnalyzerName(TString name){
+	/// \MemberDescr
+	/// \param name : New name of the Analyzer
+	///
+	/// Rename the analyzer (e.g. instance of a parameter scan point). Must be called before
+	/// the histograms, counters and outputs are booked, as they are identified by this name.
+	/// \EndMemberDescr
+
+	fAnalyzerName = name;
+	SetModuleName(name.Data());
+}
+
 void Analyzer::ExportEvent(){
 	/// \MemberDescr
 	/// Ask BaseAnalysis to store the event in the output file.
@@ -89,6 +116,22 @@ void Analyzer::ExportEvent(){
 	fExportEvent = true;
 }
 
+void Analyzer::ExportEvent(TString streamName){
+	/// \MemberDescr
+	/// \param streamName : Name of the export stream
+	///
+	/// Ask BaseAnalysis to store the event in the output file of the named stream
+	/// (see the [Streams] section of the settings file). Each stream has its own output
+	/// file and branch selection, and all the streams are written in the same pass.
+	/// Acts only on the trees copied from the inputs.
+	/// \EndMemberDescr
+
+	for(auto stream : fExportStreams){
+		if(stream.CompareTo(streamName)==0) return;
+	}
+	fExportStreams.push_back(streamName);
+}
+
 bool Analyzer::GetExportEvent() const{
 	/// \MemberDescr
 	/// Did the analyzer asked to export the event?
@@ -98,6 +141,90 @@ bool Analyzer::GetExportEvent() const{
 	return fExportEvent;
 }
 
+void Analyzer::DefineTag(TString name){
+	/// \MemberDescr
+	/// \param name : Name of the tag
+	///
+	/// To be called in the constructor or in InitHist(). Define a boolean tag which can be set
+	/// for each event with SetTag(). With --make-tags, the tags of each processed event are
+	/// written in a tag file, from which later jobs read only the events matching a tag
+	/// expression (--tags and --tag-select). At most 64 tags can be defined by all the analyzers.
+	/// \EndMemberDescr
+
+	if(fParent->GetEventTags()->DefineTag(name)<0)
+		std::cout << normal() << "Tag " << name << " cannot be defined" << std::endl;
+}
+
+void Analyzer::SetTag(TString name, bool value){
+	/// \MemberDescr
+	/// \param name : Name of the tag (see DefineTag())
+	/// \param value : Value of the tag for the current event
+	///
+	/// Set the tag for the current event. The tags are cleared before each event.
+	/// \EndMemberDescr
+
+	fParent->GetEventTags()->SetTag(name, value);
+}
+
+void Analyzer::EnableMultiPass(bool selectEvents){
+	/// \MemberDescr
+	/// \param selectEvents : If true, only the events for which CacheEvent() is called are kept
+	///
+	/// To be called in the constructor or in InitHist(). During the first pass, the requested
+	/// events and objects of each event (or of the events selected with CacheEvent() by one of the
+	/// analyzers asking it) are kept decompressed in memory, or in a temporary file beyond the
+	/// EventCacheSize setting. EndOfPassUser() is called at the end of each pass and the events are
+	/// processed again from this cache as long as an analyzer calls RequestAnotherPass().\n
+	/// Output trees, friend trees and exported events are only filled during the first pass, and
+	/// StartOfBurst/EndOfBurst are not called during the next passes.
+	/// \EndMemberDescr
+
+	fMultiPass = true;
+	fSelectCachedEvents = fSelectCachedEvents || selectEvents;
+}
+
+void Analyzer::CacheEvent(){
+	/// \MemberDescr
+	/// Keep the current event for the next passes (see EnableMultiPass())
+	/// \EndMemberDescr
+
+	fCacheEvent = true;
+}
+
+void Analyzer::RequestAnotherPass(){
+	/// \MemberDescr
+	/// Ask BaseAnalysis to process again the cached events after the current pass
+	/// (see EnableMultiPass()). Can be called during the pass or in EndOfPassUser().
+	/// \EndMemberDescr
+
+	if(!fMultiPass){
+		std::cout << normal() << "Another pass is requested but EnableMultiPass() was not called: ignored" << std::endl;
+		return;
+	}
+	fAnotherPass = true;
+}
+
+int Analyzer::GetPass() const{
+	/// \MemberDescr
+	/// \return Index of the current pass over the events (0 for the first pass)
+	/// \EndMemberDescr
+
+	return fParent->GetPass();
+}
+
+bool Analyzer::EndOfPass(){
+	/// \MemberDescr
+	/// \return True if the analyzer requested another pass
+	///
+	/// Called by BaseAnalysis at the end of each pass of a multi-pass analysis
+	/// \EndMemberDescr
+
+	EndOfPassUser();
+	bool anotherPass = fAnotherPass;
+	fAnotherPass = false;
+	return anotherPass;
+}
+
 void Analyzer::PreProcess(){
 	/// \MemberDescr
 	/// Called before Process(). Resets the fExportEvent variable.
@@ -107,6 +234,8 @@ void Analyzer::PreProcess(){
 	std::map<TString, int>::iterator itNum;
 
 	fExportEvent = false;
+	fCacheEvent = false;
+	fExportStreams.clear();
 
 	for(itArr=fExportCandidates.begin(); itArr!=fExportCandidates.end(); itArr++){
 		itArr->second.Clear();
@@ -303,6 +432,7 @@ void Analyzer::OpenNewTree(TString name, TString title){
 	/// \EndMemberDescr
 	TTree *outTree = new TTree(name, title);
 	fOutTree.insert(std::pair<TString, TTree*>(name, outTree));
+	Core::OutputTreeSettings::GetInstance()->Apply(outTree);
 }
 
 void Analyzer::FillTrees(){
@@ -314,7 +444,8 @@ void Analyzer::FillTrees(){
 	std::map<TString, TClonesArray>::iterator itCand;
 
 	for(it=fOutTree.begin(); it!=fOutTree.end(); it++){
-		it->second->Fill();
+		if(fFriendTree.count(it->first)>0) continue;
+		OutputWriter::GetInstance()->Fill(it->second);
 	}
 
 	for(itCand=fExportCandidates.begin(); itCand!=fExportCandidates.end(); itCand++){
@@ -335,6 +466,37 @@ void Analyzer::WriteTrees(){
 	}
 }
 
+void Analyzer::OpenFriendTree(TString name, TString title){
+	/// \MemberDescr
+	/// \param name : Name of the TTree
+	/// \param title : Title of the TTree
+	///
+	/// Create a new TTree in the output file, aligned entry by entry with the input
+	/// events. Branches are added with AddBranch(). The tree is filled by the framework
+	/// once for each processed event, after Process(): do not fill it with FillTrees().\n
+	/// The output file can then be given with --friend to a later job reading the same
+	/// input files: the branches of this tree are read with RequestTree(name, branchName, ...)
+	/// as if they were part of the input files.\n
+	/// The alignment requires that all the events are processed from the first one
+	/// (no --start nor downscaling). The entries of the events which cannot be read repeat
+	/// the values of the previous event.
+	/// \EndMemberDescr
+	OpenNewTree(name, title);
+	fFriendTree.insert(std::pair<TString, TTree*>(name, fOutTree[name]));
+}
+
+void Analyzer::FillFriendTrees(){
+	/// \MemberDescr
+	/// Fill the TTrees created via OpenFriendTree(). Called by the framework for each event.
+	/// \EndMemberDescr
+
+	std::map<TString, TTree*>::iterator it;
+
+	for(it=fFriendTree.begin(); it!=fFriendTree.end(); it++){
+		OutputWriter::GetInstance()->Fill(it->second);
+	}
+}
+
 void Analyzer::printNoMCWarning() const{
 	/// \MemberDescr
 	/// Print a warning message when no MC data are present and the analyzer requires them.
@@ -380,7 +542,9 @@ void Analyzer::FillMCSimple(Event* mcTruthEvent) {
 	/// Extract informations from current Event and store them internally for later easy access
 	/// \EndMemberDescr
 
+	fTimeCounter[kTimeMCSimple].Start();
 	fMCSimple.GetRealInfos(mcTruthEvent);
+	fTimeCounter[kTimeMCSimple].Stop();
 }
 
 void Analyzer::printIncompleteMCWarning(int iEvent) const{
@@ -406,7 +570,9 @@ void Analyzer::StartOfBurst(){
 	/// \EndMemberDescr
 
 	//TODO do some things
+	fTimeCounter[kTimeStartOfBurst].Start();
 	StartOfBurstUser();
+	fTimeCounter[kTimeStartOfBurst].Stop();
 }
 
 void Analyzer::EndOfBurst(){
@@ -415,7 +581,9 @@ void Analyzer::EndOfBurst(){
 	/// \EndMemberDescr
 
 	//TODO do some things
+	fTimeCounter[kTimeEndOfBurst].Start();
 	EndOfBurstUser();
+	fTimeCounter[kTimeEndOfBurst].Stop();
 }
 
 void Analyzer::StartOfRun(){
@@ -436,6 +604,30 @@ void Analyzer::EndOfRun(){
 	EndOfRunUser();
 }
 
+TString Analyzer::GetTimingPhaseName(TimingPhase phase){
+	/// \MemberDescr
+	/// \param phase : Processing phase
+	/// \return Display name of the processing phase
+	/// \EndMemberDescr
+
+	switch(phase){
+	case kTimeProcess:
+		return "Process";
+	case kTimePostProcess:
+		return "PostProcess";
+	case kTimeUpdatePlots:
+		return "UpdatePlots";
+	case kTimeStartOfBurst:
+		return "StartOfBurst";
+	case kTimeEndOfBurst:
+		return "EndOfBurst";
+	case kTimeMCSimple:
+		return "FillMCSimple";
+	default:
+		return "Unknown";
+	}
+}
+
 void Analyzer::CreateStandardTree(TString name, TString title){
 	/// \MemberDescr
 	/// \param name : name of the TTree (for future reference in the code)
@@ -1,26 +1,38 @@
 #include "BaseAnalysis.hh"
 
+#include <algorithm>
 #include <iomanip>
 #include <sstream>
 #include <TStyle.h>
 #include <TFile.h>
+#include <TH2D.h>
 #include <TThread.h>
 #include <TGClient.h>
+#include <TParameter.h>
+#include <TSystem.h>
+#include <TObjString.h>
 
 #include "ConfigAnalyzer.hh"
 #include "StringBalancedTable.hh"
+#include "StringTable.hh"
 #include "TermManip.hh"
 #include "ConfigSettings.hh"
 #include "OMMainWindow.hh"
 #include "IOPrimitive.hh"
+#include "IOColumns.hh"
+#include "TraceRecorder.hh"
+#include "AllocationCounter.hh"
+#include "OutputWriter.hh"
 
 namespace NA62Analysis {
 namespace Core {
 
 BaseAnalysis::BaseAnalysis() :
-		Verbose("BaseAnalysis"), fNEvents(-1), fEventsDownscaling(0), fGraphicMode(
+		Verbose("BaseAnalysis"), fNEvents(-1), fEventsDownscaling(0), fSamplingFraction(0), fGraphicMode(
 				false), fInitialized(false), fContinuousReading(false), fSignalStop(
-				false), fDetectorAcceptanceInstance(nullptr), fIOHandler(
+				false), fCountAllocations(false), fCheckpointEvents(0), fCheckpointBursts(
+				0), fBurstsSinceCheckpoint(0), fResume(false), fPass(0), fDetectorAcceptanceInstance(
+				nullptr), fIOHandler(
 		nullptr), fIOPrimitive(nullptr), fInitTime(true), fRunThread(nullptr), fOMMainWindow(
 		nullptr) {
 	/// \MemberDescr
@@ -30,6 +42,10 @@ BaseAnalysis::BaseAnalysis() :
 	Configuration::ConfigSettings().ParseFile(
 			TString(std::getenv("ANALYSISFW_USERDIR"))
 					+ TString("/.settingsna62"));
+	for (auto &it : Configuration::ConfigSettings::output::fTreeSettings)
+		OutputTreeSettings::GetInstance()->SetSettings(it.first, it.second);
+	fCheckpointEvents = Configuration::ConfigSettings::global::fCheckpointEvents;
+	fCheckpointBursts = Configuration::ConfigSettings::global::fCheckpointBursts;
 	gStyle->SetOptFit(1);
 	NA62Analysis::manip::enableManip =
 			Configuration::ConfigSettings::global::fUseColors
@@ -53,6 +69,9 @@ BaseAnalysis::~BaseAnalysis() {
 	}
 	if (fDetectorAcceptanceInstance)
 		delete fDetectorAcceptanceInstance;
+	for (auto copy : fScanCopies)
+		delete copy;
+	TraceRecorder::GetInstance()->Close();
 }
 
 void BaseAnalysis::Init(TString inFileName, TString outFileName, TString params,
@@ -77,10 +96,14 @@ void BaseAnalysis::Init(TString inFileName, TString outFileName, TString params,
 	//Check all the data are present
 	//##############################
 	TString anName, anParams;
+	TraceRecorder *trace = TraceRecorder::GetInstance();
 
+	trace->Begin("Init", "Run");
 	std::cout << debug() << "Initializing... " << std::endl;
-	if (!fIOHandler->OpenInput(inFileName, NFiles))
+	if (!fIOHandler->OpenInput(inFileName, NFiles)) {
+		trace->End("Init", "Run");
 		return;
+	}
 
 	fIOHandler->OpenOutput(outFileName);
 
@@ -97,6 +120,8 @@ void BaseAnalysis::Init(TString inFileName, TString outFileName, TString params,
 		std::cout << debug() << "Using " << fNEvents << " events" << std::endl;
 	} else if (IsHistoType())
 		fNEvents = fIOHandler->GetInputFileNumber();
+	else if (IsColumnType())
+		fNEvents = fIOHandler->GetNEvents();
 
 	int testEvent = 0;
 	while (!fIOHandler->LoadEvent(testEvent) && testEvent < fNEvents)
@@ -123,10 +148,27 @@ void BaseAnalysis::Init(TString inFileName, TString outFileName, TString params,
 		fIOHandler->MkOutputDir(fAnalyzerList[i]->GetAnalyzerName());
 		gFile->cd(fAnalyzerList[i]->GetAnalyzerName());
 
-		confParser.ApplyParams(fAnalyzerList[i]);
+		auto scanPoint = fScanPoints.find(fAnalyzerList[i]->GetAnalyzerName());
+		if (scanPoint == fScanPoints.end())
+			confParser.ApplyParams(fAnalyzerList[i]);
+		else {
+			//Common parameters of the scanned analyzer, then the parameters of the scan point
+			confParser.ApplyParams(fAnalyzerList[i], scanPoint->second.first);
+			fParameterScan.ApplyPoint(fAnalyzerList[i], scanPoint->second.first,
+					scanPoint->second.second);
+			TString description = fParameterScan.GetPointDescription(
+					scanPoint->second.first, scanPoint->second.second);
+			std::cout << normal() << "Scan point " << scanPoint->second.second
+					<< " of " << scanPoint->second.first << ": "
+					<< fAnalyzerList[i]->GetAnalyzerName() << " (" << description
+					<< ")" << std::endl;
+			TObjString(description).Write("ScanPoint");
+		}
 
 		fAnalyzerList[i]->InitOutput();
 		fAnalyzerList[i]->InitHist();
+		fIOHandler->AddSnapshotHistos(fAnalyzerList[i]->GetAnalyzerName(),
+				fAnalyzerList[i]->GetHistoHandler());
 
 		fAnalyzerList[i]->DefineMCSimple();
 		fAnalyzerList[i]->PrintInitSummary();
@@ -137,6 +179,7 @@ void BaseAnalysis::Init(TString inFileName, TString outFileName, TString params,
 
 	fInitialized = true;
 	fInitTime.Stop();
+	trace->End("Init", "Run");
 }
 
 void BaseAnalysis::AddAnalyzer(Analyzer* an) {
@@ -152,6 +195,39 @@ void BaseAnalysis::AddAnalyzer(Analyzer* an) {
 	fAnalyzerList.push_back(an);
 }
 
+void BaseAnalysis::SetParameterScan(TString scan) {
+	/// \MemberDescr
+	/// \param scan : Scan specification (see ParameterScan), or path to a file containing it
+	///
+	/// Process several parameter sets of the same analyzers in a single pass over the
+	/// events. Must be called before adding the analyzers: each scanned analyzer is copied for
+	/// each scan point (see AddScanCopies), and all the copies process the same events. Each
+	/// copy has its own directory in the output file (with the parameters of the scan point in
+	/// ScanPoint), its own counters and its own outputs.
+	/// \EndMemberDescr
+
+	fParameterScan.Parse(scan);
+	if (TestLevel(Verbosity::kNormal))
+		fParameterScan.Print();
+}
+
+void BaseAnalysis::AddScanCopy(Analyzer * const reference, Analyzer * const copy,
+		int point) {
+	/// \MemberDescr
+	/// \param reference : Pointer to the scanned analyzer (first scan point)
+	/// \param copy : Pointer to a new instance of the same analyzer class
+	/// \param point : Index of the scan point processed by the copy
+	///
+	/// Rename the copy after the scan point and add it to the analyzers
+	/// \EndMemberDescr
+
+	TString name = TString::Format("%s_scan%d", reference->GetAnalyzerName().Data(), point);
+	copy->SetAnalyzerName(name);
+	fScanCopies.push_back(copy);
+	fScanPoints[name] = std::make_pair(reference->GetAnalyzerName(), point);
+	AddAnalyzer(copy);
+}
+
 void BaseAnalysis::RegisterOutput(TString name, const void * const address) {
 	/// \MemberDescr
 	/// \param name : Name of the output
@@ -230,15 +306,28 @@ bool BaseAnalysis::Process(Long64_t beginEvent, Long64_t maxEvent) {
 	if (!fInitialized)
 		return false;
 
+	if (fResume) {
+		Long64_t lastEntry = ReadCheckpoint();
+		if (lastEntry >= 0) {
+			if (maxEvent > 0)
+				maxEvent -= lastEntry + 1 - beginEvent;
+			beginEvent = lastEntry + 1;
+		}
+	}
+
+	using NA62Analysis::operator -;
+	TraceRecorder *trace = TraceRecorder::GetInstance();
 	TimeCounter processLoopTime;
 	TimeCounter processTime;
+	struct timespec eventStartTime;
+	Long64_t processedEvents = 0;
 	int i_offset;
 	bool exportEvent = false;
 
 	processLoopTime.Start();
 
 	std::string displayType;
-	if (IsTreeType())
+	if (IsTreeType() || IsColumnType())
 		displayType = "Event";
 	else if (IsHistoType())
 		displayType = "File";
@@ -258,12 +347,17 @@ bool BaseAnalysis::Process(Long64_t beginEvent, Long64_t maxEvent) {
 		i_offset = 1;
 	std::cout << extended() << "i_offset : " << i_offset << std::endl;
 
+	trace->Begin("StartOfRun", "Run");
 	for (unsigned int j = 0; j < fAnalyzerList.size(); j++) {
 		gFile->cd(fAnalyzerList[j]->GetAnalyzerName());
 		fAnalyzerList[j]->StartOfRun();
-		if (IsTreeType())
+		if (IsTreeType() || IsColumnType())
 			fAnalyzerList[j]->StartOfBurst();
 	}
+	trace->End("StartOfRun", "Run");
+
+	fLatency.Reset();
+	fLatency.NewBurst(std::max(fIOHandler->GetCurrentFileNumber(), 0));
 
 	//##############################
 	//Begin event loop
@@ -271,50 +365,167 @@ bool BaseAnalysis::Process(Long64_t beginEvent, Long64_t maxEvent) {
 	int defaultPrecision = std::cout.precision();
 	Long64_t processEvents = std::min(beginEvent + maxEvent, fNEvents);
 
+	if (fSamplingFraction > 0 && GetIOTree()->GetClusterEnd(beginEvent) < 0) {
+		std::cout << normal()
+				<< "Sampling is not available with entry lists and event selections: all events processed"
+				<< std::endl;
+		fSamplingFraction = 0;
+	}
+	Long64_t sampledClusterEnd = -1;
+	Long64_t nSampledClusters = 0;
+	Long64_t nSkippedClusters = 0;
+	bool friendsSkipWarned = false;
+
+	if (beginEvent > 0 || fEventsDownscaling > 0 || fSamplingFraction > 0) {
+		for (unsigned int j = 0; j < fAnalyzerList.size(); j++) {
+			if (fAnalyzerList[j]->HasFriendTrees())
+				std::cout << normal() << "Warning: the friend trees of "
+						<< fAnalyzerList[j]->GetAnalyzerName()
+						<< " will not be aligned with the input events (--start, downscaling or sampling used)"
+						<< std::endl;
+		}
+	}
+
+	//Multi-pass analysis: keep the events for the next passes
+	fPass = 0;
+	bool multiPass = false;
+	bool selectCachedEvents = false;
+	for (unsigned int j = 0; j < fAnalyzerList.size(); j++) {
+		multiPass = multiPass || fAnalyzerList[j]->IsMultiPass();
+		selectCachedEvents = selectCachedEvents
+				|| fAnalyzerList[j]->GetSelectCachedEvents();
+	}
+	if (multiPass && (!IsTreeType() || fContinuousReading)) {
+		std::cout << normal()
+				<< "Multi-pass analysis is only available for TTree inputs without continuous reading: single pass"
+				<< std::endl;
+		multiPass = false;
+	}
+	if (multiPass && !GetIOTree()->StartEventCache())
+		multiPass = false;
+
+	if (IsTreeType() && GetIOTree()->GetBranchUsage()) {
+		std::vector<TString> analyzerNames;
+		for (unsigned int j = 0; j < fAnalyzerList.size(); j++)
+			analyzerNames.push_back(fAnalyzerList[j]->GetAnalyzerName());
+		GetIOTree()->GetBranchUsage()->SetAnalyzers(analyzerNames);
+	}
+
+	if (fTagOutput.Length() > 0) {
+		if (IsTreeType())
+			fEventTags.OpenOutput(fTagOutput);
+		else
+			std::cout << normal() << "Tag files can only be written when reading TTrees" << std::endl;
+	}
+
+	//Started once all the output files are open: from now on, the files are only created
+	//or written after synchronisation with the writer thread
+	if (Configuration::ConfigSettings::global::fWriterQueueSize > 0)
+		OutputWriter::GetInstance()->Start(
+				Configuration::ConfigSettings::global::fWriterQueueSize);
+
+	if (fCountAllocations && !AllocationCounter::IsAvailable()) {
+		std::cout << normal()
+				<< "Allocation counting requires the framework built with --count-allocations: disabled"
+				<< std::endl;
+		fCountAllocations = false;
+	}
+	if (fCountAllocations) {
+		AllocationCounter::Reset();
+		AllocationCounter::Start();
+	}
+
 	for (Long64_t i = beginEvent; (i < processEvents || processEvents < 0);
 			i++) {
 		//Print current event
 		if (i % i_offset == 0) {
-			printCurrentEvent(i, processEvents, defaultPrecision, displayType,
+			Long64_t totalEvents = processEvents;
+			if (fIOHandler->IsFastStart() && IsTreeType()) {
+				//Files scanned in background give the total (or an estimate) before the end
+				GetIOTree()->UpdateInputScan();
+				fNEvents = GetIOTree()->GetNEvents();
+				if (fNEvents < processEvents)
+					processEvents = fNEvents;
+				totalEvents = std::min(processEvents,
+						GetIOTree()->GetNEventsEstimate());
+			}
+			printCurrentEvent(i, totalEvents, defaultPrecision, displayType,
 					processLoopTime);
 		}
+		if (fSamplingFraction > 0 && i >= sampledClusterEnd) {
+			//Skip the whole cluster: none of its baskets is read
+			Long64_t clusterEnd = GetIOTree()->GetClusterEnd(i);
+			if (clusterEnd > i && !IsClusterSampled(clusterEnd)) {
+				++nSkippedClusters;
+				i = clusterEnd - 1;
+				continue;
+			}
+			++nSampledClusters;
+			sampledClusterEnd = clusterEnd;
+		}
 		if (fEventsDownscaling > 0 && (i % fEventsDownscaling != 0))
 			continue;
 
 		// Load event infos
-		if (!fIOHandler->LoadEvent(i))
-			std::cout << normal() << "Unable to read event " << i << std::endl;
+		eventStartTime = TimeCounter::GetTime();
+		AllocationCounter::SetSlot(kAllocLoadEvent);
+		trace->Begin("LoadEvent", "IO", i);
+		if (!fIOHandler->LoadEvent(i)) {
+			//Not available (e.g. in a file that could not be opened): not processed
+			std::cout << normal() << "Unable to read event " << i << ": skipped" << std::endl;
+			trace->End("LoadEvent", "IO");
+			//Keep the friend trees aligned with the input events: the entry of the skipped
+			//event repeats the values of the previous one
+			for (unsigned int j = 0; j < fAnalyzerList.size(); j++) {
+				if (!fAnalyzerList[j]->HasFriendTrees())
+					continue;
+				if (!friendsSkipWarned)
+					std::cout << normal() << "Warning: the friend trees of "
+							<< fAnalyzerList[j]->GetAnalyzerName()
+							<< " are filled with the previous values for the events which cannot be read"
+							<< std::endl;
+				fAnalyzerList[j]->FillFriendTrees();
+			}
+			friendsSkipWarned = true;
+			continue;
+		}
+		trace->End("LoadEvent", "IO");
 		CheckNewFileOpened();
 
 		processTime.Start();
-		PreProcess();
-		//Process event in Analyzer
-		exportEvent = false;
-		for (unsigned int j = 0; j < fAnalyzerList.size(); j++) {
-			//Get MCSimple
-			gFile->cd(fAnalyzerList[j]->GetAnalyzerName());
-			if (IsTreeType() && static_cast<IOTree*>(fIOHandler)->GetWithMC())
-				fAnalyzerList[j]->FillMCSimple(
-						static_cast<IOTree*>(fIOHandler)->GetMCTruthEvent());
-
-			fAnalyzerList[j]->Process(i);
-			if (fGraphicalMutex.Lock() == 0) {
-				fAnalyzerList[j]->UpdatePlots(i);
-				fGraphicalMutex.UnLock();
-			}
-			exportEvent = exportEvent || fAnalyzerList[j]->GetExportEvent();
-			gFile->cd();
+		++processedEvents;
+		exportEvent = ProcessEvent(i);
+		processTime.Stop();
+
+		if (fEventTags.IsOutputOpen()) {
+			TString tagFileName, tagTreeName;
+			Long64_t localEntry;
+			if (GetIOTree()->GetCurrentEntry(tagFileName, tagTreeName, localEntry))
+				fEventTags.Fill(tagFileName, tagTreeName, localEntry);
 		}
 
-		for (unsigned int j = 0; j < fAnalyzerList.size(); j++) {
-			gFile->cd(fAnalyzerList[j]->GetAnalyzerName());
-			fAnalyzerList[j]->PostProcess();
-			gFile->cd();
+		if (multiPass) {
+			bool cacheEvent = !selectCachedEvents;
+			for (unsigned int j = 0; j < fAnalyzerList.size() && !cacheEvent; j++)
+				cacheEvent = fAnalyzerList[j]->GetCacheEvent();
+			if (cacheEvent)
+				GetIOTree()->CacheEvent(i);
 		}
-		processTime.Stop();
 
+		AllocationCounter::SetSlot(kAllocWriteEvent);
 		if (IsTreeType() && exportEvent)
 			static_cast<IOTree*>(fIOHandler)->WriteEvent();
+		if (IsTreeType()) {
+			WriteEventStreams();
+			GetIOTree()->WriteColumns();
+		}
+		fLatency.AddEvent(i, TimeCounter::GetTime() - eventStartTime);
+		AllocationCounter::EndEvent(i);
+
+		if ((fCheckpointEvents > 0 && processedEvents % fCheckpointEvents == 0)
+				|| (fCheckpointBursts > 0
+						&& fBurstsSinceCheckpoint >= fCheckpointBursts))
+			WriteCheckpoint(i);
 
 		//We finally know the total number of events in the sample
 		if (fIOHandler->IsFastStart() && fNEvents < processEvents)
@@ -324,8 +535,26 @@ bool BaseAnalysis::Process(Long64_t beginEvent, Long64_t maxEvent) {
 	printCurrentEvent(processEvents - 1, processEvents, defaultPrecision,
 			displayType, processLoopTime);
 	std::cout << std::endl;
+	if (fSamplingFraction > 0)
+		std::cout << normal() << "Sampling: " << nSampledClusters << " of "
+				<< nSampledClusters + nSkippedClusters << " clusters processed ("
+				<< processedEvents << " events)" << std::endl;
+	if (multiPass) {
+		processedEvents += ProcessNextPasses(i_offset, defaultPrecision,
+				processTime);
+		GetIOTree()->StopEventCache();
+	} else if (EndOfPass())
+		std::cout << normal()
+				<< "Another pass is requested but the events are not cached: single pass"
+				<< std::endl;
+	fLatency.EndBurst();
+	AllocationCounter::Stop();
+	trace->Begin("WriterStop", "Output");
+	OutputWriter::GetInstance()->Stop();
+	trace->End("WriterStop", "Output");
 
 	//Ask the analyzer to export and draw the plots
+	trace->Begin("EndOfRun", "Run");
 	for (unsigned int j = 0; j < fAnalyzerList.size(); j++) {
 		gFile->cd(fAnalyzerList[j]->GetAnalyzerName());
 		fAnalyzerList[j]->EndOfBurst();
@@ -337,16 +566,30 @@ bool BaseAnalysis::Process(Long64_t beginEvent, Long64_t maxEvent) {
 				fAnalyzerList[j]->DrawPlot();
 			fGraphicalMutex.UnLock();
 		}
+		trace->Begin(fAnalyzerList[j]->GetAnalyzerName(), "Output");
 		fAnalyzerList[j]->WriteTrees();
+		trace->End(fAnalyzerList[j]->GetAnalyzerName(), "Output");
 		gFile->cd();
 	}
-	if (IsTreeType())
+	if (IsTreeType()) {
 		static_cast<IOTree*>(fIOHandler)->WriteTree();
+		GetIOTree()->CloseColumnOutput();
+		GetIOTree()->WriteBranchUsage();
+		fEventTags.CloseOutput();
+	}
+	WriteTimingSummary(processedEvents);
+	OutputTreeSettings::GetInstance()->Collect();
 	fIOHandler->Finalise();
 	fCounterHandler.WriteEventFraction(fIOHandler->GetOutputFileName());
+	//The run is complete: a later --resume must not restart from the checkpoint
+	TString checkpointName = GetCheckpointFileName();
+	if (!gSystem->AccessPathName(checkpointName)
+			&& gSystem->Unlink(checkpointName) != 0)
+		std::cout << normal() << "Unable to remove the checkpoint file "
+				<< checkpointName << std::endl;
+	trace->End("EndOfRun", "Run");
 
 	//Complete the analysis
-	using NA62Analysis::operator -;
 	float totalTime = fInitTime.GetTime() - fInitTime.GetStartTime();
 	std::cout << std::setprecision(2);
 	std::cout << std::endl << "###################################"
@@ -362,12 +605,155 @@ bool BaseAnalysis::Process(Long64_t beginEvent, Long64_t maxEvent) {
 	std::cout << "IO time: " << std::setw(20)
 			<< fIOHandler->GetIoTimeCount().GetTotalTime() << " seconds"
 			<< std::endl;
+	fIOHandler->PrintIOSummary();
+	PrintTimingSummary(processedEvents, processLoopTime.GetTotalTime());
+	fLatency.Print();
+	OutputWriter::GetInstance()->PrintSummary();
+	OutputTreeSettings::GetInstance()->Print();
+	if (fCountAllocations)
+		PrintAllocationSummary(processedEvents);
+	if (fLatencyFile.Length() > 0)
+		fLatency.WriteJSON(fLatencyFile);
 	std::cout << std::endl << "Analysis complete" << std::endl
 			<< "###################################" << std::endl;
 
 	return true;
 }
 
+bool BaseAnalysis::ProcessEvent(Long64_t iEvent) {
+	/// \MemberDescr
+	/// \param iEvent : Index of the loaded event
+	/// \return True if one of the analyzers requested to export the event
+	///
+	/// Process and post-process the loaded event in each analyzer in turn. The friend trees
+	/// are only filled during the first pass. When profiling the branch usage, the branches
+	/// retrieved are attributed to the analyzer being processed.
+	/// \EndMemberDescr
+
+	TraceRecorder *trace = TraceRecorder::GetInstance();
+	BranchUsageProfile *branchUsage = IsTreeType() ? GetIOTree()->GetBranchUsage() : nullptr;
+	bool exportEvent = false;
+
+	if (branchUsage)
+		branchUsage->NewEvent();
+	fEventTags.Reset();
+	PreProcess();
+	//Process event in Analyzer
+	for (unsigned int j = 0; j < fAnalyzerList.size(); j++) {
+		//Get MCSimple
+		AllocationCounter::SetSlot(kAllocAnalyzers + j);
+		gFile->cd(fAnalyzerList[j]->GetAnalyzerName());
+		if (IsTreeType() && static_cast<IOTree*>(fIOHandler)->GetWithMC())
+			fAnalyzerList[j]->FillMCSimple(
+					static_cast<IOTree*>(fIOHandler)->GetMCTruthEvent());
+
+		if (branchUsage)
+			branchUsage->SetCurrentAnalyzer(j);
+		trace->Begin(fAnalyzerList[j]->GetAnalyzerName(), "Process", iEvent);
+		fAnalyzerList[j]->GetTimeCounter(Analyzer::kTimeProcess).Start();
+		fAnalyzerList[j]->Process(iEvent);
+		fAnalyzerList[j]->GetTimeCounter(Analyzer::kTimeProcess).Stop();
+		trace->End(fAnalyzerList[j]->GetAnalyzerName(), "Process");
+		if (fGraphicalMutex.Lock() == 0) {
+			fAnalyzerList[j]->GetTimeCounter(Analyzer::kTimeUpdatePlots).Start();
+			fAnalyzerList[j]->UpdatePlots(iEvent);
+			fAnalyzerList[j]->GetTimeCounter(Analyzer::kTimeUpdatePlots).Stop();
+			fGraphicalMutex.UnLock();
+		}
+		if (fPass == 0)
+			fAnalyzerList[j]->FillFriendTrees();
+		exportEvent = exportEvent || fAnalyzerList[j]->GetExportEvent();
+		if (branchUsage)
+			branchUsage->SetCurrentAnalyzer(-1);
+		gFile->cd();
+	}
+
+	for (unsigned int j = 0; j < fAnalyzerList.size(); j++) {
+		AllocationCounter::SetSlot(kAllocAnalyzers + j);
+		gFile->cd(fAnalyzerList[j]->GetAnalyzerName());
+		if (branchUsage)
+			branchUsage->SetCurrentAnalyzer(j);
+		trace->Begin(fAnalyzerList[j]->GetAnalyzerName(), "PostProcess", iEvent);
+		fAnalyzerList[j]->GetTimeCounter(Analyzer::kTimePostProcess).Start();
+		fAnalyzerList[j]->PostProcess();
+		fAnalyzerList[j]->GetTimeCounter(Analyzer::kTimePostProcess).Stop();
+		trace->End(fAnalyzerList[j]->GetAnalyzerName(), "PostProcess");
+		if (branchUsage)
+			branchUsage->SetCurrentAnalyzer(-1);
+		gFile->cd();
+	}
+	return exportEvent;
+}
+
+Long64_t BaseAnalysis::ProcessNextPasses(int i_offset, int defaultPrecision,
+		TimeCounter &processTime) {
+	/// \MemberDescr
+	/// \param i_offset : Number of events between two progress prints
+	/// \param defaultPrecision : default floating point number precision in cout
+	/// \param processTime : Time counter of the processing, incremented
+	/// \return Number of events processed
+	///
+	/// End the current pass in each analyzer and process again the cached events as long
+	/// as one of the analyzers requests another pass. Nothing is exported during these passes.
+	/// \EndMemberDescr
+
+	TraceRecorder *trace = TraceRecorder::GetInstance();
+	IOTree *ioTree = GetIOTree();
+	Long64_t nCached = ioTree->GetNCachedEvents();
+	Long64_t processedEvents = 0;
+
+	while (true) {
+		if (!EndOfPass())
+			break;
+
+		++fPass;
+		std::cout << normal() << "Pass " << fPass << ": treating " << nCached
+				<< " cached events" << std::endl;
+		TimeCounter passTime;
+		passTime.Start();
+		for (Long64_t i = 0; i < nCached; i++) {
+			if (i % i_offset == 0)
+				printCurrentEvent(i, nCached, defaultPrecision, "Event",
+						passTime);
+
+			trace->Begin("LoadCachedEvent", "IO", i);
+			Long64_t iEvent = ioTree->LoadCachedEvent(i);
+			trace->End("LoadCachedEvent", "IO");
+			if (iEvent < 0) {
+				std::cout << normal() << "Unable to read cached event " << i
+						<< std::endl;
+				continue;
+			}
+
+			processTime.Start();
+			++processedEvents;
+			ProcessEvent(iEvent);
+			processTime.Stop();
+		}
+		printCurrentEvent(nCached - 1, nCached, defaultPrecision, "Event",
+				passTime);
+		std::cout << std::endl;
+	}
+	return processedEvents;
+}
+
+bool BaseAnalysis::EndOfPass() {
+	/// \MemberDescr
+	/// \return True if one of the analyzers requested another pass
+	///
+	/// End the current pass in each analyzer. Called after the first pass even when the
+	/// events are not cached for the next passes.
+	/// \EndMemberDescr
+
+	bool anotherPass = false;
+	for (unsigned int j = 0; j < fAnalyzerList.size(); j++) {
+		gFile->cd(fAnalyzerList[j]->GetAnalyzerName());
+		anotherPass = fAnalyzerList[j]->EndOfPass() || anotherPass;
+		gFile->cd();
+	}
+	return anotherPass;
+}
+
 DetectorAcceptance* BaseAnalysis::GetDetectorAcceptanceInstance() {
 	/// \MemberDescr
 	/// Return a pointer to the unique global instance of DetectorAcceptance.\n
@@ -427,6 +813,91 @@ void BaseAnalysis::PrintInitSummary() const {
 			<< std::endl;
 }
 
+void BaseAnalysis::PrintAllocationSummary(Long64_t nEvents) const {
+	/// \MemberDescr
+	/// \param nEvents : Number of processed events
+	///
+	/// Print the heap allocations made during the event loop, attributed to
+	/// the framework (reading and writing events) and to each analyzer.
+	/// \EndMemberDescr
+
+	std::vector<TString> slotNames;
+	slotNames.push_back("Framework (LoadEvent)");
+	slotNames.push_back("Framework (WriteEvent)");
+	for (unsigned int j = 0; j < fAnalyzerList.size(); j++)
+		slotNames.push_back(fAnalyzerList[j]->GetAnalyzerName());
+	std::cout << std::endl;
+	AllocationCounter::Print(slotNames, nEvents);
+}
+
+void BaseAnalysis::PrintTimingSummary(Long64_t nEvents,
+		float loopTime) const {
+	/// \MemberDescr
+	/// \param nEvents : Number of processed events
+	/// \param loopTime : Total time of the process loop
+	///
+	/// Print the time spent by each analyzer in each processing phase: total,
+	/// mean per processed event and share of the process loop time.
+	/// \EndMemberDescr
+
+	if (!TestLevel(Verbosity::kStandard))
+		return;
+
+	StringTable timingTable("Analyzers timing");
+
+	timingTable.AddColumn("analyzer", "Analyzer");
+	timingTable.AddColumn("phase", "Phase");
+	timingTable.AddColumn("total", "Total (s)");
+	timingTable.AddColumn("mean", "Mean/event (ms)");
+	timingTable.AddColumn("share", "Share (%)");
+	timingTable << sepr;
+	for (auto it : fAnalyzerList) {
+		for (int phase = 0; phase < Analyzer::kTimeNPhases; ++phase) {
+			float total = it->GetTimeCounter((Analyzer::TimingPhase) phase).GetTotalTime();
+			timingTable << it->GetAnalyzerName()
+					<< Analyzer::GetTimingPhaseName((Analyzer::TimingPhase) phase)
+					<< TString::Format("%.3f", total)
+					<< TString::Format("%.4f", nEvents > 0 ? 1000. * total / nEvents : 0.)
+					<< TString::Format("%.2f", loopTime > 0 ? 100. * total / loopTime : 0.);
+		}
+		timingTable << sepr;
+	}
+
+	std::cout << std::endl;
+	timingTable.Print("");
+}
+
+void BaseAnalysis::WriteTimingSummary(Long64_t nEvents) const {
+	/// \MemberDescr
+	/// \param nEvents : Number of processed events
+	///
+	/// Write the time spent by each analyzer in each processing phase in the
+	/// Timing directory of the output file. The histogram contains the total time
+	/// in seconds, its number of entries is the number of processed events.
+	/// The event processing time distribution and the burst rates are written in
+	/// the same directory.
+	/// \EndMemberDescr
+
+	fIOHandler->MkOutputDir("Timing");
+	gFile->cd("Timing");
+	TH2D timing("AnalyzersTime", "Time spent in analyzers (s)",
+			fAnalyzerList.size(), 0, fAnalyzerList.size(), Analyzer::kTimeNPhases,
+			0, Analyzer::kTimeNPhases);
+	for (int phase = 0; phase < Analyzer::kTimeNPhases; ++phase)
+		timing.GetYaxis()->SetBinLabel(phase + 1,
+				Analyzer::GetTimingPhaseName((Analyzer::TimingPhase) phase));
+	for (unsigned int i = 0; i < fAnalyzerList.size(); ++i) {
+		timing.GetXaxis()->SetBinLabel(i + 1, fAnalyzerList[i]->GetAnalyzerName());
+		for (int phase = 0; phase < Analyzer::kTimeNPhases; ++phase)
+			timing.SetBinContent(i + 1, phase + 1,
+					fAnalyzerList[i]->GetTimeCounter((Analyzer::TimingPhase) phase).GetTotalTime());
+	}
+	timing.SetEntries(nEvents);
+	timing.Write();
+	fLatency.Write();
+	gFile->cd();
+}
+
 void BaseAnalysis::CheckNewFileOpened() {
 	/// \MemberDescr
 	/// Method called by TChain when opening a new file.\n
@@ -437,22 +908,29 @@ void BaseAnalysis::CheckNewFileOpened() {
 		return;
 	//New file opened
 	std::cout << debug() << "New file opened" << std::endl;
+	TraceRecorder *trace = TraceRecorder::GetInstance();
+	fLatency.NewBurst(fIOHandler->GetCurrentFileNumber());
 	//first burst or not? Call end of burst only if it's not
 	if (fIOHandler->GetCurrentFileNumber() > 0) {
 		//end of burst
+		++fBurstsSinceCheckpoint;
+		trace->Begin("EndOfBurst", "Burst");
 		for (unsigned int i = 0; i < fAnalyzerList.size(); i++) {
 			fAnalyzerList[i]->EndOfBurst();
 		}
 		if (IsHistoType())
 			GetIOHisto()->UpdateInputHistograms();
+		trace->End("EndOfBurst", "Burst");
 	}
 
+	trace->Begin("StartOfBurst", "Burst");
 	for (unsigned int i = 0; i < fAnalyzerList.size(); i++) {
 		// Update number of events
 		if (fIOHandler->IsFastStart())
 			fNEvents = fIOHandler->GetNEvents();
 		fAnalyzerList[i]->StartOfBurst();
 	}
+	trace->End("StartOfBurst", "Burst");
 }
 
 IOHandler* BaseAnalysis::GetIOHandler() {
@@ -513,6 +991,17 @@ IOHisto* BaseAnalysis::GetIOHisto() {
 		return nullptr;
 }
 
+IOColumns* BaseAnalysis::GetIOColumns() {
+	/// \MemberDescr
+	/// \return Pointer to IOColumns if IOHandler reads column files
+	/// \EndMemberDescr
+
+	if (IsColumnType())
+		return static_cast<IOColumns*>(fIOHandler);
+	else
+		return nullptr;
+}
+
 void BaseAnalysis::SetReadType(IOHandlerType type) {
 	/// \MemberDescr
 	/// \param type: Type of IOHandler to use
@@ -521,10 +1010,13 @@ void BaseAnalysis::SetReadType(IOHandlerType type) {
 	/// \EndMemberDescr
 
 	std::cout << normal() << "Creating IOHandler of type "
-			<< (type == IOHandlerType::kHISTO ? "kHisto" : "kTree")
+			<< (type == IOHandlerType::kHISTO ? "kHisto" :
+				type == IOHandlerType::kCOLUMNS ? "kColumns" : "kTree")
 			<< std::endl;
 	if (type == IOHandlerType::kHISTO)
 		fIOHandler = new IOHisto();
+	else if (type == IOHandlerType::kCOLUMNS)
+		fIOHandler = new IOColumns();
 	else
 		fIOHandler = new IOTree();
 
@@ -614,6 +1106,46 @@ void BaseAnalysis::SetDownscaling(bool flagDownscaling) {
 		fEventsDownscaling = 0;
 }
 
+void BaseAnalysis::SetSampling(double fraction) {
+	/// \MemberDescr
+	/// \param fraction : Fraction of the events to process (0 disables the sampling)
+	///
+	/// Process a uniform sample of the events of all the input files: each cluster of the
+	/// input trees (group of entries stored in the same baskets) is processed entirely with
+	/// this probability or skipped without being read. The selection depends only on the
+	/// position of the cluster and on the SamplingSeed setting.
+	/// \EndMemberDescr
+
+	if (!IsTreeType()) {
+		std::cout << normal() << "Sampling is only available when reading TTrees" << std::endl;
+		return;
+	}
+	if (fraction < 0 || fraction > 1) {
+		std::cout << normal() << "Invalid sampling fraction " << fraction
+				<< ": expected a value between 0 and 1" << std::endl;
+		return;
+	}
+	fSamplingFraction = fraction < 1 ? fraction : 0;
+}
+
+bool BaseAnalysis::IsClusterSampled(Long64_t clusterEnd) const {
+	/// \MemberDescr
+	/// \param clusterEnd : Index of the first event after the cluster
+	/// \return True if the cluster is in the sample
+	///
+	/// Draw a uniform number from the position of the cluster and the seed (splitmix64) and
+	/// compare it to the sampling fraction
+	/// \EndMemberDescr
+
+	ULong64_t x = (ULong64_t) clusterEnd
+			+ 0x9E3779B97F4A7C15ULL
+					* (ULong64_t) (Configuration::ConfigSettings::global::fSamplingSeed + 1);
+	x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+	x = x ^ (x >> 31);
+	return (x >> 11) / 9007199254740992. < fSamplingFraction;
+}
+
 void BaseAnalysis::StartContinuous(TString inFileList) {
 	/// \MemberDescr
 	/// \param inFileList: Path to a text file containing a list of input root files
@@ -683,6 +1215,7 @@ void BaseAnalysis::ContinuousLoop(void* args) {
 
 	BaseAnalysis* ban = ((ThreadArgs_t*) args)->ban;
 	TString inFileList = ((ThreadArgs_t*) args)->inFileList;
+	TraceRecorder::GetInstance()->SetThreadName("ContinuousLoop");
 	while (!ban->fSignalStop) {
 		ban->GetIOHandler()->OpenInput(inFileList, -1);
 		ban->GetIOHandler()->SetOutputFileAsCurrent();
@@ -725,6 +1258,230 @@ void BaseAnalysis::SetPrimitiveFile(TString fileName) {
 		fIOPrimitive->SetFile(fileName);
 }
 
+void BaseAnalysis::SetTraceFile(TString fileName) {
+	/// \MemberDescr
+	/// \param fileName : Path to the trace file
+	///
+	/// Record the timeline of the processing (file opening, event loading, analyzers,
+	/// bursts, output writing) in the Chrome trace-event format.
+	/// \EndMemberDescr
+	TraceRecorder::GetInstance()->Open(fileName);
+}
+
+void BaseAnalysis::SetEntryListInput(bool bVal) {
+	/// \MemberDescr
+	/// \param bVal : true/false
+	///
+	/// If enabled, the input file is an entry list written with SetEntryListExport and only
+	/// the listed events are read.
+	/// \EndMemberDescr
+	fIOHandler->SetEntryListInput(bVal);
+}
+
+void BaseAnalysis::SetEntryListExport(bool bVal) {
+	/// \MemberDescr
+	/// \param bVal : true/false
+	///
+	/// If enabled, the events exported by the analyzers are written as an entry list
+	/// (input file, entry) instead of being copied in the output trees.
+	/// \EndMemberDescr
+	if (IsTreeType())
+		GetIOTree()->SetEntryListExport(bVal);
+	else
+		std::cout << normal() << "Entry list export is only available when reading TTrees" << std::endl;
+}
+
+void BaseAnalysis::SetStreaming(bool bVal) {
+	/// \MemberDescr
+	/// \param bVal : true/false
+	///
+	/// If enabled, the input files are read one at a time (the next one being opened in
+	/// advance) instead of being all registered in the TChains. Implies --fast-start.
+	/// \EndMemberDescr
+	if (IsTreeType())
+		GetIOTree()->SetStreaming(bVal);
+	else
+		std::cout << normal() << "Streaming reader is only available when reading TTrees" << std::endl;
+}
+
+void BaseAnalysis::SetColumnOutput(TString fileName, TString fieldList) {
+	/// \MemberDescr
+	/// \param fileName : Path of the column file to write
+	/// \param fieldList : Comma separated list of data members to write (Tree:Branch.member)
+	///
+	/// Write the listed data members and the projections requested by the analyzers for each
+	/// processed event in a column file, which can be read instead of the TTrees with --columns
+	/// \EndMemberDescr
+	if (IsTreeType())
+		GetIOTree()->SetColumnOutput(fileName, fieldList);
+	else
+		std::cout << normal() << "Column files can only be written when reading TTrees" << std::endl;
+}
+
+void BaseAnalysis::SetBranchProfileOutput(TString fileName) {
+	/// \MemberDescr
+	/// \param fileName : Path of the branch usage profile to write
+	///
+	/// Record which requested branches are retrieved by each analyzer and write the
+	/// profile in this file at the end of the processing
+	/// \EndMemberDescr
+	if (IsTreeType())
+		GetIOTree()->SetBranchProfileOutput(fileName);
+	else
+		std::cout << normal() << "Branch usage profiling is only available when reading TTrees" << std::endl;
+}
+
+bool BaseAnalysis::UseBranchProfile(TString fileName) {
+	/// \MemberDescr
+	/// \param fileName : Path of a branch usage profile written with --profile-branches
+	/// \return False if the profile cannot be read
+	///
+	/// Do not read the requested branches that are never used according to the profile and
+	/// train the TTreeCache with the used ones. Must be called before Init.
+	/// \EndMemberDescr
+	if (IsTreeType())
+		return GetIOTree()->UseBranchProfile(fileName);
+	std::cout << normal() << "Branch usage profiles are only available when reading TTrees" << std::endl;
+	return true;
+}
+
+void BaseAnalysis::WriteEventStreams() {
+	/// \MemberDescr
+	/// Write the current event in each named stream requested by at least one analyzer
+	/// \EndMemberDescr
+
+	std::vector<TString> streams;
+	for (unsigned int j = 0; j < fAnalyzerList.size(); j++) {
+		for (auto stream : fAnalyzerList[j]->GetExportStreams()) {
+			if (std::find(streams.begin(), streams.end(), stream) == streams.end())
+				streams.push_back(stream);
+		}
+	}
+	for (auto stream : streams)
+		GetIOTree()->WriteEvent(stream);
+}
+
+TString BaseAnalysis::GetCheckpointFileName() const {
+	/// \MemberDescr
+	/// \return Path of the checkpoint file
+	/// \EndMemberDescr
+	return fIOHandler->GetOutputFileName() + ".checkpoint.root";
+}
+
+void BaseAnalysis::WriteCheckpoint(Long64_t lastEntry) {
+	/// \MemberDescr
+	/// \param lastEntry : Index of the last processed entry
+	///
+	/// Write the current histograms, counters, the last processed entry and the list of
+	/// input files in a temporary file, then rename it to the checkpoint file. The rename is atomic: a crash during
+	/// the writing leaves the previous checkpoint untouched.
+	/// \EndMemberDescr
+
+	TString fileName = GetCheckpointFileName();
+	TString tmpName = fileName + ".tmp";
+	TDirectory *currentDir = gDirectory;
+
+	TraceRecorder::GetInstance()->Begin("Checkpoint", "Output");
+	//The output file must not be modified by the background writer while it is read
+	OutputWriter::GetInstance()->Sync();
+	TFile *fd = TFile::Open(tmpName, "RECREATE");
+	if (!fd || fd->IsZombie()) {
+		std::cout << normal() << "Unable to write the checkpoint file " << tmpName
+				<< std::endl;
+		if (fd)
+			delete fd;
+	} else {
+		fIOHandler->WriteSnapshot(fd);
+		TDirectory *checkpointDir = fd->mkdir("Checkpoint");
+		fCounterHandler.WriteCounters(checkpointDir);
+		TParameter<Long64_t> last("LastEntry", lastEntry);
+		checkpointDir->WriteTObject(&last);
+		TObjString inputFiles(fIOHandler->GetInputFileList());
+		checkpointDir->WriteTObject(&inputFiles, "InputFiles");
+		fd->Close();
+		delete fd;
+		if (rename(tmpName.Data(), fileName.Data()) != 0)
+			std::cout << normal() << "Unable to rename " << tmpName << " to "
+					<< fileName << std::endl;
+		else
+			std::cout << debug() << "Checkpoint written after entry "
+					<< lastEntry << std::endl;
+	}
+	TraceRecorder::GetInstance()->End("Checkpoint", "Output");
+	currentDir->cd();
+	fBurstsSinceCheckpoint = 0;
+}
+
+Long64_t BaseAnalysis::ReadCheckpoint() {
+	/// \MemberDescr
+	/// \return Index of the last entry processed before the checkpoint, -1 if no
+	/// checkpoint could be read
+	///
+	/// Restore the histograms and counters from the checkpoint file. The other state of
+	/// the analyzers and the events exported before the checkpoint are not restored.
+	/// The checkpoint is rejected if it was written with different input files (the
+	/// entries would not be the same). It is removed at the end of a complete run.
+	/// \EndMemberDescr
+
+	TString fileName = GetCheckpointFileName();
+	if (gSystem->AccessPathName(fileName)) {
+		std::cout << normal() << "No checkpoint file " << fileName
+				<< ". Starting from the beginning." << std::endl;
+		return -1;
+	}
+
+	TDirectory *currentDir = gDirectory;
+	TFile *fd = TFile::Open(fileName, "READ");
+	TParameter<Long64_t> *last =
+			fd ? (TParameter<Long64_t>*) fd->Get("Checkpoint/LastEntry") : nullptr;
+	if (!last) {
+		std::cout << normal() << "Invalid checkpoint file " << fileName
+				<< ". Starting from the beginning." << std::endl;
+		if (fd)
+			delete fd;
+		currentDir->cd();
+		return -1;
+	}
+	Long64_t lastEntry = last->GetVal();
+	delete last;
+
+	TObjString *inputFiles = (TObjString*) fd->Get("Checkpoint/InputFiles");
+	bool sameInput = inputFiles
+			&& inputFiles->GetString().CompareTo(fIOHandler->GetInputFileList()) == 0;
+	delete inputFiles;
+	if (!sameInput) {
+		std::cout << normal() << "Checkpoint file " << fileName
+				<< " was written with different input files. Starting from the beginning."
+				<< std::endl;
+		delete fd;
+		currentDir->cd();
+		return -1;
+	}
+
+	fIOHandler->RestoreSnapshot(fd);
+	fCounterHandler.ReadCounters(fd->GetDirectory("Checkpoint"));
+	fd->Close();
+	delete fd;
+	currentDir->cd();
+
+	std::cout << normal() << "Resuming from checkpoint " << fileName
+			<< " after entry " << lastEntry << std::endl;
+	return lastEntry;
+}
+
+void BaseAnalysis::AddFriendFile(TString fileName) {
+	/// \MemberDescr
+	/// \param fileName : Path to a ROOT file containing friend trees
+	///
+	/// The trees of this file (written with Analyzer::OpenFriendTree on the same input
+	/// files) are read alongside the input trees, entry by entry.
+	/// \EndMemberDescr
+	if (IsTreeType())
+		GetIOTree()->AddFriendFile(fileName);
+	else
+		std::cout << normal() << "Friend trees are only available when reading TTrees" << std::endl;
+}
+
 void BaseAnalysis::InitPrimitives() {
 	/// \MemberDescr
 	/// Instantiate the IOPrimitive instance if not yet done.
@@ -0,0 +1,176 @@
+/*
+ * BranchUsageProfile.cc
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ncl
+ */
+
+#include "BranchUsageProfile.hh"
+
+#include <iostream>
+#include <fstream>
+
+#include <TObjArray.h>
+#include <TObjString.h>
+
+namespace NA62Analysis {
+namespace Core {
+
+BranchUsageProfile::BranchUsageProfile() :
+	fNEvents(0),
+	fCurrentAnalyzer(0)
+{
+	/// \MemberDescr
+	/// Default constructor
+	/// \EndMemberDescr
+
+	fAnalyzers.push_back("Framework");
+}
+
+BranchUsageProfile::~BranchUsageProfile() {
+	/// \MemberDescr
+	/// Destructor
+	/// \EndMemberDescr
+}
+
+void BranchUsageProfile::SetAnalyzers(const std::vector<TString> &names) {
+	/// \MemberDescr
+	/// \param names : Names of the analyzers, in the order of their index
+	///
+	/// Set the analyzers to which the accesses are attributed. The accesses recorded so far
+	/// are kept for the framework.
+	/// \EndMemberDescr
+
+	fAnalyzers.resize(1);
+	fAnalyzers.insert(fAnalyzers.end(), names.begin(), names.end());
+	Usage empty = {0, -1};
+	for(auto &branch : fUsage) branch.resize(fAnalyzers.size(), empty);
+	fCurrentAnalyzer = 0;
+}
+
+int BranchUsageProfile::AddBranch(TString treeName, TString branchName) {
+	/// \MemberDescr
+	/// \param treeName : Name of the tree
+	/// \param branchName : Name of the branch
+	/// \return Index of the branch to use with Accessed
+	/// \EndMemberDescr
+
+	TString name = treeName + ":" + branchName;
+	for(unsigned int i=0; i<fBranches.size(); ++i){
+		if(fBranches[i].CompareTo(name)==0) return i;
+	}
+	Usage empty = {0, -1};
+	fBranches.push_back(name);
+	fUsage.push_back(std::vector<Usage>(fAnalyzers.size(), empty));
+	return fBranches.size()-1;
+}
+
+void BranchUsageProfile::Accessed(int branch) {
+	/// \MemberDescr
+	/// \param branch : Index of the branch (see AddBranch)
+	///
+	/// Record that the current analyzer retrieved the branch in the current event
+	/// \EndMemberDescr
+
+	if(branch<0 || branch>=(int)fUsage.size()) return;
+	Usage &usage = fUsage[branch][fCurrentAnalyzer];
+	if(usage.fLastEvent==fNEvents) return;
+	usage.fLastEvent = fNEvents;
+	++usage.fEvents;
+}
+
+bool BranchUsageProfile::Save(TString fileName) const {
+	/// \MemberDescr
+	/// \param fileName : Path to the profile file
+	/// \return False if the profile cannot be written
+	/// \EndMemberDescr
+
+	std::ofstream fd(fileName.Data());
+	if(!fd.is_open()){
+		std::cout << "Unable to write the branch usage profile " << fileName << std::endl;
+		return false;
+	}
+	fd << "Events\t" << fNEvents << std::endl;
+	fd << "Analyzers";
+	for(auto name : fAnalyzers) fd << "\t" << name;
+	fd << std::endl;
+	for(unsigned int i=0; i<fBranches.size(); ++i){
+		fd << fBranches[i];
+		for(auto usage : fUsage[i]) fd << "\t" << usage.fEvents;
+		fd << std::endl;
+	}
+	fd.close();
+	std::cout << "Branch usage profile written in " << fileName << std::endl;
+	return true;
+}
+
+void BranchUsageProfile::Print() const {
+	/// \MemberDescr
+	/// Print the number of events in which each analyzer retrieved each branch
+	/// \EndMemberDescr
+
+	std::cout << "Branch usage over " << fNEvents << " events:" << std::endl;
+	for(unsigned int i=0; i<fBranches.size(); ++i){
+		std::cout << "\t" << fBranches[i] << ":";
+		bool used = false;
+		for(unsigned int j=0; j<fAnalyzers.size(); ++j){
+			if(fUsage[i][j].fEvents==0) continue;
+			std::cout << " " << fAnalyzers[j] << "(" << fUsage[i][j].fEvents << ")";
+			used = true;
+		}
+		if(!used) std::cout << " never used";
+		std::cout << std::endl;
+	}
+}
+
+bool BranchUsageProfile::Load(TString fileName) {
+	/// \MemberDescr
+	/// \param fileName : Path to the profile file
+	/// \return False if the profile cannot be read
+	///
+	/// Read a profile written by Save. A branch is used if at least one analyzer (or the
+	/// framework) retrieved it.
+	/// \EndMemberDescr
+
+	std::ifstream fd(fileName.Data());
+	if(!fd.is_open()){
+		std::cout << "Unable to read the branch usage profile " << fileName << std::endl;
+		return false;
+	}
+
+	fUsed.clear();
+	TString line;
+	int nUnused = 0;
+	while(line.ReadLine(fd)){
+		TObjArray *fields = line.Tokenize("\t");
+		TString name = fields->GetEntries()>0 ? ((TObjString*)fields->At(0))->GetString() : "";
+		if(name.Contains(":")){
+			bool used = false;
+			for(int i=1; i<fields->GetEntries(); ++i){
+				if(((TObjString*)fields->At(i))->GetString().Atoll()>0) used = true;
+			}
+			fUsed[name] = used;
+			if(!used) ++nUnused;
+		}
+		delete fields;
+	}
+	fd.close();
+	std::cout << "Branch usage profile " << fileName << ": " << fUsed.size()
+			<< " branches, " << nUnused << " never used" << std::endl;
+	return true;
+}
+
+bool BranchUsageProfile::IsUsed(TString treeName, TString branchName) const {
+	/// \MemberDescr
+	/// \param treeName : Name of the tree
+	/// \param branchName : Name of the branch
+	/// \return False if the loaded profile shows the branch was never used
+	/// \EndMemberDescr
+
+	auto it = fUsed.find(treeName + ":" + branchName);
+	if(it==fUsed.end()) return true;
+	return it->second;
+}
+
+} /* namespace Core */
+} /* namespace NA62Analysis */
@@ -0,0 +1,156 @@
+/*
+ * ColumnReader.cc
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ncl
+ */
+
+#include "ColumnReader.hh"
+
+#include <iostream>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace NA62Analysis {
+namespace Core {
+
+ColumnReader::ColumnReader() :
+	fData(nullptr),
+	fSize(0),
+	fHeader(nullptr),
+	fFields(nullptr)
+{
+	/// \MemberDescr
+	/// Default constructor
+	/// \EndMemberDescr
+}
+
+ColumnReader::~ColumnReader() {
+	/// \MemberDescr
+	/// Destructor. Unmap the file.
+	/// \EndMemberDescr
+
+	Close();
+}
+
+bool ColumnReader::Open(TString fileName) {
+	/// \MemberDescr
+	/// \param fileName : Path to the column file
+	/// \return False if the file cannot be mapped or is not a valid column file
+	/// \EndMemberDescr
+
+	Close();
+	fFileName = fileName;
+
+	int fd = open(fileName.Data(), O_RDONLY);
+	if(fd<0){
+		std::cout << "Unable to open the column file " << fileName << std::endl;
+		return false;
+	}
+	struct stat st;
+	if(fstat(fd, &st)!=0 || (size_t)st.st_size<sizeof(ColumnFileHeader)){
+		std::cout << "Invalid column file " << fileName << std::endl;
+		close(fd);
+		return false;
+	}
+	void *data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(data==MAP_FAILED){
+		std::cout << "Unable to map the column file " << fileName << std::endl;
+		return false;
+	}
+	madvise(data, st.st_size, MADV_SEQUENTIAL);
+
+	fData = static_cast<char*>(data);
+	fSize = st.st_size;
+	fHeader = reinterpret_cast<const ColumnFileHeader*>(fData);
+	fFields = reinterpret_cast<const ColumnFileField*>(fData+sizeof(ColumnFileHeader));
+
+	if(memcmp(fHeader->fMagic, kColumnFileMagic, sizeof(kColumnFileMagic))!=0){
+		std::cout << fileName << " is not a column file" << std::endl;
+		Close();
+		return false;
+	}
+	if(fHeader->fVersion!=kColumnFileVersion){
+		std::cout << "Unsupported version " << fHeader->fVersion << " of the column file " << fileName
+				<< " (expected " << kColumnFileVersion << ")" << std::endl;
+		Close();
+		return false;
+	}
+	if(!CheckLayout()){
+		std::cout << "Corrupted column file " << fileName << std::endl;
+		Close();
+		return false;
+	}
+	return true;
+}
+
+void ColumnReader::Close() {
+	/// \MemberDescr
+	/// Unmap the file
+	/// \EndMemberDescr
+
+	if(fData) munmap(fData, fSize);
+	fData = nullptr;
+	fSize = 0;
+	fHeader = nullptr;
+	fFields = nullptr;
+}
+
+int ColumnReader::GetFieldIndex(TString name) const {
+	/// \MemberDescr
+	/// \param name : Name of the field
+	/// \return Index of the field, -1 if not in the file
+	/// \EndMemberDescr
+
+	for(unsigned int i=0; i<GetNFields(); ++i){
+		if(name.CompareTo(fFields[i].fName)==0) return i;
+	}
+	return -1;
+}
+
+ColumnView ColumnReader::GetValues(unsigned int field, Long64_t iEvent) const {
+	/// \MemberDescr
+	/// \param field : Index of the field
+	/// \param iEvent : Index of the event in the file
+	/// \return View of the values of the field for this event (empty if out of range)
+	/// \EndMemberDescr
+
+	if(field>=GetNFields() || iEvent<0 || iEvent>=GetNEvents()) return ColumnView();
+
+	const ColumnFileField &descriptor = fFields[field];
+	const ULong64_t *offsets = reinterpret_cast<const ULong64_t*>(fData+descriptor.fOffsets);
+	ULong64_t first = offsets[iEvent];
+	ULong64_t last = offsets[iEvent+1];
+	if(last<first || last>descriptor.fNValues) return ColumnView();
+	const double *values = reinterpret_cast<const double*>(fData+descriptor.fValues);
+	return ColumnView(values+first, last-first);
+}
+
+bool ColumnReader::CheckLayout() const {
+	/// \MemberDescr
+	/// \return False if the descriptors or the arrays are outside of the file or misaligned
+	/// \EndMemberDescr
+
+	ULong64_t nFields = fHeader->fNFields;
+	ULong64_t nEvents = fHeader->fNEvents;
+	if(nFields>(fSize-sizeof(ColumnFileHeader))/sizeof(ColumnFileField)) return false;
+	if(nEvents>=fSize/sizeof(ULong64_t)) return false;
+
+	for(ULong64_t i=0; i<nFields; ++i){
+		const ColumnFileField &field = fFields[i];
+		if(memchr(field.fName, 0, sizeof(field.fName))==nullptr) return false;
+		if(field.fOffsets%8!=0 || field.fValues%8!=0) return false;
+		if(field.fOffsets>fSize || (fSize-field.fOffsets)/sizeof(ULong64_t)<nEvents+1) return false;
+		if(field.fValues>fSize || (fSize-field.fValues)/sizeof(double)<field.fNValues) return false;
+		const ULong64_t *offsets = reinterpret_cast<const ULong64_t*>(fData+field.fOffsets);
+		if(offsets[0]!=0 || offsets[nEvents]!=field.fNValues) return false;
+	}
+	return true;
+}
+
+} /* namespace Core */
+} /* namespace NA62Analysis */
@@ -0,0 +1,180 @@
+/*
+ * ColumnWriter.cc
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ncl
+ */
+
+#include "ColumnWriter.hh"
+
+#include <iostream>
+#include <cstring>
+
+namespace NA62Analysis {
+namespace Core {
+
+ColumnWriter::ColumnWriter() :
+	fFailed(false),
+	fNEvents(0)
+{
+	/// \MemberDescr
+	/// Default constructor
+	/// \EndMemberDescr
+}
+
+ColumnWriter::~ColumnWriter() {
+	/// \MemberDescr
+	/// Destructor. The temporary files are deleted, the column file is only written by Close().
+	/// \EndMemberDescr
+
+	CloseTemporaryFiles();
+}
+
+bool ColumnWriter::Open(TString fileName, const std::vector<TString> &fields) {
+	/// \MemberDescr
+	/// \param fileName : Path of the column file
+	/// \param fields : Names of the fields, in the order of the values given to Fill()
+	/// \return False if a field name is too long or if the temporary files cannot be created
+	/// \EndMemberDescr
+
+	CloseTemporaryFiles();
+	fFileName = fileName;
+	fNEvents = 0;
+	fFailed = false;
+
+	for(auto name : fields){
+		if((size_t)name.Length()>=sizeof(ColumnFileField::fName)){
+			std::cout << "Column name too long: " << name << std::endl;
+			CloseTemporaryFiles();
+			return false;
+		}
+		Field field;
+		field.fName = name;
+		field.fNValues = 0;
+		field.fOffsets = tmpfile();
+		field.fValues = tmpfile();
+		fFields.push_back(field);
+		if(!field.fOffsets || !field.fValues){
+			std::cout << "Unable to create the temporary files of the column file " << fileName << std::endl;
+			CloseTemporaryFiles();
+			return false;
+		}
+	}
+	return true;
+}
+
+bool ColumnWriter::Fill(const std::vector<const std::vector<double>*> &values) {
+	/// \MemberDescr
+	/// \param values : Values of each field for the event (nullptr for no value)
+	/// \return False if the values cannot be written
+	/// \EndMemberDescr
+
+	if(fFailed || values.size()!=fFields.size()) return false;
+
+	for(unsigned int i=0; i<fFields.size(); ++i){
+		Field &field = fFields[i];
+		size_t nValues = values[i] ? values[i]->size() : 0;
+		if(nValues>0 && fwrite(values[i]->data(), sizeof(double), nValues, field.fValues)!=nValues)
+			fFailed = true;
+		field.fNValues += nValues;
+		if(fwrite(&field.fNValues, sizeof(ULong64_t), 1, field.fOffsets)!=1)
+			fFailed = true;
+	}
+	if(fFailed){
+		std::cout << "Unable to write the temporary files of the column file " << fFileName << std::endl;
+		return false;
+	}
+	++fNEvents;
+	return true;
+}
+
+bool ColumnWriter::Close() {
+	/// \MemberDescr
+	/// \return False if the column file cannot be written
+	///
+	/// Write the column file from the temporary files and delete them
+	/// \EndMemberDescr
+
+	if(fFields.size()==0) return false;
+	if(fFailed){
+		CloseTemporaryFiles();
+		return false;
+	}
+
+	FILE *fd = fopen(fFileName.Data(), "wb");
+	if(!fd){
+		std::cout << "Unable to create the column file " << fFileName << std::endl;
+		CloseTemporaryFiles();
+		return false;
+	}
+
+	ColumnFileHeader header;
+	memcpy(header.fMagic, kColumnFileMagic, sizeof(header.fMagic));
+	header.fVersion = kColumnFileVersion;
+	header.fNFields = fFields.size();
+	header.fNEvents = fNEvents;
+
+	//Layout: header, descriptors, then offsets and values of each field
+	std::vector<ColumnFileField> descriptors(fFields.size());
+	ULong64_t position = sizeof(ColumnFileHeader) + fFields.size()*sizeof(ColumnFileField);
+	for(unsigned int i=0; i<fFields.size(); ++i){
+		memset(&descriptors[i], 0, sizeof(ColumnFileField));
+		strncpy(descriptors[i].fName, fFields[i].fName.Data(), sizeof(descriptors[i].fName)-1);
+		descriptors[i].fOffsets = position;
+		position += (fNEvents+1)*sizeof(ULong64_t);
+		descriptors[i].fValues = position;
+		descriptors[i].fNValues = fFields[i].fNValues;
+		position += fFields[i].fNValues*sizeof(double);
+	}
+
+	bool ok = fwrite(&header, sizeof(header), 1, fd)==1
+			&& fwrite(descriptors.data(), sizeof(ColumnFileField), descriptors.size(), fd)==descriptors.size();
+	ULong64_t firstOffset = 0;
+	for(unsigned int i=0; ok && i<fFields.size(); ++i){
+		ok = fwrite(&firstOffset, sizeof(ULong64_t), 1, fd)==1
+				&& Copy(fFields[i].fOffsets, fd)
+				&& Copy(fFields[i].fValues, fd);
+	}
+	ok = (fclose(fd)==0) && ok;
+	CloseTemporaryFiles();
+
+	if(!ok){
+		std::cout << "Unable to write the column file " << fFileName << std::endl;
+		remove(fFileName.Data());
+		return false;
+	}
+	std::cout << "Column file " << fFileName << ": " << fNEvents << " events, " << header.fNFields
+			<< " fields, " << position/1048576. << " MB" << std::endl;
+	return true;
+}
+
+bool ColumnWriter::Copy(FILE *source, FILE *target) {
+	/// \MemberDescr
+	/// \param source : File to copy from the beginning
+	/// \param target : File to append to
+	/// \return False if the copy failed
+	/// \EndMemberDescr
+
+	std::vector<char> buffer(1048576);
+	size_t n;
+	if(fflush(source)!=0 || fseek(source, 0, SEEK_SET)!=0) return false;
+	while((n = fread(buffer.data(), 1, buffer.size(), source))>0){
+		if(fwrite(buffer.data(), 1, n, target)!=n) return false;
+	}
+	return ferror(source)==0;
+}
+
+void ColumnWriter::CloseTemporaryFiles() {
+	/// \MemberDescr
+	/// Close (and thereby delete) the temporary files
+	/// \EndMemberDescr
+
+	for(auto &field : fFields){
+		if(field.fOffsets) fclose(field.fOffsets);
+		if(field.fValues) fclose(field.fValues);
+	}
+	fFields.clear();
+}
+
+} /* namespace Core */
+} /* namespace NA62Analysis */
@@ -33,13 +33,14 @@ ConfigAnalyzer::~ConfigAnalyzer() {
 	/// \EndMemberDescr
 }
 
-void ConfigAnalyzer::ApplyParams(Analyzer * const analyzer) const{
+void ConfigAnalyzer::ApplyParams(Analyzer * const analyzer, TString name) const{
 	/// \MemberDescr
 	/// \param analyzer : pointer to the analyzer
+	/// \param name : Name of the analyzer in the configuration (name of the analyzer if empty)
 	///
 	/// Apply all the ParamName,ParamValue pairs to the specified analyzer
 	/// \EndMemberDescr
-	TString name = analyzer->GetAnalyzerName();
+	if(name.Length()==0) name = analyzer->GetAnalyzerName();
 	if(NamespaceExists(name)){
 		for(auto param : GetNamespace(name).GetParams()){
 			analyzer->ApplyParam(param.first, param.second);
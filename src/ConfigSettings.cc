@@ -40,6 +40,32 @@ void ConfigSettings::ParseFile(TString fileName) {
 		ns.SetValue("skippedname", global::fSkippedName);
 		ns.SetValue("svcclass", global::fSvcClass);
 		ns.SetValue("eventsdownscaling", global::fEventsDownscaling);
+		ns.SetValue("skimbranches", global::fSkimBranches);
+		ns.SetValue("fastskim", global::fFastSkim);
+		ns.SetValue("writerqueuesize", global::fWriterQueueSize);
+		ns.SetValue("rollsize", global::fRollSize);
+		ns.SetValue("rollbursts", global::fRollBursts);
+		ns.SetValue("rollhistograms", global::fRollHistograms);
+		ns.SetValue("checkpointevents", global::fCheckpointEvents);
+		ns.SetValue("checkpointbursts", global::fCheckpointBursts);
+		ns.SetValue("filecatalog", global::fFileCatalog);
+		ns.SetValue("scanthreads", global::fScanThreads);
+		ns.SetValue("eventindex", global::fEventIndex);
+		ns.SetValue("eventcachesize", global::fEventCacheSize);
+		ns.SetValue("eventcachedir", global::fEventCacheDir);
+		ns.SetValue("samplingseed", global::fSamplingSeed);
+		ns.SetValue("stagingdir", global::fStagingDir);
+		ns.SetValue("stagingsize", global::fStagingSize);
+		ns.SetValue("stagingremote", global::fStagingRemote);
+		ns.SetValue("stagingverify", global::fStagingVerify);
+	}
+	if(NamespaceExists("output")){
+		for(auto &param : GetNamespace("output").GetParams())
+			output::fTreeSettings[param.first] = param.second;
+	}
+	if(NamespaceExists("streams")){
+		for(auto &param : GetNamespace("streams").GetParams())
+			streams::fStreams[param.first] = param.second;
 	}
 }
 
@@ -48,5 +74,25 @@ bool ConfigSettings::global::fProcessOutputNewLine = true;
 std::string ConfigSettings::global::fSkippedName = "NA62Analysis";
 std::string ConfigSettings::global::fSvcClass = "na62";
 int ConfigSettings::global::fEventsDownscaling = 1000;
+std::string ConfigSettings::global::fSkimBranches = "";
+bool ConfigSettings::global::fFastSkim = false;
+int ConfigSettings::global::fWriterQueueSize = 0;
+int ConfigSettings::global::fRollSize = 0;
+int ConfigSettings::global::fRollBursts = 0;
+bool ConfigSettings::global::fRollHistograms = false;
+int ConfigSettings::global::fCheckpointEvents = 0;
+int ConfigSettings::global::fCheckpointBursts = 0;
+std::string ConfigSettings::global::fFileCatalog = "";
+int ConfigSettings::global::fScanThreads = 2;
+std::string ConfigSettings::global::fEventIndex = "";
+int ConfigSettings::global::fEventCacheSize = 2000;
+std::string ConfigSettings::global::fEventCacheDir = "";
+int ConfigSettings::global::fSamplingSeed = 0;
+std::string ConfigSettings::global::fStagingDir = "";
+int ConfigSettings::global::fStagingSize = 100000;
+std::string ConfigSettings::global::fStagingRemote = "root://";
+bool ConfigSettings::global::fStagingVerify = false;
+std::map<TString, TString> ConfigSettings::output::fTreeSettings;
+std::map<TString, TString> ConfigSettings::streams::fStreams;
 } /* namespace Configuration */
 } /* namespace NA62Analysis */
@@ -6,6 +6,10 @@
  */
 
 #include "CounterHandler.hh"
+
+#include <TDirectory.h>
+#include <TParameter.h>
+
 #include "StringBalancedTable.hh"
 
 namespace NA62Analysis {
@@ -54,6 +58,34 @@ void CounterHandler::WriteEventFraction(TString fileName) const{
 	}
 }
 
+void CounterHandler::WriteCounters(TDirectory* dir) const{
+	/// \MemberDescr
+	/// \param dir : Target directory
+	///
+	/// Write the value of each counter as a TParameter<int>
+	/// \EndMemberDescr
+
+	for(auto &it : fCounters){
+		TParameter<int> counter(it.first, it.second);
+		dir->WriteTObject(&counter);
+	}
+}
+
+void CounterHandler::ReadCounters(TDirectory* dir){
+	/// \MemberDescr
+	/// \param dir : Directory containing counters written by WriteCounters
+	///
+	/// Restore the value of the booked counters
+	/// \EndMemberDescr
+
+	for(auto &it : fCounters){
+		TParameter<int> *counter = (TParameter<int>*)dir->Get(it.first);
+		if(!counter) continue;
+		it.second = counter->GetVal();
+		delete counter;
+	}
+}
+
 void CounterHandler::NewEventFraction(TString name){
 	/// \MemberDescr
 	/// \param name : Name of the EventFraction table
@@ -0,0 +1,165 @@
+/*
+ * EventCache.cc
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ncl
+ */
+
+#include "EventCache.hh"
+
+#include <iostream>
+#include <sys/types.h>
+
+#include <TSystem.h>
+
+namespace NA62Analysis {
+namespace Core {
+
+EventCache::EventCache(Long64_t memoryLimit, TString spillDir) :
+	fFailed(false),
+	fMemoryLimit(memoryLimit),
+	fMemorySize(0),
+	fSpillSize(0),
+	fSpillDir(spillDir),
+	fSpillFile(nullptr),
+	fWriteBuffer(TBuffer::kWrite),
+	fReadBuffer(TBuffer::kRead)
+{
+	/// \MemberDescr
+	/// \param memoryLimit : Maximum size in bytes of the events kept in memory
+	/// \param spillDir : Directory of the temporary file receiving the next events (system
+	/// temporary directory if empty)
+	/// \EndMemberDescr
+
+	if(fSpillDir.Length()==0) fSpillDir = gSystem->TempDirectory();
+}
+
+EventCache::~EventCache() {
+	/// \MemberDescr
+	/// Destructor. Delete the temporary file.
+	/// \EndMemberDescr
+
+	DropData();
+}
+
+TBufferFile* EventCache::StartEvent() {
+	/// \MemberDescr
+	/// \return Empty buffer in which the event must be streamed, nullptr if the buffers are
+	/// not kept anymore (only the index is recorded by EndEvent)
+	/// \EndMemberDescr
+
+	if(fFailed) return nullptr;
+	fWriteBuffer.SetWriteMode();
+	fWriteBuffer.SetBufferOffset(0);
+	fWriteBuffer.ResetMap();
+	return &fWriteBuffer;
+}
+
+void EventCache::EndEvent(Long64_t iEvent) {
+	/// \MemberDescr
+	/// \param iEvent : Index of the event in the first pass
+	///
+	/// Add the event streamed in the buffer returned by StartEvent to the cache
+	/// \EndMemberDescr
+
+	CachedEvent event;
+	event.fEvent = iEvent;
+	event.fMemoryIndex = -1;
+	event.fSpillOffset = fSpillSize;
+	event.fSize = 0;
+
+	if(!fFailed){
+		event.fSize = fWriteBuffer.Length();
+		if(fMemorySize+event.fSize<=fMemoryLimit){
+			event.fMemoryIndex = fMemory.size();
+			fMemory.push_back(std::vector<char>(fWriteBuffer.Buffer(), fWriteBuffer.Buffer()+event.fSize));
+			fMemorySize += event.fSize;
+		}
+		else if(!Spill(fWriteBuffer.Buffer(), event.fSize)){
+			std::cout << "Unable to write the event cache in " << fSpillDir
+					<< ": the events will be read again from the input files in the next passes" << std::endl;
+			DropData();
+			fFailed = true;
+		}
+	}
+	fEvents.push_back(event);
+}
+
+TBufferFile* EventCache::GetEvent(Long64_t index) {
+	/// \MemberDescr
+	/// \param index : Index of the event in the cache
+	/// \return Buffer containing the event, ready to be read. nullptr if the event is not
+	/// available (buffers not kept or temporary file not readable)
+	/// \EndMemberDescr
+
+	if(fFailed || index<0 || index>=(Long64_t)fEvents.size()) return nullptr;
+
+	const CachedEvent &event = fEvents[index];
+	char *data;
+	if(event.fMemoryIndex>=0) data = fMemory[event.fMemoryIndex].data();
+	else{
+		fSpillBuffer.resize(event.fSize);
+		if(fseeko(fSpillFile, (off_t)event.fSpillOffset, SEEK_SET)!=0
+				|| fread(fSpillBuffer.data(), 1, event.fSize, fSpillFile)!=event.fSize){
+			std::cout << "Unable to read event " << event.fEvent << " from the event cache " << fSpillName << std::endl;
+			return nullptr;
+		}
+		data = fSpillBuffer.data();
+	}
+
+	fReadBuffer.SetBuffer(data, event.fSize, kFALSE);
+	fReadBuffer.SetReadMode();
+	fReadBuffer.SetBufferOffset(0);
+	fReadBuffer.ResetMap();
+	return &fReadBuffer;
+}
+
+void EventCache::PrintSummary() const {
+	/// \MemberDescr
+	/// Print the number of cached events and the size used in memory and on disk
+	/// \EndMemberDescr
+
+	std::cout << "Event cache: " << fEvents.size() << " events";
+	if(fFailed) std::cout << " (read from the input files)" << std::endl;
+	else std::cout << ", " << fMemorySize/1048576. << " MB in memory, "
+			<< fSpillSize/1048576. << " MB in " << fSpillDir << std::endl;
+}
+
+bool EventCache::Spill(const char* data, UInt_t size) {
+	/// \MemberDescr
+	/// \param data : Buffer to write
+	/// \param size : Size of the buffer
+	/// \return False if the buffer cannot be written in the temporary file
+	///
+	/// Append the buffer to the temporary file (created with the first buffer)
+	/// \EndMemberDescr
+
+	if(!fSpillFile){
+		fSpillName = "NA62AnalysisEventCache";
+		fSpillFile = gSystem->TempFileName(fSpillName, fSpillDir);
+		if(!fSpillFile) return false;
+	}
+	if(fseeko(fSpillFile, (off_t)fSpillSize, SEEK_SET)!=0 || fwrite(data, 1, size, fSpillFile)!=size)
+		return false;
+	fSpillSize += size;
+	return true;
+}
+
+void EventCache::DropData() {
+	/// \MemberDescr
+	/// Free the buffers kept in memory and delete the temporary file
+	/// \EndMemberDescr
+
+	std::vector<std::vector<char> >().swap(fMemory);
+	std::vector<char>().swap(fSpillBuffer);
+	fMemorySize = 0;
+	if(fSpillFile){
+		fclose(fSpillFile);
+		gSystem->Unlink(fSpillName);
+		fSpillFile = nullptr;
+	}
+	fSpillSize = 0;
+}
+
+} /* namespace Core */
+} /* namespace NA62Analysis */
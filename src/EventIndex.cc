@@ -0,0 +1,424 @@
+/*
+ * EventIndex.cc
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ncl
+ */
+
+#include "EventIndex.hh"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <set>
+#include <tuple>
+#include <algorithm>
+
+#include <TFile.h>
+#include <TTree.h>
+#include <TKey.h>
+#include <TEntryList.h>
+#include <TSystem.h>
+
+#include "RawHeader.hh"
+#include "FileCatalog.hh"
+#include "containers.hh"
+
+namespace NA62Analysis {
+namespace Core {
+
+EventIndex::EventIndex() :
+	fModified(false)
+{
+	/// \MemberDescr
+	/// Default constructor
+	/// \EndMemberDescr
+}
+
+EventIndex::~EventIndex() {
+	/// \MemberDescr
+	/// Destructor
+	/// \EndMemberDescr
+}
+
+bool EventIndex::Load(TString fileName) {
+	/// \MemberDescr
+	/// \param fileName : Path to the index file
+	/// \return False if the index file exists but cannot be read
+	///
+	/// Set the index file and read it. A missing file is an empty index.
+	/// \EndMemberDescr
+
+	fFileName = fileName;
+	fModified = false;
+	if(!ReadIndex(fileName, fFiles, fEvents)) return false;
+	if(fFiles.size()>0)
+		std::cout << "Event index " << fileName << ": " << fEvents.size() << " events in "
+				<< fFiles.size() << " files" << std::endl;
+	return true;
+}
+
+bool EventIndex::ReadIndex(TString fileName, std::vector<IndexedFile> &indexFiles,
+		std::vector<IndexedEvent> &indexEvents) {
+	/// \MemberDescr
+	/// \param fileName : Path to the index file
+	/// \param indexFiles : Filled with the indexed files
+	/// \param indexEvents : Filled with the indexed events
+	/// \return False if the index file exists but cannot be read
+	///
+	/// Read the files and events of an index file. A missing file is an empty index.
+	/// \EndMemberDescr
+
+	indexFiles.clear();
+	indexEvents.clear();
+	if(fileName.Length()==0 || gSystem->AccessPathName(fileName)) return true;
+
+	TFile *fd = TFile::Open(fileName, "READ");
+	TTree *files = fd && !fd->IsZombie() ? (TTree*)fd->Get("Files") : nullptr;
+	TTree *events = fd && !fd->IsZombie() ? (TTree*)fd->Get("Events") : nullptr;
+	if(!files || !events){
+		std::cout << "Unable to read the event index " << fileName << std::endl;
+		if(fd) delete fd;
+		return false;
+	}
+
+	std::string *name = nullptr, *treeName = nullptr;
+	Long64_t modTime;
+	IndexedFile file;
+	file.fUpdated = false;
+	files->SetBranchAddress("Name", &name);
+	files->SetBranchAddress("Tree", &treeName);
+	files->SetBranchAddress("Size", &file.fSize);
+	files->SetBranchAddress("ModTime", &modTime);
+	for(Long64_t i=0; i<files->GetEntries(); ++i){
+		files->GetEntry(i);
+		file.fName = *name;
+		file.fTreeName = *treeName;
+		file.fModTime = modTime;
+		indexFiles.push_back(file);
+	}
+
+	IndexedEvent event;
+	events->SetBranchAddress("File", &event.fFile);
+	events->SetBranchAddress("Entry", &event.fEntry);
+	events->SetBranchAddress("Run", &event.fRun);
+	events->SetBranchAddress("Burst", &event.fBurst);
+	events->SetBranchAddress("EventNumber", &event.fEventNumber);
+	events->SetBranchAddress("TimeStamp", &event.fTimeStamp);
+	indexEvents.reserve(events->GetEntries());
+	for(Long64_t i=0; i<events->GetEntries(); ++i){
+		events->GetEntry(i);
+		indexEvents.push_back(event);
+	}
+	fd->Close();
+	delete fd;
+	delete name;
+	delete treeName;
+	return true;
+}
+
+bool EventIndex::Save() {
+	/// \MemberDescr
+	/// \return False if the index cannot be written
+	///
+	/// Write the index if it was modified. The index written in the meantime by concurrent
+	/// jobs is read again and merged under an exclusive lock: only the files indexed by this
+	/// job replace those of the index file. The index is written in a temporary file which is
+	/// then renamed, so that concurrent jobs never read a partial index.
+	/// \EndMemberDescr
+
+	if(fFileName.Length()==0 || !fModified) return true;
+
+	TString lockName = fFileName + ".lock";
+	int lockFD = open(lockName.Data(), O_CREAT | O_RDWR, 0666);
+	if(lockFD<0 || flock(lockFD, LOCK_EX)!=0)
+		std::cout << "Unable to lock the event index " << lockName << ": concurrent updates may be lost" << std::endl;
+
+	//Merge the files indexed by this job in the current index file
+	std::vector<IndexedFile> mergedFiles;
+	std::vector<IndexedEvent> mergedEvents;
+	ReadIndex(fFileName, mergedFiles, mergedEvents);
+	NA62Analysis::NA62Map<TString, Int_t>::type fileIndex;
+	for(unsigned int i=0; i<mergedFiles.size(); ++i) fileIndex[mergedFiles[i].fName] = i;
+	std::vector<Int_t> mergedIndex(fFiles.size(), -1);
+	for(unsigned int i=0; i<fFiles.size(); ++i){
+		auto it = fileIndex.find(fFiles[i].fName);
+		if(it==fileIndex.end()){
+			mergedFiles.push_back(fFiles[i]);
+			mergedIndex[i] = mergedFiles.size()-1;
+		}
+		else if(fFiles[i].fUpdated){
+			Int_t index = it->second;
+			mergedEvents.erase(std::remove_if(mergedEvents.begin(), mergedEvents.end(),
+					[index](const IndexedEvent &event){ return event.fFile==index; }), mergedEvents.end());
+			mergedFiles[index] = fFiles[i];
+			mergedIndex[i] = index;
+		}
+	}
+	for(auto event : fEvents){
+		if(mergedIndex[event.fFile]<0) continue;
+		event.fFile = mergedIndex[event.fFile];
+		mergedEvents.push_back(event);
+	}
+
+	bool success = true;
+	TDirectory *currentDir = gDirectory;
+	TString tmpName = fFileName + TString::Format(".%d.tmp", gSystem->GetPid());
+	TFile *fd = TFile::Open(tmpName, "RECREATE");
+	if(!fd || fd->IsZombie()){
+		std::cout << "Unable to write the event index " << tmpName << std::endl;
+		if(fd) delete fd;
+		success = false;
+	}
+	else{
+		std::string name, treeName;
+		Long64_t modTime;
+		IndexedFile file;
+		TTree *files = new TTree("Files", "Indexed files");
+		files->Branch("Name", &name);
+		files->Branch("Tree", &treeName);
+		files->Branch("Size", &file.fSize, "Size/L");
+		files->Branch("ModTime", &modTime, "ModTime/L");
+		for(auto &it : mergedFiles){
+			file = it;
+			modTime = it.fModTime;
+			name = it.fName.Data();
+			treeName = it.fTreeName.Data();
+			files->Fill();
+		}
+
+		IndexedEvent event;
+		TTree *events = new TTree("Events", "Indexed events");
+		events->Branch("File", &event.fFile, "File/I");
+		events->Branch("Entry", &event.fEntry, "Entry/L");
+		events->Branch("Run", &event.fRun, "Run/I");
+		events->Branch("Burst", &event.fBurst, "Burst/I");
+		events->Branch("EventNumber", &event.fEventNumber, "EventNumber/i");
+		events->Branch("TimeStamp", &event.fTimeStamp, "TimeStamp/i");
+		for(auto &it : mergedEvents){
+			event = it;
+			events->Fill();
+		}
+		fd->Write();
+		fd->Close();
+		delete fd;
+
+		if(rename(tmpName.Data(), fFileName.Data())!=0){
+			std::cout << "Unable to rename " << tmpName << " to " << fFileName << std::endl;
+			success = false;
+		}
+	}
+	currentDir->cd();
+
+	if(lockFD>=0){
+		flock(lockFD, LOCK_UN);
+		close(lockFD);
+	}
+	if(success){
+		for(auto &it : mergedFiles) it.fUpdated = false;
+		fFiles.swap(mergedFiles);
+		fEvents.swap(mergedEvents);
+		fModified = false;
+	}
+	return success;
+}
+
+bool EventIndex::Update(const std::vector<TString> &inputFiles) {
+	/// \MemberDescr
+	/// \param inputFiles : Input files
+	/// \return False if no input file could be indexed
+	///
+	/// Index the input files not in the index or modified since they were indexed
+	/// \EndMemberDescr
+
+	NA62Analysis::NA62Map<TString, Int_t>::type fileIndex;
+	for(unsigned int i=0; i<fFiles.size(); ++i) fileIndex[fFiles[i].fName] = i;
+
+	int nIndexed = 0, nAvailable = 0;
+	for(auto fileName : inputFiles){
+		Long64_t size;
+		Long_t modTime;
+		if(!FileCatalog::GetFileInfo(fileName, size, modTime)){
+			std::cout << "Unable to index " << fileName << std::endl;
+			continue;
+		}
+		auto it = fileIndex.find(fileName);
+		if(it!=fileIndex.end()){
+			IndexedFile &file = fFiles[it->second];
+			if(file.fSize==size && file.fModTime==modTime){
+				++nAvailable;
+				continue;
+			}
+			//Modified file: replace its events
+			Int_t index = it->second;
+			fEvents.erase(std::remove_if(fEvents.begin(), fEvents.end(),
+					[index](const IndexedEvent &event){ return event.fFile==index; }), fEvents.end());
+			fModified = true;
+			//Recorded as indexed only once read: otherwise indexed again by the next job
+			if(!IndexFile(fileName, index)) continue;
+			file.fSize = size;
+			file.fModTime = modTime;
+			file.fUpdated = true;
+		}
+		else{
+			IndexedFile file;
+			file.fName = fileName;
+			file.fSize = size;
+			file.fModTime = modTime;
+			file.fUpdated = true;
+			fFiles.push_back(file);
+			if(!IndexFile(fileName, fFiles.size()-1)){
+				fFiles.pop_back();
+				continue;
+			}
+			fileIndex[fileName] = fFiles.size()-1;
+		}
+		++nAvailable;
+		++nIndexed;
+		fModified = true;
+	}
+	std::cout << "Event index: " << nIndexed << " files indexed, " << nAvailable << "/"
+			<< inputFiles.size() << " input files available" << std::endl;
+	return nAvailable>0;
+}
+
+bool EventIndex::IndexFile(TString fileName, Int_t fileIndex) {
+	/// \MemberDescr
+	/// \param fileName : Path to the file
+	/// \param fileIndex : Index of the file in fFiles
+	/// \return False if the file cannot be read or does not contain a RawHeader
+	///
+	/// Read the RawHeader branch of the file and add its events to the index
+	/// \EndMemberDescr
+
+	fFiles[fileIndex].fTreeName = "";
+	TFile *fd = TFile::Open(fileName, "READ");
+	if(!fd || fd->IsZombie()){
+		std::cout << "Unable to open " << fileName << std::endl;
+		if(fd) delete fd;
+		return false;
+	}
+
+	TTree *tree = nullptr;
+	TList *keys = fd->GetListOfKeys();
+	for(int i=0; i<keys->GetEntries() && !tree; ++i){
+		TKey *key = (TKey*)keys->At(i);
+		if(TString(key->GetClassName()).CompareTo("TTree")!=0) continue;
+		TTree *candidate = (TTree*)fd->Get(key->GetName());
+		if(candidate && candidate->FindBranch("RawHeader")) tree = candidate;
+	}
+	if(!tree){
+		std::cout << "No RawHeader found in " << fileName << std::endl;
+		fd->Close();
+		delete fd;
+		return false;
+	}
+
+	RawHeader *header = new RawHeader;
+	tree->SetBranchStatus("*", 0);
+	tree->SetBranchStatus("RawHeader*", 1);
+	tree->SetBranchAddress("RawHeader", &header);
+	IndexedEvent event;
+	event.fFile = fileIndex;
+	for(Long64_t i=0; i<tree->GetEntries(); ++i){
+		tree->GetEntry(i);
+		event.fEntry = i;
+		event.fRun = header->GetRunID();
+		event.fBurst = header->GetBurstID();
+		event.fEventNumber = header->GetEventNumber();
+		event.fTimeStamp = header->GetTimeStamp();
+		fEvents.push_back(event);
+	}
+	fFiles[fileIndex].fTreeName = tree->GetName();
+	tree->ResetBranchAddresses();
+	fd->Close();
+	delete fd;
+	delete header;
+	return true;
+}
+
+TEntryList* EventIndex::Select(TString selectionFile, const std::vector<TString> &inputFiles) const {
+	/// \MemberDescr
+	/// \param selectionFile : Path to the selection file
+	/// \param inputFiles : Input files in which the events are searched
+	/// \return Entry list of the selected events (one sub-list per file, in the order of
+	/// inputFiles), nullptr if the selection file cannot be read
+	/// \EndMemberDescr
+
+	std::ifstream fd(selectionFile.Data());
+	if(!fd.is_open()){
+		std::cout << "Unable to read the event selection " << selectionFile << std::endl;
+		return nullptr;
+	}
+
+	//Timestamp range in a burst
+	struct TimeRange {
+		Int_t fRun;
+		Int_t fBurst;
+		UInt_t fMin;
+		UInt_t fMax;
+	};
+	std::set<std::tuple<Int_t, Int_t, UInt_t> > eventIDs;
+	std::vector<TimeRange> timeRanges;
+
+	TString line;
+	while(line.ReadLine(fd)){
+		line = line.Strip(TString::kBoth);
+		if(line.Length()==0 || line.BeginsWith("#")) continue;
+		std::istringstream ss(line.Data());
+		std::vector<Long64_t> values;
+		Long64_t value;
+		while(ss >> value) values.push_back(value);
+		if(values.size()==3)
+			eventIDs.insert(std::make_tuple((Int_t)values[0], (Int_t)values[1], (UInt_t)values[2]));
+		else if(values.size()==4)
+			timeRanges.push_back({(Int_t)values[0], (Int_t)values[1], (UInt_t)values[2], (UInt_t)values[3]});
+		else
+			std::cout << "Invalid line in the event selection: " << line << std::endl;
+	}
+	fd.close();
+
+	//Position of each indexed file in the input files
+	NA62Analysis::NA62Map<TString, int>::type inputIndex;
+	for(unsigned int i=0; i<inputFiles.size(); ++i) inputIndex[inputFiles[i]] = i;
+	std::vector<int> filePosition(fFiles.size(), -1);
+	for(unsigned int i=0; i<fFiles.size(); ++i){
+		auto it = inputIndex.find(fFiles[i].fName);
+		if(it!=inputIndex.end()) filePosition[i] = it->second;
+	}
+
+	std::vector<std::pair<int, Int_t> > selected; //(Input position, indexed event)
+	for(unsigned int i=0; i<fEvents.size(); ++i){
+		const IndexedEvent &event = fEvents[i];
+		if(filePosition[event.fFile]<0) continue;
+		bool match = eventIDs.count(std::make_tuple(event.fRun, event.fBurst, event.fEventNumber))>0;
+		for(unsigned int j=0; j<timeRanges.size() && !match; ++j){
+			match = timeRanges[j].fRun==event.fRun && timeRanges[j].fBurst==event.fBurst
+					&& event.fTimeStamp>=timeRanges[j].fMin && event.fTimeStamp<=timeRanges[j].fMax;
+		}
+		if(match) selected.push_back(std::make_pair(filePosition[event.fFile], i));
+	}
+	std::sort(selected.begin(), selected.end(),
+			[this](const std::pair<int, Int_t> &a, const std::pair<int, Int_t> &b){
+				if(a.first!=b.first) return a.first<b.first;
+				return fEvents[a.second].fEntry<fEvents[b.second].fEntry;
+			});
+
+	TEntryList *list = new TEntryList("EntryList", "Selected events");
+	list->SetDirectory(0);
+	for(auto &it : selected){
+		const IndexedEvent &event = fEvents[it.second];
+		list->SetTree(fFiles[event.fFile].fTreeName, fFiles[event.fFile].fName);
+		list->Enter(event.fEntry);
+	}
+	std::cout << "Event selection " << selectionFile << ": " << list->GetN() << " events selected ("
+			<< eventIDs.size() << " requested events, " << timeRanges.size() << " time ranges)" << std::endl;
+	return list;
+}
+
+} /* namespace Core */
+} /* namespace NA62Analysis */
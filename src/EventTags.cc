@@ -0,0 +1,374 @@
+/*
+ * EventTags.cc
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ncl
+ */
+
+#include "EventTags.hh"
+
+#include <iostream>
+#include <algorithm>
+#include <cctype>
+
+#include <TFile.h>
+#include <TTree.h>
+#include <TBranch.h>
+#include <TList.h>
+#include <TNamed.h>
+#include <TObjString.h>
+#include <TEntryList.h>
+#include <TSystem.h>
+
+namespace NA62Analysis {
+namespace Core {
+
+/// Operator codes of the compiled expressions (the tags are coded by their bit index)
+enum TagOperator {kTagNot=-1, kTagAnd=-2, kTagOr=-3, kTagParenthesis=-4};
+
+EventTags::EventTags() :
+	fTags(0),
+	fFile(nullptr),
+	fTree(nullptr),
+	fFileIndex(-1),
+	fEntry(-1),
+	fTagsBuffer(0)
+{
+	/// \MemberDescr
+	/// Default constructor
+	/// \EndMemberDescr
+}
+
+EventTags::~EventTags() {
+	/// \MemberDescr
+	/// Destructor. Write and close the tag file if still open.
+	/// \EndMemberDescr
+
+	CloseOutput();
+}
+
+int EventTags::DefineTag(TString name) {
+	/// \MemberDescr
+	/// \param name : Name of the tag
+	/// \return Bit of the tag in the mask, -1 if the 64 tags are already defined
+	///
+	/// Define a new tag. Defining an existing tag returns its bit.
+	/// \EndMemberDescr
+
+	for(unsigned int i=0; i<fNames.size(); ++i){
+		if(fNames[i].CompareTo(name)==0) return i;
+	}
+	if(fNames.size()>=64){
+		std::cout << "Unable to define the tag " << name << ": 64 tags already defined" << std::endl;
+		return -1;
+	}
+	fNames.push_back(name);
+	return fNames.size()-1;
+}
+
+bool EventTags::SetTag(TString name, bool value) {
+	/// \MemberDescr
+	/// \param name : Name of the tag
+	/// \param value : Value of the tag for the current event
+	/// \return False if the tag is not defined
+	/// \EndMemberDescr
+
+	for(unsigned int i=0; i<fNames.size(); ++i){
+		if(fNames[i].CompareTo(name)!=0) continue;
+		if(value) fTags |= (ULong64_t)1 << i;
+		else fTags &= ~((ULong64_t)1 << i);
+		return true;
+	}
+	std::cout << "Tag " << name << " is not defined (see DefineTag)" << std::endl;
+	return false;
+}
+
+bool EventTags::IsTagged(TString name) const {
+	/// \MemberDescr
+	/// \param name : Name of the tag
+	/// \return True if the tag is set for the current event
+	/// \EndMemberDescr
+
+	for(unsigned int i=0; i<fNames.size(); ++i){
+		if(fNames[i].CompareTo(name)==0) return (fTags >> i) & 1;
+	}
+	return false;
+}
+
+bool EventTags::OpenOutput(TString fileName) {
+	/// \MemberDescr
+	/// \param fileName : Path of the tag file to write
+	/// \return False if the file cannot be created
+	/// \EndMemberDescr
+
+	CloseOutput();
+	TDirectory *currentDir = gDirectory;
+	fFile = TFile::Open(fileName, "RECREATE");
+	if(!fFile || fFile->IsZombie()){
+		std::cout << "Unable to create the tag file " << fileName << std::endl;
+		if(fFile) delete fFile;
+		fFile = nullptr;
+		currentDir->cd();
+		return false;
+	}
+	fTree = new TTree("EventTags", "Event tags");
+	fTree->Branch("file", &fFileIndex, "file/I");
+	fTree->Branch("entry", &fEntry, "entry/L");
+	fTree->Branch("tags", &fTagsBuffer, "tags/l");
+	currentDir->cd();
+
+	fFileName = fileName;
+	fFiles.clear();
+	fFileIndices.clear();
+	return true;
+}
+
+void EventTags::Fill(TString fileName, TString treeName, Long64_t entry) {
+	/// \MemberDescr
+	/// \param fileName : Input file of the current event
+	/// \param treeName : Input tree of the current event
+	/// \param entry : Entry of the current event in this file
+	///
+	/// Write the tags of the current event in the tag file
+	/// \EndMemberDescr
+
+	if(!fTree) return;
+	auto it = fFileIndices.find(fileName);
+	if(it==fFileIndices.end()){
+		fFiles.push_back(std::make_pair(fileName, treeName));
+		it = fFileIndices.insert(std::make_pair(fileName, (int)fFiles.size()-1)).first;
+	}
+	fFileIndex = it->second;
+	fEntry = entry;
+	fTagsBuffer = fTags;
+	fTree->Fill();
+}
+
+void EventTags::CloseOutput() {
+	/// \MemberDescr
+	/// Write the tags tree and the names of the tags and input files, and close the tag file
+	/// \EndMemberDescr
+
+	if(!fFile) return;
+	TDirectory *currentDir = gDirectory;
+	fFile->cd();
+	fTree->Write();
+
+	TList names;
+	names.SetOwner(true);
+	for(auto name : fNames) names.Add(new TObjString(name));
+	names.Write("TagNames", TObject::kSingleKey);
+
+	TList files;
+	files.SetOwner(true);
+	for(auto &file : fFiles) files.Add(new TNamed(file.first, file.second));
+	files.Write("TagFiles", TObject::kSingleKey);
+
+	std::cout << "Event tags written in " << fFileName << ": " << fTree->GetEntries() << " events, "
+			<< fNames.size() << " tags" << std::endl;
+	fFile->Close();
+	delete fFile;
+	fFile = nullptr;
+	fTree = nullptr;
+	currentDir->cd();
+}
+
+TEntryList* EventTags::Select(TString tagFile, TString expression, const std::vector<TString> &inputFiles) {
+	/// \MemberDescr
+	/// \param tagFile : Path to a tag file written with --make-tags
+	/// \param expression : Tag expression the events must match
+	/// \param inputFiles : Input files in which the events are selected
+	/// \return Entry list of the selected events (one sub-list per file, in the order of
+	/// inputFiles), nullptr if the tag file cannot be read or the expression is invalid
+	///
+	/// Only the tags column is read for all the entries, the file and entry columns are read
+	/// for the matching entries only. The input files are matched by path, or by file name
+	/// if the path differs (files moved).
+	/// \EndMemberDescr
+
+	TDirectory *currentDir = gDirectory;
+	TFile *fd = TFile::Open(tagFile, "READ");
+	TTree *tree = fd ? (TTree*)fd->Get("EventTags") : nullptr;
+	TList *names = tree ? (TList*)fd->Get("TagNames") : nullptr;
+	TList *files = names ? (TList*)fd->Get("TagFiles") : nullptr;
+	if(!files){
+		std::cout << "Unable to read the tag file " << tagFile << std::endl;
+		if(fd) delete fd;
+		currentDir->cd();
+		return nullptr;
+	}
+
+	std::vector<TString> tagNames;
+	for(int i=0; i<names->GetEntries(); ++i) tagNames.push_back(((TObjString*)names->At(i))->GetString());
+	std::vector<int> program;
+	if(!Compile(expression, tagNames, program)){
+		std::cout << "Invalid tag expression: " << expression << std::endl;
+		fd->Close();
+		delete fd;
+		currentDir->cd();
+		return nullptr;
+	}
+
+	//Position of each tagged file in the input files
+	std::vector<int> filePosition(files->GetEntries(), -1);
+	std::vector<TString> treeNames(inputFiles.size());
+	for(int i=0; i<files->GetEntries(); ++i){
+		TNamed *file = (TNamed*)files->At(i);
+		for(unsigned int j=0; j<inputFiles.size() && filePosition[i]<0; ++j){
+			if(inputFiles[j].CompareTo(file->GetName())==0) filePosition[i] = j;
+		}
+		for(unsigned int j=0; j<inputFiles.size() && filePosition[i]<0; ++j){
+			if(TString(gSystem->BaseName(inputFiles[j])).CompareTo(gSystem->BaseName(file->GetName()))==0) filePosition[i] = j;
+		}
+		if(filePosition[i]>=0) treeNames[filePosition[i]] = file->GetTitle();
+	}
+	for(unsigned int j=0; j<inputFiles.size(); ++j){
+		if(treeNames[j].Length()==0) std::cout << "No tags for the input file " << inputFiles[j] << ": file skipped" << std::endl;
+	}
+
+	Int_t fileIndex;
+	Long64_t entry;
+	ULong64_t tags;
+	tree->SetBranchAddress("file", &fileIndex);
+	tree->SetBranchAddress("entry", &entry);
+	tree->SetBranchAddress("tags", &tags);
+	TBranch *fileBranch = tree->GetBranch("file");
+	TBranch *entryBranch = tree->GetBranch("entry");
+	TBranch *tagsBranch = tree->GetBranch("tags");
+
+	std::vector<std::pair<int, Long64_t> > selected; //(Input position, entry)
+	Long64_t nTagged = tree->GetEntries();
+	for(Long64_t i=0; i<nTagged; ++i){
+		tagsBranch->GetEntry(i);
+		if(!Evaluate(program, tags)) continue;
+		fileBranch->GetEntry(i);
+		if(fileIndex<0 || fileIndex>=(int)filePosition.size() || filePosition[fileIndex]<0) continue;
+		entryBranch->GetEntry(i);
+		selected.push_back(std::make_pair(filePosition[fileIndex], entry));
+	}
+	std::sort(selected.begin(), selected.end());
+	selected.erase(std::unique(selected.begin(), selected.end()), selected.end());
+
+	TEntryList *list = new TEntryList("EntryList", "Tagged events");
+	list->SetDirectory(0);
+	for(auto &it : selected){
+		list->SetTree(treeNames[it.first], inputFiles[it.first]);
+		list->Enter(it.second);
+	}
+	std::cout << "Tag selection " << expression << ": " << list->GetN() << " of " << nTagged
+			<< " tagged events selected" << std::endl;
+
+	names->SetOwner(true);
+	files->SetOwner(true);
+	delete names;
+	delete files;
+	fd->Close();
+	delete fd;
+	currentDir->cd();
+	return list;
+}
+
+bool EventTags::Compile(TString expression, const std::vector<TString> &names, std::vector<int> &program) {
+	/// \MemberDescr
+	/// \param expression : Tag expression
+	/// \param names : Names of the tags (bit i for the i-th name)
+	/// \param program : Filled with the expression in reverse polish notation (bit index of the
+	/// tags and TagOperator codes)
+	/// \return False if the expression is invalid or uses an unknown tag
+	/// \EndMemberDescr
+
+	std::vector<int> operators;
+	bool expectOperand = true;
+	int i = 0;
+	int length = expression.Length();
+	program.clear();
+	while(i<length){
+		char c = expression[i];
+		if(isspace(c)){
+			++i;
+			continue;
+		}
+		if(c=='!' || c=='('){
+			if(!expectOperand) return false;
+			operators.push_back(c=='!' ? kTagNot : kTagParenthesis);
+			++i;
+		}
+		else if(c==')'){
+			if(expectOperand) return false;
+			while(operators.size()>0 && operators.back()!=kTagParenthesis){
+				program.push_back(operators.back());
+				operators.pop_back();
+			}
+			if(operators.size()==0) return false;
+			operators.pop_back();
+			++i;
+		}
+		else if((c=='&' || c=='|') && i+1<length && expression[i+1]==c){
+			if(expectOperand) return false;
+			int op = c=='&' ? kTagAnd : kTagOr;
+			//Operators with a higher or equal precedence (! > && > ||) are applied first
+			while(operators.size()>0 && operators.back()!=kTagParenthesis && operators.back()>=op){
+				program.push_back(operators.back());
+				operators.pop_back();
+			}
+			operators.push_back(op);
+			expectOperand = true;
+			i += 2;
+		}
+		else{
+			if(!expectOperand) return false;
+			TString name;
+			if(c=='"'){
+				int end = expression.Index("\"", i+1);
+				if(end<0) return false;
+				name = expression(i+1, end-i-1);
+				i = end+1;
+			}
+			else{
+				int begin = i;
+				while(i<length && !isspace(expression[i]) && expression[i]!='(' && expression[i]!=')'
+						&& expression[i]!='!' && expression[i]!='&' && expression[i]!='|' && expression[i]!='"') ++i;
+				if(i==begin) return false;
+				name = expression(begin, i-begin);
+			}
+			auto it = std::find(names.begin(), names.end(), name);
+			if(it==names.end()){
+				std::cout << "Unknown tag " << name << std::endl;
+				return false;
+			}
+			program.push_back(it-names.begin());
+			expectOperand = false;
+		}
+	}
+	if(expectOperand) return false;
+	while(operators.size()>0){
+		if(operators.back()==kTagParenthesis) return false;
+		program.push_back(operators.back());
+		operators.pop_back();
+	}
+	return true;
+}
+
+bool EventTags::Evaluate(const std::vector<int> &program, ULong64_t tags) {
+	/// \MemberDescr
+	/// \param program : Compiled expression (see Compile)
+	/// \param tags : Mask of the tags of the event
+	/// \return Value of the expression for the event
+	/// \EndMemberDescr
+
+	std::vector<bool> stack;
+	for(auto code : program){
+		if(code>=0) stack.push_back((tags >> code) & 1);
+		else if(code==kTagNot) stack.back() = !stack.back();
+		else{
+			bool right = stack.back();
+			stack.pop_back();
+			if(code==kTagAnd) stack.back() = stack.back() && right;
+			else stack.back() = stack.back() || right;
+		}
+	}
+	return stack.size()>0 && stack.back();
+}
+
+} /* namespace Core */
+} /* namespace NA62Analysis */
@@ -0,0 +1,308 @@
+/*
+ * FileCatalog.cc
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ncl
+ */
+
+#include "FileCatalog.hh"
+
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+
+#include <TFile.h>
+#include <TTree.h>
+#include <TKey.h>
+#include <TBranch.h>
+#include <TSystem.h>
+#include <TObjArray.h>
+#include <TObjString.h>
+
+#include "ConfigSettings.hh"
+
+namespace NA62Analysis {
+namespace Core {
+
+FileCatalog *FileCatalog::fFileCatalog = 0;
+
+FileCatalog* FileCatalog::GetInstance() {
+	/// \MemberDescr
+	/// \return Pointer to the unique instance of FileCatalog
+	/// \EndMemberDescr
+
+	if(!fFileCatalog) fFileCatalog = new FileCatalog();
+	return fFileCatalog;
+}
+
+FileCatalog::FileCatalog() :
+	fModified(false),
+	fNHits(0),
+	fNScanned(0)
+{
+	/// \MemberDescr
+	/// Default private constructor to ensure uniqueness of the instance. Load the catalog
+	/// given in the settings.
+	/// \EndMemberDescr
+
+	TString fileName = Configuration::ConfigSettings::global::fFileCatalog;
+	if(fileName.Length()>0) Load(gSystem->ExpandPathName(fileName.Data()));
+}
+
+FileCatalog::~FileCatalog() {
+	/// \MemberDescr
+	/// Destructor
+	/// \EndMemberDescr
+}
+
+bool FileCatalog::Load(TString fileName) {
+	/// \MemberDescr
+	/// \param fileName : Path to the catalog file
+	/// \return False if the catalog file exists but cannot be read
+	///
+	/// Set the catalog file and read its records. A missing file is an empty catalog.
+	/// \EndMemberDescr
+
+	fFileName = fileName;
+	fRecords.clear();
+	fModified = false;
+	if(!ReadRecords(fileName, fRecords)) return false;
+	std::cout << "File catalog " << fileName << ": " << fRecords.size() << " files" << std::endl;
+	return true;
+}
+
+bool FileCatalog::Save() {
+	/// \MemberDescr
+	/// \return False if the catalog cannot be written
+	///
+	/// Write the catalog if it was modified. The records written in the meantime by
+	/// concurrent jobs are read again and merged under an exclusive lock, and the catalog is
+	/// written in a temporary file which is then renamed, so that concurrent jobs never read
+	/// a partial catalog. The files that could not be opened are not written: they are
+	/// checked again by the next job (the error may be transient).
+	/// \EndMemberDescr
+
+	if(!IsEnabled() || !fModified) return true;
+
+	TString lockName = fFileName + ".lock";
+	int lockFD = open(lockName.Data(), O_CREAT | O_RDWR, 0666);
+	if(lockFD<0 || flock(lockFD, LOCK_EX)!=0)
+		std::cout << "Unable to lock the file catalog " << lockName << ": concurrent updates may be lost" << std::endl;
+
+	NA62Analysis::NA62Map<TString, FileRecord>::type records;
+	ReadRecords(fFileName, records);
+	for(auto &it : fRecords){
+		if(it.second.fValid) records[it.first] = it.second;
+	}
+
+	bool success = true;
+	TString tmpName = fFileName + TString::Format(".%d.tmp", gSystem->GetPid());
+	std::ofstream fd(tmpName.Data());
+	if(!fd.is_open()){
+		std::cout << "Unable to write the file catalog " << tmpName << std::endl;
+		success = false;
+	}
+	else{
+		for(auto &it : records){
+			if(!it.second.fValid) continue;
+			fd << it.first << "\t" << it.second.fSize << "\t" << it.second.fModTime << "\t"
+					<< (it.second.fValid ? 1 : 0) << "\t";
+			bool firstTree = true;
+			for(auto &tree : it.second.fTrees){
+				if(!firstTree) fd << ";";
+				fd << tree.first << "=" << tree.second.fEntries << "=";
+				for(unsigned int i=0; i<tree.second.fBranches.size(); ++i)
+					fd << (i>0 ? "," : "") << tree.second.fBranches[i];
+				firstTree = false;
+			}
+			fd << std::endl;
+		}
+		fd.close();
+
+		if(rename(tmpName.Data(), fFileName.Data())!=0){
+			std::cout << "Unable to rename " << tmpName << " to " << fFileName << std::endl;
+			success = false;
+		}
+	}
+
+	if(lockFD>=0){
+		flock(lockFD, LOCK_UN);
+		close(lockFD);
+	}
+	if(success) fModified = false;
+	return success;
+}
+
+const FileCatalog::FileRecord* FileCatalog::Find(TString fileName) {
+	/// \MemberDescr
+	/// \param fileName : Path to the file
+	/// \return Record of the file, nullptr if not in the catalog or if the file changed
+	/// \EndMemberDescr
+
+	if(!IsEnabled()) return nullptr;
+	auto it = fRecords.find(fileName);
+	//Not opened by a previous job: checked again
+	if(it==fRecords.end() || !it->second.fValid) return nullptr;
+
+	Long64_t size;
+	Long_t modTime;
+	if(!GetFileInfo(fileName, size, modTime) || size!=it->second.fSize || modTime!=it->second.fModTime)
+		return nullptr;
+	++fNHits;
+	return &it->second;
+}
+
+const FileCatalog::FileRecord* FileCatalog::Scan(TString fileName) {
+	/// \MemberDescr
+	/// \param fileName : Path to the file
+	/// \return Record of the file, nullptr if the file cannot be checked (e.g. no size and
+	/// modification time available)
+	///
+	/// Open the file, read the number of entries and the branches of each tree and add
+	/// the record to the catalog.
+	/// \EndMemberDescr
+
+	if(!IsEnabled()) return nullptr;
+
+	FileRecord record;
+	if(!GetFileInfo(fileName, record.fSize, record.fModTime)) return nullptr;
+
+	TFile *fd = TFile::Open(fileName, "READ");
+	record.fValid = fd && !fd->IsZombie();
+	if(record.fValid){
+		TList *keys = fd->GetListOfKeys();
+		for(int i=0; i<keys->GetEntries(); ++i){
+			TKey *key = (TKey*)keys->At(i);
+			if(TString(key->GetClassName()).CompareTo("TTree")!=0) continue;
+			if(record.fTrees.count(key->GetName())>0) continue; //Older cycle
+			TTree *tree = (TTree*)fd->Get(key->GetName());
+			if(!tree) continue;
+			TreeInfo info;
+			info.fEntries = tree->GetEntries();
+			TObjArray *branches = tree->GetListOfBranches();
+			for(int j=0; j<branches->GetEntriesFast(); ++j)
+				info.fBranches.push_back(((TBranch*)branches->UncheckedAt(j))->GetName());
+			record.fTrees[key->GetName()] = info;
+		}
+		fd->Close();
+	}
+	if(fd) delete fd;
+
+	fRecords[fileName] = record;
+	fModified = true;
+	++fNScanned;
+	return &fRecords[fileName];
+}
+
+bool FileCatalog::ReadRecords(TString fileName, NA62Analysis::NA62Map<TString, FileRecord>::type &records) {
+	/// \MemberDescr
+	/// \param fileName : Path to the catalog file
+	/// \param records : Filled with the records of the catalog file
+	/// \return False if the catalog file exists but cannot be read
+	///
+	/// Each line contains: path size modTime valid tree=entries=branch,branch;tree=...
+	/// (tab separated).
+	/// \EndMemberDescr
+
+	if(gSystem->AccessPathName(fileName)) return true;
+
+	std::ifstream fd(fileName.Data());
+	if(!fd.is_open()){
+		std::cout << "Unable to read the file catalog " << fileName << std::endl;
+		return false;
+	}
+
+	TString line;
+	while(line.ReadLine(fd)){
+		std::vector<TString> fields;
+		Ssiz_t start = 0, pos;
+		while((pos = line.Index("\t", start))!=kNPOS){
+			fields.push_back(line(start, pos-start));
+			start = pos+1;
+		}
+		fields.push_back(line(start, line.Length()-start));
+		if(fields.size()<5 || !fields[1].IsDec() || !fields[2].IsDec()) continue;
+
+		FileRecord record;
+		record.fSize = fields[1].Atoll();
+		record.fModTime = fields[2].Atoll();
+		record.fValid = fields[3].CompareTo("1")==0;
+
+		TObjArray *trees = fields[4].Tokenize(";");
+		for(int i=0; i<trees->GetEntries(); ++i){
+			TObjArray *treeFields = ((TObjString*)trees->At(i))->GetString().Tokenize("=");
+			if(treeFields->GetEntries()>=2){
+				TreeInfo info;
+				info.fEntries = ((TObjString*)treeFields->At(1))->GetString().Atoll();
+				if(treeFields->GetEntries()>2){
+					TObjArray *branches = ((TObjString*)treeFields->At(2))->GetString().Tokenize(",");
+					for(int j=0; j<branches->GetEntries(); ++j)
+						info.fBranches.push_back(((TObjString*)branches->At(j))->GetString());
+					delete branches;
+				}
+				record.fTrees[((TObjString*)treeFields->At(0))->GetString()] = info;
+			}
+			delete treeFields;
+		}
+		delete trees;
+		records[fields[0]] = record;
+	}
+	fd.close();
+	return true;
+}
+
+void FileCatalog::PrintSummary() const {
+	/// \MemberDescr
+	/// Print the number of files found in the catalog and scanned
+	/// \EndMemberDescr
+
+	if(!IsEnabled()) return;
+	std::cout << "File catalog: " << fNHits << " files found, " << fNScanned << " files scanned" << std::endl;
+}
+
+bool FileCatalog::GetFileInfo(TString fileName, Long64_t &size, Long_t &modTime) {
+	/// \MemberDescr
+	/// \param fileName : Path to the file
+	/// \param size : Filled with the size of the file
+	/// \param modTime : Filled with the modification time of the file
+	/// \return False if the information is not available
+	/// \EndMemberDescr
+
+	FileStat_t stat;
+	if(gSystem->GetPathInfo(fileName, stat)!=0) return false;
+	size = stat.fSize;
+	modTime = stat.fMtime;
+	return true;
+}
+
+Long64_t FileCatalog::FileRecord::GetEntries(TString treeName) const {
+	/// \MemberDescr
+	/// \param treeName : Name of the tree
+	/// \return Number of entries of the tree, -1 if the tree is not in the file
+	/// \EndMemberDescr
+
+	auto it = fTrees.find(treeName);
+	if(it==fTrees.end()) return -1;
+	return it->second.fEntries;
+}
+
+bool FileCatalog::FileRecord::HasBranch(TString treeName, TString branchName) const {
+	/// \MemberDescr
+	/// \param treeName : Name of the tree
+	/// \param branchName : Name of the top-level branch
+	/// \return True if the tree exists and contains the branch
+	/// \EndMemberDescr
+
+	auto it = fTrees.find(treeName);
+	if(it==fTrees.end()) return false;
+	for(auto branch : it->second.fBranches){
+		if(branch.CompareTo(branchName)==0) return true;
+	}
+	return false;
+}
+
+} /* namespace Core */
+} /* namespace NA62Analysis */
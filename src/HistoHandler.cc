@@ -589,6 +589,40 @@ void HistoHandler::SaveAllPlots(TString analyzerName){
 	}
 }
 
+void HistoHandler::WriteSnapshot(TDirectory* target) const{
+	/// \MemberDescr
+	/// \param target : Directory where the snapshot is written
+	///
+	/// Write the current content of the booked graphs in the target directory. The booked
+	/// histograms are attached to the output file and are part of IOHandler::WriteSnapshot.
+	/// \EndMemberDescr
+
+	for(auto it : fGraph) target->WriteTObject(it.second, it.first);
+}
+
+void HistoHandler::RestoreSnapshot(TDirectory* source){
+	/// \MemberDescr
+	/// \param source : Directory containing a snapshot written by WriteSnapshot
+	///
+	/// Replace the points of the booked graphs by the points of the graphs with the same
+	/// name in the snapshot (without their errors), and restore the number of points used
+	/// by FillHisto.
+	/// \EndMemberDescr
+
+	for(auto it : fGraph){
+		TObject *saved = source->Get(it.first);
+		if(!saved) continue;
+		if(saved->InheritsFrom(TGraph::Class())){
+			TGraph *savedGraph = static_cast<TGraph*>(saved);
+			it.second->Set(0);
+			for(int i=0; i<savedGraph->GetN(); ++i) it.second->SetPoint(i, savedGraph->GetX()[i], savedGraph->GetY()[i]);
+			//FillHisto increments the counter before setting the point
+			fPoint[it.first] = savedGraph->GetN()>0 ? savedGraph->GetN()-1 : 0;
+		}
+		delete saved;
+	}
+}
+
 void HistoHandler::SetUpdateInterval(int interval){
 	/// \MemberDescr
 	/// \param interval : Events interval at which the plots should be updated
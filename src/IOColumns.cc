@@ -0,0 +1,194 @@
+/*
+ * IOColumns.cc
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ncl
+ */
+
+#include "IOColumns.hh"
+
+#include <iostream>
+#include <algorithm>
+
+#include <TFile.h>
+#include <TObjString.h>
+
+#include "StringBalancedTable.hh"
+#include "TraceRecorder.hh"
+
+namespace NA62Analysis {
+namespace Core {
+
+IOColumns::IOColumns():
+	IOHandler("IOColumns"),
+	fCurrentReader(-1),
+	fCurrentLocalEvent(-1),
+	fNewFileOpened(false)
+{
+	/// \MemberDescr
+	/// Constructor
+	/// \EndMemberDescr
+	fIOType = IOHandlerType::kCOLUMNS;
+}
+
+IOColumns::~IOColumns() {
+	/// \MemberDescr
+	/// Destructor. Unmap the files.
+	/// \EndMemberDescr
+
+	for(auto reader : fReaders) delete reader;
+}
+
+bool IOColumns::OpenInput(TString inFileName, int nFiles) {
+	/// \MemberDescr
+	/// \param inFileName : Path to the input column file, or file containing a list of input column files
+	/// \param nFiles : Number of files to read
+	/// \return true in case of success. Else false
+	///
+	/// Map the input files and check that they contain the fields of the first file
+	/// \EndMemberDescr
+
+	if(fEntryListInput || fEventSelection.Length()>0 || fTagFile.Length()>0){
+		std::cout << noverbose() << "Entry lists, event selections and tag selections cannot be used with column files" << std::endl;
+		return false;
+	}
+
+	fIOTimeCount.Start();
+	bool ret = IOHandler::OpenInput(inFileName, nFiles);
+	if(!ret){
+		fIOTimeCount.Stop();
+		return false;
+	}
+
+	std::vector<TString> validFiles;
+	fOffsets.push_back(0);
+	for(auto fileName : fInputfiles){
+		ColumnReader *reader = new ColumnReader();
+		bool valid = reader->Open(fileName);
+		std::vector<int> indices;
+		if(valid && fReaders.size()==0){
+			for(unsigned int i=0; i<reader->GetNFields(); ++i){
+				fFieldNames.push_back(reader->GetFieldName(i));
+				indices.push_back(i);
+			}
+		}
+		else if(valid){
+			for(auto name : fFieldNames){
+				int index = reader->GetFieldIndex(name);
+				if(index<0){
+					std::cout << normal() << "Field " << name << " missing in " << fileName << std::endl;
+					valid = false;
+					break;
+				}
+				indices.push_back(index);
+			}
+		}
+		if(!valid){
+			FileSkipped(fileName);
+			delete reader;
+			continue;
+		}
+		validFiles.push_back(fileName);
+		fReaders.push_back(reader);
+		fFieldIndices.push_back(indices);
+		fOffsets.push_back(fOffsets.back()+reader->GetNEvents());
+	}
+	fInputfiles = validFiles;
+	fIOTimeCount.Stop();
+
+	if(fReaders.size()==0){
+		std::cout << noverbose() << "No valid column file in the input" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool IOColumns::CheckNewFileOpened() {
+	/// \MemberDescr
+	/// \return true if the current event is the first one read in a new file. false otherwise.
+	/// \EndMemberDescr
+
+	if(!fNewFileOpened) return false;
+	fNewFileOpened = false;
+
+	TString fileName = fInputfiles[fCurrentFileNumber];
+	std::cout << normal() << "Opening file " << fCurrentFileNumber << ":" << fileName << std::endl;
+	TraceRecorder::GetInstance()->Instant("NewFile", "IO", fileName);
+
+	//Print fileName in the output file for future reference
+	MkOutputDir("InputFiles");
+	gFile->cd("InputFiles");
+	TObjString(fileName).Write();
+	gFile->cd();
+	return true;
+}
+
+bool IOColumns::LoadEvent(Long64_t iEvent) {
+	/// \MemberDescr
+	/// \param iEvent : Index of the event
+	/// \return false if the event does not exist
+	///
+	/// Select the file and the position of the event. Nothing is read before the values
+	/// are accessed.
+	/// \EndMemberDescr
+
+	if(fReaders.size()==0 || iEvent<0 || iEvent>=fOffsets.back()) return false;
+
+	if(fCurrentReader<0 || iEvent<fOffsets[fCurrentReader] || iEvent>=fOffsets[fCurrentReader+1]){
+		int reader = std::upper_bound(fOffsets.begin(), fOffsets.end(), iEvent) - fOffsets.begin() - 1;
+		if(reader!=fCurrentReader){
+			fCurrentReader = reader;
+			fCurrentFileNumber = reader;
+			fNewFileOpened = true;
+		}
+	}
+	fCurrentLocalEvent = iEvent - fOffsets[fCurrentReader];
+	return true;
+}
+
+Long64_t IOColumns::GetNEvents() {
+	/// \MemberDescr
+	/// \return Total number of events in the input files
+	/// \EndMemberDescr
+
+	return fOffsets.size()>0 ? fOffsets.back() : 0;
+}
+
+int IOColumns::GetFieldIndex(TString name) const {
+	/// \MemberDescr
+	/// \param name : Name of the field (Tree:Branch.member)
+	/// \return Index of the field, -1 if not available
+	/// \EndMemberDescr
+
+	for(unsigned int i=0; i<fFieldNames.size(); ++i){
+		if(fFieldNames[i].CompareTo(name)==0) return i;
+	}
+	return -1;
+}
+
+ColumnView IOColumns::GetValues(int field) const {
+	/// \MemberDescr
+	/// \param field : Index of the field (see GetFieldIndex)
+	/// \return View of the values of the field for the current event
+	/// \EndMemberDescr
+
+	if(field<0 || field>=(int)fFieldNames.size() || fCurrentReader<0) return ColumnView();
+	return fReaders[fCurrentReader]->GetValues(fFieldIndices[fCurrentReader][field], fCurrentLocalEvent);
+}
+
+void IOColumns::PrintInitSummary() const {
+	/// \MemberDescr
+	/// Print the summary after initialization
+	/// \EndMemberDescr
+
+	IOHandler::PrintInitSummary();
+
+	StringBalancedTable fieldTable("List of available columns");
+	for(auto name : fFieldNames) fieldTable << name;
+	fieldTable.Print("\t");
+	std::cout << "\t" << fReaders.size() << " column files, "
+			<< (fOffsets.size()>0 ? fOffsets.back() : 0) << " events" << std::endl;
+}
+
+} /* namespace Core */
+} /* namespace NA62Analysis */
@@ -16,10 +16,20 @@
 #include <TSystem.h>
 #include <TThread.h>
 #include <TRegexp.h>
+#include <TEntryList.h>
+#include <TList.h>
+#include <TH1.h>
+#include <TGraph.h>
 
 #include "SvnRevision.hh"
 #include "ConfigSettings.hh"
 #include "TermManip.hh"
+#include "TraceRecorder.hh"
+#include "OutputTreeSettings.hh"
+#include "EventIndex.hh"
+#include "StagingCache.hh"
+#include "EventTags.hh"
+#include "HistoHandler.hh"
 
 namespace NA62Analysis {
 namespace Core {
@@ -27,11 +37,14 @@ namespace Core {
 IOHandler::IOHandler():
 	fContinuousReading(false),
 	fFastStart(false),
+	fEntryListInput(false),
 	fSignalExit(false),
 	fIOType(IOHandlerType::kNOIO),
 	fCurrentFileNumber(-1),
 	fOutFile(0),
 	fCurrentFile(NULL),
+	fEntryList(nullptr),
+	fStagingCache(nullptr),
 	fGraphicalMutex(NULL)
 {
 	/// \MemberDescr
@@ -44,11 +57,14 @@ IOHandler::IOHandler(std::string name):
 	Verbose(name),
 	fContinuousReading(false),
 	fFastStart(false),
+	fEntryListInput(false),
 	fSignalExit(false),
 	fIOType(IOHandlerType::kNOIO),
 	fCurrentFileNumber(-1),
 	fOutFile(0),
 	fCurrentFile(NULL),
+	fEntryList(nullptr),
+	fStagingCache(nullptr),
 	fGraphicalMutex(NULL)
 {
 	/// \MemberDescr
@@ -63,6 +79,7 @@ IOHandler::IOHandler(const IOHandler& c):
 	Verbose(c),
 	fContinuousReading(false),
 	fFastStart(c.fFastStart),
+	fEntryListInput(c.fEntryListInput),
 	fSignalExit(false),
 	fIOType(c.GetIOType()),
 	fCurrentFileNumber(c.fCurrentFileNumber),
@@ -70,6 +87,12 @@ IOHandler::IOHandler(const IOHandler& c):
 	fOutFileName(c.fOutFileName),
 	fCurrentDir(c.fCurrentDir),
 	fCurrentFile(c.fCurrentFile),
+	fEntryList(c.fEntryList ? new TEntryList(*c.fEntryList) : nullptr),
+	fEventSelection(c.fEventSelection),
+	fTagFile(c.fTagFile),
+	fTagExpression(c.fTagExpression),
+	fStagingCache(nullptr),
+	fStagedFiles(c.fStagedFiles),
 	fGraphicalMutex(c.fGraphicalMutex)
 {
 	/// \MemberDescr
@@ -85,6 +108,8 @@ IOHandler::~IOHandler(){
 	/// \EndMemberDescr
 
 	free(fCurrentDir);
+	if(fEntryList) delete fEntryList;
+	if(fStagingCache) delete fStagingCache;
 	if(fSkippedFD.is_open()){
 		fSkippedFD.close();
 	}
@@ -280,6 +305,7 @@ void IOHandler::NewFileOpened(int index, TFile* currFile){
 		}
 	}
 	std::cout << normal() << "Opening file " << index << ":" << currFile->GetName() << std::endl;
+	TraceRecorder::GetInstance()->Instant("NewFile", "IO", currFile->GetName());
 	fCurrentFileNumber = index;
 	fCurrentFile = currFile;
 
@@ -331,6 +357,25 @@ bool IOHandler::OpenInput(TString inFileName, int nFiles){
 		std::cout << noverbose() << "No input file specified" << std::endl;
 		return false;
 	}
+	if(fTagFile.Length()>0 && (fEntryListInput || fEventSelection.Length()>0)){
+		std::cout << noverbose() << "Tag selections cannot be combined with entry lists and event selections" << std::endl;
+		return false;
+	}
+	if(fEntryListInput){
+		if(fContinuousReading){
+			std::cout << standard() << "Error: Continuous reading cannot be used with an entry list... Aborting" << std::endl;
+			raise(SIGABRT);
+		}
+		return ReadEntryList(inFileName, nFiles);
+	}
+	if(fEventSelection.Length()>0 && fContinuousReading){
+		std::cout << standard() << "Error: Continuous reading cannot be used with an event selection... Aborting" << std::endl;
+		raise(SIGABRT);
+	}
+	if(fTagFile.Length()>0 && fContinuousReading){
+		std::cout << standard() << "Error: Continuous reading cannot be used with a tag selection... Aborting" << std::endl;
+		raise(SIGABRT);
+	}
 	if(nFiles == 0){
 		if(fContinuousReading){
 			// Continuous reading needs a list of files, not a single file
@@ -399,6 +444,153 @@ bool IOHandler::OpenInput(TString inFileName, int nFiles){
 		inputList.close();
 		if(fContinuousReading) unlink(inFileName.Data());
 	}
+	bool selected = true;
+	if(fEventSelection.Length()>0) selected = SelectEvents();
+	else if(fTagFile.Length()>0) selected = SelectTaggedEvents();
+	//After the selection: the event index and the tag files know the original paths
+	if(selected && Configuration::ConfigSettings::global::fStagingDir.length()>0 && !fContinuousReading)
+		StageInputFiles();
+	return selected;
+}
+
+void IOHandler::StageInputFiles(){
+	/// \MemberDescr
+	/// Replace the remote input files already staged by their local copy and start copying
+	/// the other ones in background for the next runs (see StagingCache). The remote path of
+	/// each copy is kept (see GetOriginalFileName).
+	/// \EndMemberDescr
+
+	if(!fStagingCache)
+		fStagingCache = new StagingCache(Configuration::ConfigSettings::global::fStagingDir,
+				(Long64_t)Configuration::ConfigSettings::global::fStagingSize*1048576,
+				Configuration::ConfigSettings::global::fStagingRemote,
+				Configuration::ConfigSettings::global::fStagingVerify);
+	fIOTimeCount.Start();
+	for(auto &fileName : fInputfiles){
+		TString localName = fStagingCache->Resolve(fileName);
+		if(localName.CompareTo(fileName)!=0) fStagedFiles[localName] = fileName;
+		fileName = localName;
+	}
+	fIOTimeCount.Stop();
+	fStagingCache->Start();
+}
+
+bool IOHandler::SelectEvents(){
+	/// \MemberDescr
+	/// \return true if at least one event is selected, else false
+	///
+	/// Update the event index with the input files and replace the input files by the
+	/// entry list of the events listed in the selection file. The events are then read
+	/// as in the entry list input mode.
+	/// \EndMemberDescr
+
+	EventIndex index;
+	fIOTimeCount.Start();
+	index.Load(Configuration::ConfigSettings::global::fEventIndex);
+	bool indexed = index.Update(fInputfiles);
+	index.Save();
+	fIOTimeCount.Stop();
+	if(!indexed){
+		std::cout << noverbose() << "No input file could be indexed" << std::endl;
+		return false;
+	}
+
+	TEntryList *list = index.Select(fEventSelection, fInputfiles);
+	if(!list) return false;
+	if(list->GetN()==0){
+		std::cout << noverbose() << "None of the events of " << fEventSelection << " found in the input files" << std::endl;
+		delete list;
+		return false;
+	}
+	UseSelectedEvents(list);
+	return true;
+}
+
+bool IOHandler::SelectTaggedEvents(){
+	/// \MemberDescr
+	/// \return true if at least one event is selected, else false
+	///
+	/// Replace the input files by the entry list of the events of the tag file matching the
+	/// tag expression (see EventTags). The events are then read as in the entry list input mode.
+	/// \EndMemberDescr
+
+	fIOTimeCount.Start();
+	TEntryList *list = EventTags::Select(fTagFile, fTagExpression, fInputfiles);
+	fIOTimeCount.Stop();
+	if(!list) return false;
+	if(list->GetN()==0){
+		std::cout << noverbose() << "None of the events of the input files matches " << fTagExpression << std::endl;
+		delete list;
+		return false;
+	}
+	UseSelectedEvents(list);
+	return true;
+}
+
+void IOHandler::UseSelectedEvents(TEntryList *list){
+	/// \MemberDescr
+	/// \param list : Entry list of the selected events (ownership is taken)
+	///
+	/// Read only the events of the entry list: the input files are replaced by the files
+	/// of the sub-lists.
+	/// \EndMemberDescr
+
+	if(fEntryList) delete fEntryList;
+	fEntryList = list;
+
+	fInputfiles.clear();
+	TList *subLists = fEntryList->GetLists();
+	int nLists = subLists ? subLists->GetEntries() : 1;
+	for(int i=0; i<nLists; i++)
+		fInputfiles.push_back(subLists ? ((TEntryList*)subLists->At(i))->GetFileName() : fEntryList->GetFileName());
+	std::cout << normal() << "Reading " << fEntryList->GetN() << " selected events from "
+			<< fInputfiles.size() << " files" << std::endl;
+}
+
+bool IOHandler::ReadEntryList(TString fileName, int nFiles){
+	/// \MemberDescr
+	/// \param fileName : Path to the ROOT file containing the entry list
+	/// \param nFiles : Maximum number of files to read from the list (all if <=0)
+	/// \return true if success, else false
+	///
+	/// Read the TEntryList "EntryList" written by an entry list skim and register
+	/// the files it refers to as input files.
+	/// \EndMemberDescr
+
+	fIOTimeCount.Start();
+	TFile *fd = TFile::Open(fileName, "READ");
+	if(!fd || fd->IsZombie()){
+		fIOTimeCount.Stop();
+		std::cout << noverbose() << "Unable to open the entry list file " << fileName << std::endl;
+		if(fd) delete fd;
+		return false;
+	}
+	TEntryList *list = (TEntryList*)fd->Get("EntryList");
+	if(!list){
+		fIOTimeCount.Stop();
+		std::cout << noverbose() << "No entry list found in " << fileName << std::endl;
+		fd->Close();
+		delete fd;
+		return false;
+	}
+	fEntryList = (TEntryList*)list->Clone();
+	fEntryList->SetDirectory(0);
+	fd->Close();
+	delete fd;
+	fIOTimeCount.Stop();
+
+	TList *subLists = fEntryList->GetLists();
+	int nLists = subLists ? subLists->GetEntries() : 1;
+	for(int i=0; i<nLists && (nFiles<=0 || i<nFiles); i++){
+		TString inputFileName = subLists ? ((TEntryList*)subLists->At(i))->GetFileName() : fEntryList->GetFileName();
+		std::cout << normal() << "Adding file " << inputFileName << std::endl;
+		fInputfiles.push_back(inputFileName);
+	}
+	if(fInputfiles.size()==0){
+		std::cout << noverbose() << "No input file in the entry list " << fileName << std::endl;
+		return false;
+	}
+	std::cout << normal() << "Reading " << fEntryList->GetN() << " entries from the entry list " << fileName << std::endl;
 	return true;
 }
 
@@ -414,10 +606,13 @@ bool IOHandler::OpenOutput(TString outFileName){
 	fOutFileName = outFileName;
 	fOutFileName.ReplaceAll(".root", "");
 	fIOTimeCount.Start();
+	TraceRecorder::GetInstance()->Begin("OpenOutput", "Output");
 	fOutFile = new TFile(outFileName, "RECREATE");
+	TraceRecorder::GetInstance()->End("OpenOutput", "Output");
 	fIOTimeCount.Stop();
 
 	if(!fOutFile) return false;
+	OutputTreeSettings::GetInstance()->ApplyToFile(fOutFile);
 	return true;
 }
 
@@ -428,12 +623,22 @@ void IOHandler::PrintInitSummary() const{
 	/// \EndMemberDescr
 }
 
+void IOHandler::PrintIOSummary() const{
+	/// \MemberDescr
+	///
+	/// Print the summary of the IO at the end of the processing
+	/// \EndMemberDescr
+}
+
 void IOHandler::FileSkipped(TString fileName) {
 	/// \MemberDescr
 	/// \param fileName: Name of the skipped file
 	///
-	/// File has been skipped for whatever reason. Notify it in the .skipped file
+	/// File has been skipped for whatever reason. Notify it in the .skipped file (once per file,
+	/// with the remote path of a staged copy)
 	/// \EndMemberDescr
+	fileName = GetOriginalFileName(fileName);
+	if(!fSkippedFiles.insert(fileName).second) return;
 	fIOTimeCount.Start();
 	if(!fSkippedFD.is_open()) fSkippedFD.open((Configuration::ConfigSettings::global::fSkippedName+".skipped").data(), std::ios::out);
 	if(!fSkippedFD.is_open()) std::cout << normal() << "Unable to open skipped file "
@@ -442,6 +647,27 @@ void IOHandler::FileSkipped(TString fileName) {
 	fIOTimeCount.Stop();
 }
 
+TString IOHandler::GetOriginalFileName(TString fileName) const {
+	/// \MemberDescr
+	/// \param fileName : Path of an input file
+	/// \return Remote path of the file if it is a staged copy (see StageInputFiles), else fileName
+	/// \EndMemberDescr
+
+	auto it = fStagedFiles.find(fileName);
+	if(it==fStagedFiles.end()) return fileName;
+	return it->second;
+}
+
+TString IOHandler::GetInputFileList() const {
+	/// \MemberDescr
+	/// \return Original path of each input file read, one per line
+	/// \EndMemberDescr
+
+	TString list;
+	for(auto fileName : fInputfiles) list += GetOriginalFileName(fileName) + "\n";
+	return list;
+}
+
 int IOHandler::ReadCurrentFileRevision() {
 	/// \MemberDescr
 	/// \return Revision number embedded in the input ROOT file or -1 if not found
@@ -515,9 +741,99 @@ void IOHandler::Finalise() {
 			FileSkipped(fInputfiles[i]);
 		}
 	}
+	if(fStagingCache){
+		fStagingCache->Stop();
+		fStagingCache->PrintSummary();
+	}
 	fOutFile->Purge();
 }
 
+void IOHandler::WriteSnapshot(TDirectory* target) const{
+	/// \MemberDescr
+	/// \param target : Directory where the snapshot is written
+	///
+	/// Write the current content of the histograms and graphs of the output file (top level
+	/// and analyzer directories) in the target directory. The graphs booked by the analyzers
+	/// are not attached to the output file: they are written in SnapshotGraphs/AnalyzerName.
+	/// \EndMemberDescr
+
+	if(!fOutFile) return;
+	TIter next(fOutFile->GetList());
+	while(TObject *obj = next()){
+		if(obj->InheritsFrom(TDirectory::Class())){
+			TDirectory *dir = static_cast<TDirectory*>(obj);
+			TDirectory *targetDir = target->GetDirectory(dir->GetName());
+			if(!targetDir) targetDir = target->mkdir(dir->GetName());
+			TIter nextInDir(dir->GetList());
+			while(TObject *dirObj = nextInDir()){
+				if(dirObj->InheritsFrom(TH1::Class()) || dirObj->InheritsFrom(TGraph::Class()))
+					targetDir->WriteTObject(dirObj);
+			}
+		}
+		else if(obj->InheritsFrom(TH1::Class()) || obj->InheritsFrom(TGraph::Class()))
+			target->WriteTObject(obj);
+	}
+	if(fSnapshotHistos.size()==0) return;
+	TDirectory *graphDir = target->GetDirectory("SnapshotGraphs");
+	if(!graphDir) graphDir = target->mkdir("SnapshotGraphs");
+	for(auto it : fSnapshotHistos){
+		TDirectory *targetDir = graphDir->GetDirectory(it.first);
+		if(!targetDir) targetDir = graphDir->mkdir(it.first);
+		it.second->WriteSnapshot(targetDir);
+	}
+}
+
+void IOHandler::RestoreSnapshot(TDirectory* source){
+	/// \MemberDescr
+	/// \param source : Directory containing a snapshot written by WriteSnapshot
+	///
+	/// Replace the content of the histograms and graphs of the output file by the content
+	/// of the objects with the same name and directory in the snapshot, then the graphs
+	/// booked by the analyzers. The points of the graphs are restored without their errors.
+	/// \EndMemberDescr
+
+	if(!fOutFile) return;
+	TIter next(source->GetListOfKeys());
+	while(TKey *key = (TKey*)next()){
+		TDirectory *outDir = fOutFile;
+		TObject *saved = key->ReadObj();
+		std::vector<TObject*> objects;
+		if(saved->InheritsFrom(TDirectory::Class())){
+			outDir = fOutFile->GetDirectory(key->GetName());
+			if(!outDir) continue;
+			TIter nextInDir(static_cast<TDirectory*>(saved)->GetListOfKeys());
+			while(TKey *dirKey = (TKey*)nextInDir()) objects.push_back(dirKey->ReadObj());
+		}
+		else objects.push_back(saved);
+
+		for(auto obj : objects){
+			TObject *current = outDir->GetList()->FindObject(obj->GetName());
+			if(!current || current->IsA()!=obj->IsA()){
+				std::cout << normal() << "Unable to restore " << obj->GetName() << ": not found in the output file" << std::endl;
+			}
+			else if(current->InheritsFrom(TH1::Class())){
+				static_cast<TH1*>(current)->Reset();
+				static_cast<TH1*>(current)->Add(static_cast<TH1*>(obj));
+			}
+			else if(current->InheritsFrom(TGraph::Class())){
+				TGraph *graph = static_cast<TGraph*>(current);
+				TGraph *savedGraph = static_cast<TGraph*>(obj);
+				graph->Set(0);
+				for(int i=0; i<savedGraph->GetN(); ++i) graph->SetPoint(i, savedGraph->GetX()[i], savedGraph->GetY()[i]);
+			}
+			if(obj!=saved) delete obj;
+		}
+		if(!saved->InheritsFrom(TDirectory::Class())) delete saved;
+	}
+	//Not in the output file: skipped above as unknown directory
+	TDirectory *graphDir = source->GetDirectory("SnapshotGraphs");
+	if(!graphDir) return;
+	for(auto it : fSnapshotHistos){
+		TDirectory *sourceDir = graphDir->GetDirectory(it.first);
+		if(sourceDir) it.second->RestoreSnapshot(sourceDir);
+	}
+}
+
 bool IOHandler::IsLastFileReached() const {
 	/// \MemberDescr
 	/// \return True if the current file is the last file of the list
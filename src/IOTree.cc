@@ -10,12 +10,26 @@
 #include <signal.h>
 #include <iostream>
 #include <sstream>
+#include <algorithm>
 
 #include <TChain.h>
+#include <TChainElement.h>
+#include <TBranch.h>
+#include <TBranchElement.h>
+#include <TLeaf.h>
+#include <TFile.h>
 #include <TKey.h>
+#include <TObjString.h>
 #include <TTreeCache.h>
+#include <TEntryList.h>
+#include <TClass.h>
 
 #include "StringBalancedTable.hh"
+#include "StringTable.hh"
+#include "ConfigSettings.hh"
+#include "TraceRecorder.hh"
+#include "OutputWriter.hh"
+#include "OutputTreeSettings.hh"
 
 namespace NA62Analysis {
 namespace Core {
@@ -25,6 +39,32 @@ IOTree::IOTree():
 	fMCTruthTree(0),
 	fRawHeaderTree(0),
 	fReferenceTree(0),
+	fFastSkim(Configuration::ConfigSettings::global::fFastSkim),
+	fCurrentEntry(-1),
+	fNExported(0),
+	fNExportedFast(0),
+	fDeferredEvents(0),
+	fDeferredOffset(0),
+	fDeferredFileEntries(0),
+	fDeferredTreeNumber(-1),
+	fEntryListExport(false),
+	fExportEntryList(nullptr),
+	fEntryListEvents(0),
+	fRollSize((Long64_t)Configuration::ConfigSettings::global::fRollSize*1048576),
+	fRollBursts(Configuration::ConfigSettings::global::fRollBursts),
+	fRollHistograms(Configuration::ConfigSettings::global::fRollHistograms),
+	fRollFile(nullptr),
+	fRollIndex(0),
+	fRollBurstCount(0),
+	fRollEvents(0),
+	fInputScanner(nullptr),
+	fStreaming(false),
+	fStreamFile(-1),
+	fStreamEntries(-1),
+	fEventCache(nullptr),
+	fColumnWriter(nullptr),
+	fBranchUsage(nullptr),
+	fBranchProfile(nullptr),
 	fWithMC(false),
 	fWithRawHeader(false),
 	fAllowNonExisting(false)
@@ -33,6 +73,9 @@ IOTree::IOTree():
 	/// Constructor
 	/// \EndMemberDescr
 	fIOType = IOHandlerType::kTREE;
+	SetSkimBranches(Configuration::ConfigSettings::global::fSkimBranches);
+	for(auto &it : Configuration::ConfigSettings::streams::fStreams)
+		AddExportStream(it.first, it.second);
 }
 
 IOTree::IOTree(const IOTree &c):
@@ -44,6 +87,39 @@ IOTree::IOTree(const IOTree &c):
 	fRawHeaderTree(c.fRawHeaderTree),
 	fReferenceTree(c.fReferenceTree),
 	fExportTrees(c.fExportTrees),
+	fSkimBranches(c.fSkimBranches),
+	fFastSkim(c.fFastSkim),
+	fCurrentEntry(c.fCurrentEntry),
+	fNExported(c.fNExported),
+	fNExportedFast(c.fNExportedFast),
+	fDeferredEvents(c.fDeferredEvents),
+	fDeferredOffset(c.fDeferredOffset),
+	fDeferredFileEntries(c.fDeferredFileEntries),
+	fDeferredTreeNumber(c.fDeferredTreeNumber),
+	fDeferredFileName(c.fDeferredFileName),
+	fEntryListExport(c.fEntryListExport),
+	fExportEntryList(nullptr),
+	fEntryListTrees(c.fEntryListTrees),
+	fEntryListStarts(c.fEntryListStarts),
+	fEntryListEvents(c.fEntryListEvents),
+	fEntryListOffsets(c.fEntryListOffsets),
+	fFriendFiles(c.fFriendFiles),
+	fFriendTrees(c.fFriendTrees),
+	fRollSize(c.fRollSize),
+	fRollBursts(c.fRollBursts),
+	fRollHistograms(c.fRollHistograms),
+	fRollFile(nullptr),
+	fRollIndex(c.fRollIndex),
+	fRollBurstCount(c.fRollBurstCount),
+	fRollEvents(0),
+	fInputScanner(nullptr),
+	fStreaming(c.fStreaming),
+	fStreamFile(-1),
+	fStreamEntries(-1),
+	fEventCache(nullptr),
+	fColumnWriter(nullptr),
+	fBranchUsage(nullptr),
+	fBranchProfile(nullptr),
 	fWithMC(c.fWithMC),
 	fWithRawHeader(c.fWithRawHeader),
 	fAllowNonExisting(false)
@@ -62,6 +138,12 @@ IOTree::~IOTree() {
 	/// Destructor
 	/// \EndMemberDescr
 
+	if(fInputScanner) delete fInputScanner;
+	if(fEventCache) delete fEventCache;
+	if(fColumnWriter) delete fColumnWriter;
+	if(fBranchUsage) delete fBranchUsage;
+	if(fBranchProfile) delete fBranchProfile;
+	for(auto projection : fProjections) delete projection;
 	treeIterator itChain;
 	objectIterator itObject;
 	eventIterator itEvent;
@@ -81,6 +163,19 @@ IOTree::~IOTree() {
 		delete itObject->second;
 		fObject.erase(itObject);
 	}
+	if(fExportEntryList) delete fExportEntryList;
+	if(fRollFile){
+		fRollFile->Close();
+		delete fRollFile;
+	}
+	for(auto &it : fExportStreams){
+		if(it.second->fFile){
+			it.second->fFile->Close();
+			delete it.second->fFile;
+		}
+		if(it.second->fEntryList) delete it.second->fEntryList;
+		delete it.second;
+	}
 }
 
 
@@ -168,12 +263,224 @@ bool IOTree::RequestTree(TString treeName, TString branchName, TString className
 	return true;
 }
 
+void IOTree::RequestProjection(TString treeName, TString branchName, TString member){
+	/// \MemberDescr
+	/// \param treeName : Name of the TTree (Reco, Digis, MC, ...)
+	/// \param branchName : Name of the top-level branch (detector name)
+	/// \param member : Name of the split sub-branch of the data member, relative to the branch
+	/// (e.g. fCandidates.fMomentum)
+	///
+	/// Request the values of a data member of a branch as an array (see GetProjection). If the
+	/// branch itself is not requested, only the split sub-branches of the projected members
+	/// are read from the file.
+	/// \EndMemberDescr
+
+	if(GetProjection(treeName, branchName, member)) return;
+	std::cout << normal() << "Requesting projection " << treeName << ":" << branchName << "." << member << std::endl;
+	if(fTree.count(treeName)==0)
+		fTree.insert(chainPair(treeName, new TChain(treeName)));
+
+	Projection *projection = new Projection;
+	projection->fTreeName = treeName;
+	projection->fBranchName = branchName;
+	projection->fMember = member;
+	projection->fTreeNumber = -1;
+	projection->fTop = nullptr;
+	projection->fBranch = nullptr;
+	projection->fLeaf = nullptr;
+	fProjections.push_back(projection);
+}
+
+const std::vector<double>* IOTree::GetProjection(TString treeName, TString branchName, TString member) const{
+	/// \MemberDescr
+	/// \param treeName : Name of the TTree
+	/// \param branchName : Name of the top-level branch
+	/// \param member : Name of the split sub-branch of the data member, relative to the branch
+	/// \return Values of the data member for the current event (one per element for members
+	/// of the objects of a TClonesArray), nullptr if not requested
+	/// \EndMemberDescr
+
+	for(auto projection : fProjections){
+		if(projection->fTreeName.CompareTo(treeName)==0 && projection->fBranchName.CompareTo(branchName)==0
+				&& projection->fMember.CompareTo(member)==0)
+			return &projection->fValues;
+	}
+	return nullptr;
+}
+
+void IOTree::SetColumnOutput(TString fileName, TString fieldList){
+	/// \MemberDescr
+	/// \param fileName : Path of the column file to write
+	/// \param fieldList : Comma separated list of data members to write (Tree:Branch.member, the
+	/// tree is Reco if not specified), in addition to the projections requested by the analyzers
+	///
+	/// Write the values of all the projections (see RequestProjection) of each processed event
+	/// in a column file (see ColumnFileHeader), which can then be read instead of the TTrees
+	/// with --columns.
+	/// \EndMemberDescr
+
+	fColumnFileName = fileName;
+	for(auto field : ParseBranchList(fieldList)){
+		TString treeName = "Reco";
+		Ssiz_t pos = field.Index(":");
+		if(pos!=kNPOS){
+			treeName = field(0, pos);
+			field = field(pos+1, field.Length()-pos-1);
+		}
+		pos = field.Index(".");
+		if(pos==kNPOS || pos==0 || pos==field.Length()-1){
+			std::cout << normal() << "Invalid column " << field << ": expected Tree:Branch.member" << std::endl;
+			continue;
+		}
+		RequestProjection(treeName, field(0, pos), field(pos+1, field.Length()-pos-1));
+	}
+}
+
+void IOTree::WriteColumns(){
+	/// \MemberDescr
+	/// Write the projections of the current event in the column file. The columns are the
+	/// projections requested when the first event is written.
+	/// \EndMemberDescr
+
+	if(fColumnFileName.Length()==0) return;
+	if(!fColumnWriter){
+		std::vector<TString> fields;
+		for(auto projection : fProjections)
+			fields.push_back(projection->fTreeName + ":" + projection->fBranchName + "." + projection->fMember);
+		fColumnWriter = new ColumnWriter();
+		if(fields.size()==0 || !fColumnWriter->Open(fColumnFileName, fields)){
+			std::cout << normal() << "No column file written: no valid projection requested" << std::endl;
+			fColumnFileName = "";
+			delete fColumnWriter;
+			fColumnWriter = nullptr;
+			return;
+		}
+		fColumnValues.resize(fProjections.size());
+		for(unsigned int i=0; i<fProjections.size(); ++i)
+			fColumnValues[i] = &fProjections[i]->fValues;
+	}
+	fIOTimeCount.Start();
+	fColumnWriter->Fill(fColumnValues);
+	fIOTimeCount.Stop();
+}
+
+void IOTree::CloseColumnOutput(){
+	/// \MemberDescr
+	/// Write the column file
+	/// \EndMemberDescr
+
+	if(!fColumnWriter) return;
+	fIOTimeCount.Start();
+	fColumnWriter->Close();
+	fIOTimeCount.Stop();
+	delete fColumnWriter;
+	fColumnWriter = nullptr;
+}
+
+bool IOTree::IsBranchRequested(TString treeName, TString branchName){
+	/// \MemberDescr
+	/// \param treeName : Name of the TTree
+	/// \param branchName : Name of the top-level branch
+	/// \return True if the whole branch is requested (detector event or object) and not pruned
+	/// \EndMemberDescr
+
+	std::pair<eventIterator, eventIterator> eventRange = fEvent.equal_range(branchName);
+	for(eventIterator it=eventRange.first; it!=eventRange.second; ++it){
+		if(it->second->fTreeName.CompareTo(treeName)==0 && !it->second->fPruned) return true;
+	}
+	std::pair<objectIterator, objectIterator> objectRange = fObject.equal_range(treeName);
+	for(objectIterator it=objectRange.first; it!=objectRange.second; ++it){
+		if(it->second->fBranchName.CompareTo(branchName)==0 && !it->second->fPruned) return true;
+	}
+	return false;
+}
+
+void IOTree::SetSubBranchStatus(TBranch *branch, bool status){
+	/// \MemberDescr
+	/// \param branch : Branch
+	/// \param status : Read or not the sub-branches
+	///
+	/// Set the status of all the sub-branches of the branch (recursively)
+	/// \EndMemberDescr
+
+	TObjArray *subBranches = branch->GetListOfBranches();
+	for(int i=0; i<subBranches->GetEntriesFast(); ++i){
+		TBranch *subBranch = (TBranch*)subBranches->UncheckedAt(i);
+		subBranch->SetStatus(status);
+		SetSubBranchStatus(subBranch, status);
+	}
+}
+
+void IOTree::LoadProjections(TChain *chain, TString treeName, Long64_t localEntry, int treeNumber){
+	/// \MemberDescr
+	/// \param chain : Chain of the tree
+	/// \param treeName : Name of the tree
+	/// \param localEntry : Entry in the current file
+	/// \param treeNumber : Index of the current file
+	///
+	/// Fill the values of the projected members of this tree. When a new file is opened, the
+	/// sub-branches are searched again and only the projected ones are enabled in the branches
+	/// which are not requested as a whole.
+	/// \EndMemberDescr
+
+	std::vector<TBranch*> readBranches;
+	for(auto projection : fProjections){
+		if(projection->fTreeName.CompareTo(treeName)!=0) continue;
+
+		if(projection->fTreeNumber!=treeNumber){
+			projection->fTreeNumber = treeNumber;
+			projection->fTop = nullptr;
+			projection->fBranch = nullptr;
+			projection->fLeaf = nullptr;
+			TTree *tree = chain->GetTree();
+			TBranch *top = tree ? tree->GetBranch(projection->fBranchName) : nullptr;
+			TBranch *branch = top ? top->FindBranch(projection->fMember) : nullptr;
+			if(top && !branch) branch = tree->GetBranch(projection->fBranchName + "." + projection->fMember);
+			if(!branch){
+				std::cout << normal() << "Unable to find " << projection->fBranchName << "." << projection->fMember
+						<< " in TTree " << treeName << std::endl;
+				continue;
+			}
+			if(!IsBranchRequested(treeName, projection->fBranchName)){
+				//The first projection of the branch in this file disables all its sub-branches
+				bool first = true;
+				for(auto other : fProjections){
+					if(other==projection) break;
+					if(other->fTop==top) first = false;
+				}
+				if(first) SetSubBranchStatus(top, false);
+				top->SetStatus(1);
+				branch->SetStatus(1);
+				//Counter of the TClonesArray containing the member
+				if(branch->InheritsFrom(TBranchElement::Class()) && ((TBranchElement*)branch)->GetBranchCount())
+					((TBranchElement*)branch)->GetBranchCount()->SetStatus(1);
+				projection->fTop = top;
+			}
+			projection->fBranch = branch;
+			projection->fLeaf = (TLeaf*)branch->GetListOfLeaves()->At(0);
+		}
+
+		projection->fValues.clear();
+		if(!projection->fLeaf) continue;
+		fIOTimeCount.Start();
+		if(projection->fTop && std::find(readBranches.begin(), readBranches.end(), projection->fTop)==readBranches.end()){
+			projection->fTop->GetEntry(localEntry);
+			readBranches.push_back(projection->fTop);
+		}
+		int nValues = projection->fBranch->InheritsFrom(TBranchElement::Class()) ?
+				((TBranchElement*)projection->fBranch)->GetNdata() : projection->fLeaf->GetLen();
+		for(int i=0; i<nValues; ++i) projection->fValues.push_back(projection->fLeaf->GetValue(i));
+		fIOTimeCount.Stop();
+	}
+}
+
 Long64_t IOTree::BranchTrees(Long64_t eventNb){
 	/// \MemberDescr
 	///	\param eventNb : Number of events that should be read in the tree
 	/// \return Number of events found in the Tree
 	///
-	/// Effectively read all the requested trees in the input file and branch them
+	/// Effectively read all the requested trees in the input file and branch them. The branches
+	/// never used according to the branch usage profile (--use-profile) are left disabled.
 	/// \EndMemberDescr
 
 	treeIterator it;
@@ -182,6 +489,17 @@ Long64_t IOTree::BranchTrees(Long64_t eventNb){
 
 	if(!fReferenceTree && fTree.size()>0) fReferenceTree = fTree.begin()->second;
 
+	for(auto friendTree : fFriendTrees){
+		it = fTree.find(friendTree.first);
+		if(it==fTree.end() || it->second==fReferenceTree) continue;
+		//Loaded with the same entry as the other chains in LoadEvent: not added as friend of
+		//the reference tree, which would read it a second time
+		std::cout << normal() << "Reading friend tree " << friendTree.first << " from " << friendTree.second << std::endl;
+		if(!fFastStart && it->second->GetEntries()!=fReferenceTree->GetEntries())
+			std::cout << normal() << "Warning: friend tree " << friendTree.first << " has " << it->second->GetEntries()
+				<< " entries while the input trees have " << fReferenceTree->GetEntries() << std::endl;
+	}
+
 	for(it=fTree.begin(); it!=fTree.end(); ++it){
 		TObjArray * arr = it->second->GetListOfBranches();
 		for(int i=0; i<arr->GetEntries(); ++i){
@@ -193,16 +511,35 @@ Long64_t IOTree::BranchTrees(Long64_t eventNb){
 	}
 	//Loop over all detector branches and branch them
 	for(ptr1=fEvent.begin(); ptr1!=fEvent.end(); ++ptr1){
+		if(fBranchProfile && !fBranchProfile->IsUsed(ptr1->second->fTreeName, ptr1->first)){
+			std::cout << normal() << "Branch " << ptr1->first << " of tree " << ptr1->second->fTreeName
+					<< " is never used according to the branch usage profile: not read" << std::endl;
+			ptr1->second->fPruned = true;
+			continue;
+		}
 		FindAndBranchTree(fTree.find(ptr1->second->fTreeName)->second, ptr1->first, ptr1->second->fEvent->ClassName(), &(ptr1->second->fEvent));
 	}
 
 	//Loop over all generic branches and branch them
 	for(ptr2=fObject.begin(); ptr2!=fObject.end(); ++ptr2){
+		if(fBranchProfile && !fBranchProfile->IsUsed(ptr2->first, ptr2->second->fBranchName)){
+			std::cout << normal() << "Branch " << ptr2->second->fBranchName << " of tree " << ptr2->first
+					<< " is never used according to the branch usage profile: not read" << std::endl;
+			ptr2->second->fPruned = true;
+			continue;
+		}
 		FindAndBranchTree(fTree.find(ptr2->first)->second, ptr2->second->fBranchName, ptr2->second->fClassName, &(ptr2->second->fObject));
 	}
 
 	if(eventNb==-1) eventNb = GetNEvents();
 
+	if(fEntryList){
+		//Only the listed entries are read: the cache would prefetch the whole clusters
+		eventNb = GetNEvents();
+		for(it=fTree.begin(); it!=fTree.end(); it++) it->second->SetCacheSize(0);
+		return eventNb;
+	}
+
 	for(it=fTree.begin(); it!=fTree.end(); it++){
 		it->second->SetCacheSize(400000000);
 		it->second->SetCacheLearnEntries(2);
@@ -241,6 +578,7 @@ TDetectorVEvent *IOTree::GetEvent(TString detName, TString outputName){
 		for(it=eventRange.first; it!=eventRange.second; ++it){
 				if(it->second->fTreeName.CompareTo(mainTree)==0){
 				std::cout << debug() << "Using branch " << it->second->fTreeName << std::endl;
+				if(fBranchUsage) RecordUsage(it->second->fUsageIndex, it->second->fTreeName, detName);
 				return it->second->fEvent;
 			}
 		}
@@ -277,6 +615,7 @@ void *IOTree::GetObject(TString name, TString branchName){
 			if( branchName.CompareTo("")==0 ||
 					it->second->fBranchName.CompareTo(branchName)==0){
 				std::cout << debug() << "Using branch " << it->second->fBranchName << std::endl;
+				if(fBranchUsage) RecordUsage(it->second->fUsageIndex, name, it->second->fBranchName);
 				return it->second->fObject;
 			}
 		}
@@ -298,35 +637,301 @@ bool IOTree::LoadEvent(Long64_t iEvent){
 	objectIterator itObj;
 
 	std::cout << debug() << "Loading event " << iEvent << "... " << std::endl;
+	if(fEntryList){
+		iEvent = GetEntryListEntry(iEvent);
+		if(iEvent<0) return false;
+	}
+	//The deferred exported events are no longer followed by the next entry, or the chains
+	//are about to leave their file: write them while it is still the one open in the chains
+	if(fDeferredEvents>0 && (iEvent!=fDeferredOffset+fDeferredEvents
+			|| iEvent>=fDeferredOffset+fDeferredFileEntries)) FlushDeferredEvents();
+	fCurrentEntry = iEvent;
+	Long64_t chainEntry = iEvent;
+	if(fStreaming){
+		chainEntry = GetStreamEntry(iEvent);
+		if(chainEntry<0) return false;
+	}
 	std::pair<eventIterator, eventIterator> eventRange;
 	std::pair<objectIterator, objectIterator> objectRange;
 
 	if (fGraphicalMutex->Lock() == 0) {
 		//Loop over all our trees
 		for (it = fTree.begin(); it != fTree.end(); it++) {
-			Long64_t localEntry = it->second->LoadTree(iEvent);
+			Long64_t localEntry = it->second->LoadTree(chainEntry);
+			int treeNumber = fStreaming ? fStreamFile : it->second->GetTreeNumber();
+			if(fBranchProfile && !fEntryList) TrainCache(it->second, it->first);
 			//Loop over all event and object branch and load the corresponding entry for each of them
 			for (itEvt = fEvent.begin(); itEvt != fEvent.end(); ++itEvt) {
-				if (it->second->GetBranch(itEvt->first)){
+				if (itEvt->second->fPruned) continue;
+				TBranch *branch = it->second->GetBranch(itEvt->first);
+				if (branch){
 					std::cout << debug() << "Getting entry " << iEvent << " for " << itEvt->first << std::endl;
 					fIOTimeCount.Start();
-					it->second->GetBranch(itEvt->first)->GetEntry(localEntry);
+					if(itEvt->second->fTreeName.CompareTo(it->first)==0)
+						itEvt->second->fStats.Read(branch, localEntry, treeNumber);
+					else
+						branch->GetEntry(localEntry);
 					fIOTimeCount.Stop();
 				}
 			}
 			for (itObj = fObject.begin(); itObj != fObject.end(); ++itObj) {
-				if (it->second->GetBranch(itObj->second->fBranchName)){
+				if (itObj->second->fPruned) continue;
+				TBranch *branch = it->second->GetBranch(itObj->second->fBranchName);
+				if (branch){
 					fIOTimeCount.Start();
-					it->second->GetBranch(itObj->second->fBranchName)->GetEntry(localEntry);
+					if(itObj->first.CompareTo(it->first)==0)
+						itObj->second->fStats.Read(branch, localEntry, treeNumber);
+					else
+						branch->GetEntry(localEntry);
 					fIOTimeCount.Stop();
 				}
 			}
+			if(fProjections.size()>0) LoadProjections(it->second, it->first, localEntry, treeNumber);
 		}
 		fGraphicalMutex->UnLock();
 	}
 	return true;
 }
 
+void IOTree::RecordUsage(int &usageIndex, TString treeName, TString branchName){
+	/// \MemberDescr
+	/// \param usageIndex : Index of the branch in the branch usage profile (set when first recorded)
+	/// \param treeName : Name of the tree
+	/// \param branchName : Name of the branch
+	///
+	/// Record that the branch has been retrieved in the current event (profiling)
+	/// \EndMemberDescr
+
+	if(usageIndex<0) usageIndex = fBranchUsage->AddBranch(treeName, branchName);
+	fBranchUsage->Accessed(usageIndex);
+}
+
+void IOTree::TrainCache(TChain *chain, TString treeName){
+	/// \MemberDescr
+	/// \param chain : Chain of the tree
+	/// \param treeName : Name of the tree
+	///
+	/// When a new file of the tree is loaded, add the branches used according to the branch
+	/// usage profile to its TTreeCache and stop the learning phase, so that the first entries
+	/// are already prefetched with exactly these branches. The learning phase continues if
+	/// projections are requested in this tree, to learn their sub-branches.
+	/// \EndMemberDescr
+
+	int treeNumber = fStreaming ? fStreamFile : chain->GetTreeNumber();
+	auto trained = fTrainedCache.find(treeName);
+	if(treeNumber<0 || (trained!=fTrainedCache.end() && trained->second==treeNumber)) return;
+	fTrainedCache[treeName] = treeNumber;
+
+	for(auto &it : fEvent){
+		if(!it.second->fPruned && it.second->fTreeName.CompareTo(treeName)==0 && chain->GetBranch(it.first))
+			chain->AddBranchToCache(it.first, kTRUE);
+	}
+	std::pair<objectIterator, objectIterator> objectRange = fObject.equal_range(treeName);
+	for(objectIterator it=objectRange.first; it!=objectRange.second; ++it){
+		if(!it->second->fPruned && chain->GetBranch(it->second->fBranchName))
+			chain->AddBranchToCache(it->second->fBranchName, kTRUE);
+	}
+	for(auto projection : fProjections){
+		if(projection->fTreeName.CompareTo(treeName)==0) return;
+	}
+	chain->StopCacheLearningPhase();
+}
+
+void IOTree::SetBranchProfileOutput(TString fileName){
+	/// \MemberDescr
+	/// \param fileName : Path of the branch usage profile to write
+	///
+	/// Record in which events each analyzer retrieves each requested branch and write the
+	/// profile (see BranchUsageProfile) at the end of the processing
+	/// \EndMemberDescr
+
+	fBranchUsageFile = fileName;
+	if(!fBranchUsage) fBranchUsage = new BranchUsageProfile();
+}
+
+bool IOTree::UseBranchProfile(TString fileName){
+	/// \MemberDescr
+	/// \param fileName : Path of a branch usage profile written with --profile-branches
+	/// \return False if the profile cannot be read
+	///
+	/// The requested branches never used according to the profile are not read, and the
+	/// TTreeCache is trained with the used branches only. Must be called before BranchTrees.
+	/// \EndMemberDescr
+
+	BranchUsageProfile *profile = new BranchUsageProfile();
+	if(!profile->Load(fileName)){
+		delete profile;
+		return false;
+	}
+	if(fBranchProfile) delete fBranchProfile;
+	fBranchProfile = profile;
+	return true;
+}
+
+void IOTree::WriteBranchUsage(){
+	/// \MemberDescr
+	/// Print and write the branch usage profile, including the requested branches that were
+	/// never retrieved
+	/// \EndMemberDescr
+
+	if(!fBranchUsage) return;
+	for(auto &it : fEvent){
+		if(it.second->fUsageIndex<0)
+			it.second->fUsageIndex = fBranchUsage->AddBranch(it.second->fTreeName, it.first);
+	}
+	for(auto &it : fObject){
+		if(it.second->fUsageIndex<0)
+			it.second->fUsageIndex = fBranchUsage->AddBranch(it.first, it.second->fBranchName);
+	}
+	fBranchUsage->Print();
+	fBranchUsage->Save(fBranchUsageFile);
+}
+
+Long64_t IOTree::GetClusterEnd(Long64_t iEvent){
+	/// \MemberDescr
+	/// \param iEvent : Index of the event
+	/// \return Index of the first event after the cluster of the reference tree containing this
+	/// event, -1 if unknown (entry list input or event not available)
+	///
+	/// Only the file containing the event is opened: no basket is read.
+	/// \EndMemberDescr
+
+	if(fEntryList || !fReferenceTree) return -1;
+	Long64_t chainEntry = iEvent;
+	if(fStreaming){
+		chainEntry = GetStreamEntry(iEvent);
+		if(chainEntry<0) return -1;
+	}
+	Long64_t clusterEnd = -1;
+	fIOTimeCount.Start();
+	Long64_t localEntry = fReferenceTree->LoadTree(chainEntry);
+	TTree *tree = fReferenceTree->GetTree();
+	if(localEntry>=0 && tree){
+		TTree::TClusterIterator clusterIt = tree->GetClusterIterator(localEntry);
+		clusterIt();
+		clusterEnd = iEvent + std::min(clusterIt.GetNextEntry(), tree->GetEntries()) - localEntry;
+	}
+	fIOTimeCount.Stop();
+	return clusterEnd;
+}
+
+bool IOTree::GetCurrentEntry(TString &fileName, TString &treeName, Long64_t &localEntry) const{
+	/// \MemberDescr
+	/// \param fileName : Filled with the path of the file containing the current event (remote
+	/// path for a staged copy)
+	/// \param treeName : Filled with the name of the reference tree
+	/// \param localEntry : Filled with the entry of the current event in this file
+	/// \return False if no event is loaded
+	/// \EndMemberDescr
+
+	if(!fReferenceTree || !fReferenceTree->GetTree() || !fReferenceTree->GetCurrentFile()) return false;
+	fileName = GetOriginalFileName(fReferenceTree->GetCurrentFile()->GetName());
+	treeName = fReferenceTree->GetName();
+	localEntry = fReferenceTree->GetTree()->GetReadEntry();
+	return localEntry>=0;
+}
+
+bool IOTree::StartEventCache(){
+	/// \MemberDescr
+	/// \return False if the requested objects cannot be cached
+	///
+	/// Create the cache receiving the events passed to CacheEvent during the first pass of a
+	/// multi-pass analysis (EventCacheSize and EventCacheDir settings)
+	/// \EndMemberDescr
+
+	if(fEventCache) delete fEventCache;
+	fEventCache = nullptr;
+	fEventCacheClasses.clear();
+
+	for (objectIterator itObj = fObject.begin(); itObj != fObject.end(); ++itObj) {
+		TClass *cls = TClass::GetClass(itObj->second->fClassName);
+		if(!cls){
+			std::cout << normal() << "Unable to cache the objects of class " << itObj->second->fClassName << std::endl;
+			return false;
+		}
+		fEventCacheClasses.push_back(cls);
+	}
+	fEventCache = new EventCache((Long64_t)Configuration::ConfigSettings::global::fEventCacheSize*1048576,
+			Configuration::ConfigSettings::global::fEventCacheDir);
+	return true;
+}
+
+void IOTree::CacheEvent(Long64_t iEvent){
+	/// \MemberDescr
+	/// \param iEvent : Index of the event
+	///
+	/// Add the currently loaded event (requested events, objects and projections) to the cache
+	/// \EndMemberDescr
+
+	if(!fEventCache) return;
+
+	TBufferFile *buffer = fEventCache->StartEvent();
+	if(buffer){
+		unsigned int iClass = 0;
+		for (eventIterator itEvt = fEvent.begin(); itEvt != fEvent.end(); ++itEvt)
+			itEvt->second->fEvent->IsA()->Streamer(itEvt->second->fEvent, *buffer);
+		for (objectIterator itObj = fObject.begin(); itObj != fObject.end(); ++itObj)
+			fEventCacheClasses[iClass++]->Streamer(itObj->second->fObject, *buffer);
+		for (auto projection : fProjections){
+			buffer->WriteInt(projection->fValues.size());
+			buffer->WriteFastArray(projection->fValues.data(), projection->fValues.size());
+		}
+	}
+	fEventCache->EndEvent(iEvent);
+}
+
+Long64_t IOTree::GetNCachedEvents() const{
+	/// \MemberDescr
+	/// \return Number of events in the cache
+	/// \EndMemberDescr
+
+	if(!fEventCache) return 0;
+	return fEventCache->GetNEvents();
+}
+
+Long64_t IOTree::LoadCachedEvent(Long64_t index){
+	/// \MemberDescr
+	/// \param index : Index of the event in the cache
+	/// \return Index of the event in the first pass, -1 if it cannot be loaded
+	///
+	/// Restore the requested events, objects and projections from the cache. If the cache
+	/// could not keep the events, the event is read again from the input files.
+	/// \EndMemberDescr
+
+	if(!fEventCache || index<0 || index>=fEventCache->GetNEvents()) return -1;
+	Long64_t iEvent = fEventCache->GetEventIndex(index);
+
+	TBufferFile *buffer = fEventCache->GetEvent(index);
+	if(!buffer) return LoadEvent(iEvent) ? iEvent : -1;
+
+	if (fGraphicalMutex->Lock() == 0) {
+		unsigned int iClass = 0;
+		for (eventIterator itEvt = fEvent.begin(); itEvt != fEvent.end(); ++itEvt)
+			itEvt->second->fEvent->IsA()->Streamer(itEvt->second->fEvent, *buffer);
+		for (objectIterator itObj = fObject.begin(); itObj != fObject.end(); ++itObj)
+			fEventCacheClasses[iClass++]->Streamer(itObj->second->fObject, *buffer);
+		for (auto projection : fProjections){
+			Int_t nValues;
+			buffer->ReadInt(nValues);
+			projection->fValues.resize(nValues);
+			buffer->ReadFastArray(projection->fValues.data(), nValues);
+		}
+		fGraphicalMutex->UnLock();
+	}
+	return iEvent;
+}
+
+void IOTree::StopEventCache(){
+	/// \MemberDescr
+	/// Print the summary of the cache and delete it
+	/// \EndMemberDescr
+
+	if(!fEventCache) return;
+	fEventCache->PrintSummary();
+	delete fEventCache;
+	fEventCache = nullptr;
+}
+
 Event* IOTree::GetMCTruthEvent(){
 	/// \MemberDescr
 	/// \return Pointer to the MCTruthEvent
@@ -336,7 +941,10 @@ Event* IOTree::GetMCTruthEvent(){
 	objectIterator itObj;
 
 	for(itObj = fObject.find("MC"); itObj!=fObject.end(); ++itObj){
-		if(itObj->second->fBranchName.CompareTo("Generated")==0) return (Event*)itObj->second->fObject;
+		if(itObj->second->fBranchName.CompareTo("Generated")==0){
+			if(fBranchUsage) RecordUsage(itObj->second->fUsageIndex, "MC", "Generated");
+			return (Event*)itObj->second->fObject;
+		}
 	}
 	std::cout << normal() << "MCTruth not found in tree MC" << std::endl;
 	return nullptr;
@@ -362,7 +970,10 @@ RawHeader* IOTree::GetRawHeaderEvent(TString treeName){
 	objectIterator itObj;
 
 	for(itObj = fObject.find(treeName); itObj!=fObject.end(); ++itObj){
-		if(itObj->second->fBranchName.CompareTo("RawHeader")==0) return (RawHeader*)itObj->second->fObject;
+		if(itObj->second->fBranchName.CompareTo("RawHeader")==0){
+			if(fBranchUsage) RecordUsage(itObj->second->fUsageIndex, treeName, "RawHeader");
+			return (RawHeader*)itObj->second->fObject;
+		}
 	}
 	std::cout << standard() << "RawHeader not found in tree " << treeName << std::endl;
 	return nullptr;
@@ -517,34 +1128,277 @@ bool IOTree::OpenInput(TString inFileName, int nFiles){
 
 	if(!IOHandler::OpenInput(inFileName, nFiles)) return false;
 
+	if(fStreaming && (fEntryList || fFriendFiles.size()>0 || fContinuousReading)){
+		std::cout << normal() << "Streaming reader not available with entry lists, friend trees or continuous reading" << std::endl;
+		fStreaming = false;
+	}
+	//The total number of events is only known when the last file is reached
+	if(fStreaming) fFastStart = true;
+
 	treeIterator it;
 	bool inputChecked = false;
 	int success;
+	int nAdded = 0;
 
+	ReadFriendFiles();
+	FileCatalog *catalog = FileCatalog::GetInstance();
+	std::vector<TString> validFiles;
+	std::vector<const FileCatalog::FileRecord*> records;
 	for(auto fileName : fInputfiles){
-		if(!inputChecked && checkInputFile(fileName))
+		//Known number of entries avoids opening the files to count them
+		fIOTimeCount.Start();
+		//Staged copies are recorded with the remote file
+		const FileCatalog::FileRecord *record = catalog->Find(GetOriginalFileName(fileName));
+		if(!record && !fFastStart) record = catalog->Scan(GetOriginalFileName(fileName));
+		fIOTimeCount.Stop();
+		if(record && !record->fValid){
+			std::cout << normal() << "File " << fileName << " cannot be opened (file catalog)" << std::endl;
+			FileSkipped(fileName);
+			if(fEntryList){
+				fEntryListTrees.push_back(-1);
+				fEntryListStarts.push_back(fEntryListEvents);
+			}
+			continue;
+		}
+		//Keep fInputfiles aligned with the files of the chains
+		validFiles.push_back(fileName);
+		records.push_back(record);
+
+		if(!inputChecked && checkInputFile(fileName, record))
 			inputChecked = true;
+		//The streaming reader only adds the first file, the next ones replace it
+		if(fStreaming && validFiles.size()>1) continue;
 		fIOTimeCount.Start();
-		for(it=fTree.begin(); it!=fTree.end(); it++) success = it->second->AddFile(fileName);
+		for(it=fTree.begin(); it!=fTree.end(); it++){
+			if(fFriendTrees.count(it->first)>0) continue;
+			Long64_t nEntries = record ? record->GetEntries(it->first) : -1;
+			success = it->second->AddFile(fileName, nEntries>0 ? nEntries : TTree::kMaxEntries);
+		}
 		fIOTimeCount.Stop();
 
 		if(success==0) FileSkipped(fileName);
+		if(fEntryList){
+			//Position of the file in the chains, for the sub-list with the same index
+			fEntryListTrees.push_back(success==0 ? -1 : nAdded++);
+			//The events of the files not read are left out of the numbering
+			fEntryListStarts.push_back(fEntryListEvents);
+			TEntryList *subList = fEntryList->GetLists() ? (TEntryList*)fEntryList->GetLists()->At(fEntryListTrees.size()-1) : fEntryList;
+			if(success!=0 && subList) fEntryListEvents += subList->GetN();
+		}
 	}
+	fInputfiles = validFiles;
+	catalog->Save();
+	catalog->PrintSummary();
+
+	if(fStreaming && fInputfiles.size()>0){
+		std::cout << normal() << "Streaming " << fInputfiles.size() << " input files" << std::endl;
+		fStreamOffsets.assign(1, 0);
+		fStreamFile = 0;
+		fStreamEntries = -1;
+		if(fInputfiles.size()>1) TFile::AsyncOpen(fInputfiles[1]);
+	}
+
+	if(fFastStart && !fContinuousReading && !fEntryList) StartInputScan(records);
 	return inputChecked;
 }
 
-bool IOTree::checkInputFile(TString fileName){
+void IOTree::StartInputScan(const std::vector<const FileCatalog::FileRecord*> &records){
+	/// \MemberDescr
+	/// \param records : Record of each input file in the file catalog (nullptr if unknown)
+	///
+	/// Start counting in background the entries of the reference tree in the input files
+	/// not found in the file catalog (ScanThreads setting).
+	/// \EndMemberDescr
+
+	if(!fReferenceTree || Configuration::ConfigSettings::global::fScanThreads<=0) return;
+
+	fFileEntries.clear();
+	for(auto record : records){
+		if(record) fFileEntries.push_back(std::max(record->GetEntries(fReferenceTree->GetName()), (Long64_t)0));
+		else fFileEntries.push_back(InputScanner::kPending);
+	}
+	if(!fInputScanner) fInputScanner = new InputScanner();
+	fInputScanner->Start(fInputfiles, fFileEntries, fReferenceTree->GetName(),
+			Configuration::ConfigSettings::global::fScanThreads);
+}
+
+void IOTree::UpdateInputScan(){
+	/// \MemberDescr
+	/// Collect the results of the background scanning of the input files. The files which
+	/// cannot be read are written in the .skipped file before the event loop reaches them.
+	/// \EndMemberDescr
+
+	if(!fInputScanner) return;
+
+	for(unsigned int i=0; i<fFileEntries.size(); ++i){
+		if(fFileEntries[i]!=InputScanner::kPending) continue;
+		fFileEntries[i] = fInputScanner->GetEntries(i);
+		if(fFileEntries[i]==InputScanner::kInvalid){
+			std::cout << normal() << "File " << i << ":" << fInputfiles[i] << " cannot be read and will be skipped" << std::endl;
+			FileSkipped(fInputfiles[i]);
+		}
+	}
+}
+
+void IOTree::LoadStreamFile(int index){
+	/// \MemberDescr
+	/// \param index : Index of the input file
+	///
+	/// Replace the file in the chains by this one (streaming reader), branch the requested
+	/// objects again and start opening the following file in advance.
+	/// \EndMemberDescr
+
+	std::cout << debug() << "Streaming file " << index << ":" << fInputfiles[index] << std::endl;
+	fIOTimeCount.Start();
+	for(auto &it : fTree){
+		it.second->Reset();
+		it.second->AddFile(fInputfiles[index]);
+		it.second->SetCacheSize(400000000);
+		it.second->SetCacheLearnEntries(2);
+	}
+	for(auto &it : fEvent){
+		if(!it.second->fPruned)
+			fTree.find(it.second->fTreeName)->second->SetBranchAddress(it.first, &(it.second->fEvent));
+	}
+	for(auto &it : fObject){
+		if(!it.second->fPruned)
+			fTree.find(it.first)->second->SetBranchAddress(it.second->fBranchName, &(it.second->fObject));
+	}
+
+	if(index+1<(int)fInputfiles.size()) TFile::AsyncOpen(fInputfiles[index+1]);
+	fStreamFile = index;
+	fStreamEntries = fReferenceTree->GetEntries();
+	fIOTimeCount.Stop();
+}
+
+Long64_t IOTree::GetStreamEntry(Long64_t iEvent){
+	/// \MemberDescr
+	/// \param iEvent : Index of the event among all the input files
+	/// \return Index of the event in the chains, -1 if after the last event (streaming reader)
+	///
+	/// Replace the file in the chains until reaching the file containing the event. Going
+	/// backward reopens the file from the list of offsets of the files already reached.
+	/// \EndMemberDescr
+
+	if(fStreamFile<0 || !fReferenceTree) return -1;
+	if(iEvent<fStreamOffsets[fStreamFile]){
+		int index = std::upper_bound(fStreamOffsets.begin(), fStreamOffsets.end(), iEvent) - fStreamOffsets.begin() - 1;
+		LoadStreamFile(std::max(index, 0));
+	}
+	if(fStreamEntries<0){
+		fIOTimeCount.Start();
+		fStreamEntries = fReferenceTree->GetEntries();
+		fIOTimeCount.Stop();
+	}
+	while(iEvent>=fStreamOffsets[fStreamFile]+fStreamEntries){
+		if(fStreamFile+1>=(int)fInputfiles.size()) return -1;
+		if((int)fStreamOffsets.size()==fStreamFile+1)
+			fStreamOffsets.push_back(fStreamOffsets[fStreamFile]+fStreamEntries);
+		LoadStreamFile(fStreamFile+1);
+	}
+	return iEvent - fStreamOffsets[fStreamFile];
+}
+
+int IOTree::GetCurrentFileIndex() const{
+	/// \MemberDescr
+	/// \return Index in the input files of the file containing the current event
+	/// \EndMemberDescr
+
+	if(fStreaming) return fStreamFile;
+	return fReferenceTree->GetTreeNumber();
+}
+
+Long64_t IOTree::GetCurrentFileOffset() const{
+	/// \MemberDescr
+	/// \return Index of the first event of the file containing the current event
+	/// \EndMemberDescr
+
+	if(fStreaming) return fStreamOffsets[fStreamFile];
+	return fReferenceTree->GetChainOffset();
+}
+
+void IOTree::ReadFriendFiles(){
+	/// \MemberDescr
+	/// Open the friend files and add each tree they contain (at the top level or in the
+	/// directory of an analyzer) to the corresponding requested TChain. These chains are
+	/// then not filled with the input files.
+	/// \EndMemberDescr
+
+	for(auto fileName : fFriendFiles){
+		fIOTimeCount.Start();
+		TFile *fd = TFile::Open(fileName.Data(), "READ");
+		fIOTimeCount.Stop();
+		if(!fd || fd->IsZombie()){
+			std::cout << noverbose() << "Unable to open the friend file " << fileName << std::endl;
+			if(fd) delete fd;
+			continue;
+		}
+		//List the trees of the file as (name, path in the file)
+		std::vector<std::pair<TString,TString> > trees;
+		TList* keys = fd->GetListOfKeys();
+		for(int i=0; i<keys->GetEntries(); i++){
+			TKey* k = (TKey*)keys->At(i);
+			if(TString(k->GetClassName()).CompareTo("TTree")==0)
+				trees.push_back(std::pair<TString,TString>(k->GetName(), k->GetName()));
+			else if(TString(k->GetClassName()).CompareTo("TDirectoryFile")==0){
+				TDirectory *dir = fd->GetDirectory(k->GetName());
+				TList* dirKeys = dir->GetListOfKeys();
+				for(int j=0; j<dirKeys->GetEntries(); j++){
+					TKey* dk = (TKey*)dirKeys->At(j);
+					if(TString(dk->GetClassName()).CompareTo("TTree")!=0) continue;
+					trees.push_back(std::pair<TString,TString>(dk->GetName(), TString(k->GetName()) + "/" + dk->GetName()));
+				}
+			}
+		}
+
+		for(auto tree : trees){
+			if(fTree.count(tree.first)==0 || fFriendTrees.count(tree.first)>0) continue;
+			fTree.find(tree.first)->second->AddFile(fileName, TTree::kMaxEntries, tree.second);
+			fFriendTrees.insert(std::pair<TString,TString>(tree.first, fileName));
+		}
+		fd->Close();
+		delete fd;
+	}
+}
+
+bool IOTree::checkInputFile(TString fileName, const FileCatalog::FileRecord *record){
 	/// \MemberDescr
 	/// \param fileName : Name of the file to open
+	/// \param record : Record of the file in the file catalog. If valid, the file is not opened
 	/// \return True if the file can be opened
 	///
 	/// Open the input file to check if MC are present and if yes, what's the name of the TTree
 	/// \EndMemberDescr
 
+	fWithMC = false;
+	fWithRawHeader = false;
+	if(record && record->fValid){
+		for(auto &tree : record->fTrees){
+			if(record->HasBranch(tree.first, "Generated")){
+				fWithMC = true;
+				RequestTree(tree.first, "Generated", "Event", new Event);
+				if(!fMCTruthTree) fMCTruthTree = fTree.find(tree.first)->second;
+				fReferenceTree = fMCTruthTree;
+			}
+
+			if(record->HasBranch(tree.first, "RawHeader")){
+				fWithRawHeader = true;
+				RequestTree(tree.first, "RawHeader", "RawHeader", new RawHeader);
+				if(!fRawHeaderTree) fRawHeaderTree = fTree.find(tree.first)->second;
+				if(!fReferenceTree) fReferenceTree = fRawHeaderTree;
+			}
+		}
+		if(fWithMC==false) std::cout << normal() << "No MC data found" << std::endl;
+		if(fWithRawHeader==false) std::cout << normal() << "No Raw Header found" << std::endl;
+		return kTRUE;
+	}
+
 	TFile *fd;
 	if(fGraphicalMutex->Lock()==0){
 		fIOTimeCount.Start();
+		TraceRecorder::GetInstance()->Begin("OpenFile", "IO");
 		fd = TFile::Open(fileName.Data(), "R");
+		TraceRecorder::GetInstance()->End("OpenFile", "IO");
 		fIOTimeCount.Stop();
 		fGraphicalMutex->UnLock();
 	}
@@ -556,8 +1410,6 @@ bool IOTree::checkInputFile(TString fileName){
 	TList* keys = fd->GetListOfKeys();
 	fIOTimeCount.Stop();
 
-	fWithMC = false;
-	fWithRawHeader = false;
 	for(int i=0; i<keys->GetEntries(); i++){
 		TKey* k = (TKey*)keys->At(i);
 		if(TString(k->GetClassName()).CompareTo("TTree")!=0) continue;
@@ -594,33 +1446,421 @@ void IOTree::WriteEvent(){
 	/// Write the event in the output tree.
 	/// \EndMemberDescr
 
-	treeIterator it;
-	NA62Analysis::NA62Map<TString,TTree*>::type::iterator itTree;
-
 	std::cout << extended() << "Writing event in output" << std::endl;
+	TraceRecorder::GetInstance()->Begin("WriteEvent", "Output");
+	if(fEntryListExport){
+		if(!fExportEntryList) fExportEntryList = new TEntryList("EntryList", "Exported events");
+		//The chains of the streaming reader only contain the current file
+		fExportEntryList->Enter(fStreaming ? fCurrentEntry-GetCurrentFileOffset() : fCurrentEntry, fReferenceTree);
+		TraceRecorder::GetInstance()->End("WriteEvent", "Output");
+		return;
+	}
 	if(fExportTrees.size()==0){
-		for(it=fTree.begin(); it!= fTree.end(); it++){
-			fExportTrees.insert(std::pair<TString,TTree*>(it->first, it->second->CloneTree(0)));
+		TDirectory *currentDir = gDirectory;
+		if(fRollSize>0 || fRollBursts>0){
+			if(!fRollFile) OpenRollFile();
+			fRollFile->cd();
 		}
+		CreateExportTrees(fSkimBranches, fExportTrees);
+		currentDir->cd();
 	}
-	for(itTree=fExportTrees.begin(); itTree!=fExportTrees.end(); itTree++){
-		itTree->second->Fill();
+	if(!fFastSkim || !DeferExportEvent()) FillExportTrees();
+	++fRollEvents;
+	if(fRollSize>0 && fRollFile && fRollFile->GetBytesWritten()>=fRollSize) CloseRollFile();
+	TraceRecorder::GetInstance()->End("WriteEvent", "Output");
+}
+
+void IOTree::WriteEvent(TString streamName){
+	/// \MemberDescr
+	/// \param streamName : Name of the export stream
+	///
+	/// Write the event in the output trees of the export stream. A stream that was not
+	/// defined with AddExportStream is written in OutputFile_StreamName.root with the
+	/// default branch selection.
+	/// \EndMemberDescr
+
+	std::cout << extended() << "Writing event in stream " << streamName << std::endl;
+	if(fExportStreams.count(streamName)==0){
+		TString fileName = fOutFileName;
+		if(fileName.EndsWith(".root")) fileName.Remove(fileName.Length()-5);
+		AddExportStream(streamName, fileName + "_" + streamName + ".root");
+	}
+	ExportStream *stream = fExportStreams[streamName];
+	if(stream->fDisabled) return;
+
+	TraceRecorder::GetInstance()->Begin("WriteEvent", "Output");
+	if(!stream->fFile){
+		TDirectory *currentDir = gDirectory;
+		fIOTimeCount.Start();
+		OutputWriter::GetInstance()->Sync();
+		stream->fFile = new TFile(stream->fFileName, "RECREATE");
+		fIOTimeCount.Stop();
+		if(stream->fFile->IsZombie()){
+			std::cout << noverbose() << "Unable to open the output file " << stream->fFileName
+					<< ": stream " << streamName << " disabled" << std::endl;
+			delete stream->fFile;
+			stream->fFile = nullptr;
+			stream->fDisabled = true;
+			currentDir->cd();
+			TraceRecorder::GetInstance()->End("WriteEvent", "Output");
+			return;
+		}
+		OutputTreeSettings::GetInstance()->ApplyToFile(stream->fFile);
+		std::cout << normal() << "Opening output file " << stream->fFileName << " for stream " << streamName << std::endl;
+		stream->fFile->cd();
+		if(!fEntryListExport) CreateExportTrees(stream->fSkimBranches, stream->fTrees);
+		currentDir->cd();
+	}
+	if(fEntryListExport){
+		//As the main output, the stream file only contains the entry list of its events
+		if(!stream->fEntryList) stream->fEntryList = new TEntryList("EntryList", "Exported events");
+		stream->fEntryList->Enter(fStreaming ? fCurrentEntry-GetCurrentFileOffset() : fCurrentEntry, fReferenceTree);
 	}
+	fIOTimeCount.Start();
+	for(auto &itTree : stream->fTrees) OutputWriter::GetInstance()->Fill(itTree.second);
+	fIOTimeCount.Stop();
+	++stream->fNExported;
+	TraceRecorder::GetInstance()->End("WriteEvent", "Output");
 }
 
-void IOTree::WriteTree() const{
+void IOTree::WriteTree(){
 	/// \MemberDescr
 	/// Write the output trees in the output file
 	/// \EndMemberDescr
 
 	NA62Analysis::NA62Map<TString,TTree*>::type::const_iterator itTree;
 
+	if(fRollFile) CloseRollFile();
+	FlushDeferredEvents();
+	if(fExportEntryList){
+		std::cout << standard() << "Exported " << fExportEntryList->GetN() << " events in the entry list" << std::endl;
+		fIOTimeCount.Start();
+		fOutFile->cd();
+		fExportEntryList->Write("EntryList");
+		fIOTimeCount.Stop();
+	}
 	std::cout << normal() << "Writing output trees" << std::endl;
+	if(fNExported+fNExportedFast>0)
+		std::cout << standard() << "Exported " << fNExported+fNExportedFast << " events ("
+			<< fNExportedFast << " by copy of the compressed baskets)" << std::endl;
+	TraceRecorder::GetInstance()->Begin("WriteTree", "Output");
 	for(itTree=fExportTrees.begin(); itTree!=fExportTrees.end(); itTree++){
 		fIOTimeCount.Start();
 		itTree->second->Write();
 		fIOTimeCount.Stop();
 	}
+	for(auto &itStream : fExportStreams){
+		ExportStream *stream = itStream.second;
+		if(!stream->fFile) continue;
+		std::cout << standard() << "Stream " << itStream.first << ": exported " << stream->fNExported
+				<< " events in " << stream->fFileName << std::endl;
+		fIOTimeCount.Start();
+		stream->fFile->cd();
+		for(auto &itStreamTree : stream->fTrees) itStreamTree.second->Write();
+		if(stream->fEntryList) stream->fEntryList->Write("EntryList");
+		fIOTimeCount.Stop();
+	}
+	if(fOutFile) fOutFile->cd();
+	TraceRecorder::GetInstance()->End("WriteTree", "Output");
+}
+
+void IOTree::SetSkimBranches(TString branchList){
+	/// \MemberDescr
+	/// \param branchList : Comma separated list of branches to export. Each element
+	/// is either "Tree:Branch" or "Branch" (branch of any tree). All the branches
+	/// read in input are exported if the list is empty.
+	///
+	/// Select the branches written in the exported trees
+	/// \EndMemberDescr
+
+	fSkimBranches = ParseBranchList(branchList);
+}
+
+bool IOTree::AddExportStream(TString streamName, TString definition){
+	/// \MemberDescr
+	/// \param streamName : Name of the stream, as given to Analyzer::ExportEvent
+	/// \param definition : fileName[,branch1,branch2,...] where the branches are given as
+	/// in SetSkimBranches. The default branch selection is used if no branch is given.
+	/// \return False if the stream already exists or the definition is invalid
+	///
+	/// Define a named export stream: the events exported to this stream are written in
+	/// their own output file, during the same pass over the input.
+	/// \EndMemberDescr
+
+	if(fExportStreams.count(streamName)>0){
+		std::cout << normal() << "Export stream " << streamName << " already defined" << std::endl;
+		return false;
+	}
+	TString fileName = definition;
+	TString branchList;
+	Ssiz_t pos = definition.First(',');
+	if(pos!=kNPOS){
+		fileName = definition(0, pos);
+		branchList = definition(pos+1, definition.Length());
+	}
+	fileName = fileName.Strip(TString::kBoth);
+	if(fileName.Length()==0){
+		std::cout << normal() << "No output file given for export stream " << streamName << std::endl;
+		return false;
+	}
+
+	ExportStream *stream = new ExportStream;
+	stream->fFileName = fileName;
+	stream->fFile = nullptr;
+	stream->fSkimBranches = pos!=kNPOS ? ParseBranchList(branchList) : fSkimBranches;
+	stream->fNExported = 0;
+	stream->fEntryList = nullptr;
+	stream->fDisabled = false;
+	fExportStreams.insert(std::pair<TString,ExportStream*>(streamName, stream));
+	return true;
+}
+
+std::vector<TString> IOTree::ParseBranchList(TString branchList){
+	/// \MemberDescr
+	/// \param branchList : Comma separated list of branches
+	/// \return Vector of the non-empty elements of the list
+	/// \EndMemberDescr
+
+	std::vector<TString> branches;
+	TObjArray *tokens = branchList.Tokenize(",");
+	for(int i=0; i<tokens->GetEntries(); ++i){
+		TString branch = ((TObjString*)tokens->At(i))->GetString().Strip(TString::kBoth);
+		if(branch.Length()>0) branches.push_back(branch);
+	}
+	delete tokens;
+	return branches;
+}
+
+bool IOTree::IsSkimBranch(const std::vector<TString> &skimBranches, TString treeName, TString branchName){
+	/// \MemberDescr
+	/// \param skimBranches : Branches selected for export. All if empty
+	/// \param treeName : Name of the tree
+	/// \param branchName : Name of the branch
+	/// \return True if the branch is selected for export
+	/// \EndMemberDescr
+
+	if(skimBranches.size()==0) return true;
+	for(auto branch : skimBranches){
+		if(branch.CompareTo(branchName)==0 || branch.CompareTo(treeName + ":" + branchName)==0) return true;
+	}
+	return false;
+}
+
+void IOTree::CreateExportTrees(const std::vector<TString> &skimBranches, NA62Analysis::NA62Map<TString,TTree*>::type &exportTrees){
+	/// \MemberDescr
+	/// \param skimBranches : Branches selected for export. All if empty
+	/// \param exportTrees : Container receiving the output trees
+	///
+	/// Create the output trees, in the current directory, as empty clones of the input
+	/// trees. Only the branches read in input and selected in skimBranches are cloned.
+	/// \EndMemberDescr
+
+	treeIterator it;
+
+	for(it=fTree.begin(); it!= fTree.end(); it++){
+		//CloneTree only clones the active branches: temporarily disable the branches
+		//that are not selected for export
+		std::vector<std::pair<TString, UInt_t> > disabled;
+		TObjArray *branches = it->second->GetListOfBranches();
+		for(int i=0; branches && i<branches->GetEntriesFast(); ++i){
+			TString branchName = ((TBranch*)branches->UncheckedAt(i))->GetName();
+			UInt_t status = it->second->GetBranchStatus(branchName);
+			if(status && !IsSkimBranch(skimBranches, it->first, branchName)){
+				disabled.push_back(std::make_pair(branchName, status));
+				it->second->SetBranchStatus(branchName, 0);
+			}
+		}
+		TTree *exportTree = it->second->CloneTree(0);
+		OutputTreeSettings::GetInstance()->Apply(exportTree);
+		exportTrees.insert(std::pair<TString,TTree*>(it->first, exportTree));
+		for(auto branch : disabled) it->second->SetBranchStatus(branch.first, branch.second);
+		if(OutputWriter::GetInstance()->IsRunning()){
+			//The background writer redirects the branches of the clone: the TChain must
+			//not reset its addresses when opening a new file
+			if(it->second->GetListOfClones()) it->second->GetListOfClones()->Remove(exportTree);
+			if(it->second->GetTree() && it->second->GetTree()->GetListOfClones())
+				it->second->GetTree()->GetListOfClones()->Remove(exportTree);
+		}
+		std::cout << normal() << "Exporting " << exportTree->GetListOfBranches()->GetEntriesFast()
+				<< " branches of tree " << it->first << std::endl;
+	}
+}
+
+void IOTree::FillExportTrees(){
+	/// \MemberDescr
+	/// Fill the output trees with the currently loaded event
+	/// \EndMemberDescr
+
+	NA62Analysis::NA62Map<TString,TTree*>::type::iterator itTree;
+
+	fIOTimeCount.Start();
+	for(itTree=fExportTrees.begin(); itTree!=fExportTrees.end(); itTree++){
+		OutputWriter::GetInstance()->Fill(itTree->second);
+	}
+	fIOTimeCount.Stop();
+	++fNExported;
+}
+
+bool IOTree::DeferExportEvent(){
+	/// \MemberDescr
+	/// \return True if the writing of the event is deferred
+	///
+	/// As long as all the events of an input file are exported, they are not written
+	/// immediately. If the whole file ends up being exported, its compressed baskets are
+	/// copied without decompression (see FlushDeferredEvents). As soon as an event is
+	/// missing, the deferred events are written in the usual way.
+	/// \EndMemberDescr
+
+	if(!fReferenceTree || !fReferenceTree->GetTree()) return false;
+
+	int treeNumber = GetCurrentFileIndex();
+	Long64_t localEntry = fCurrentEntry - GetCurrentFileOffset();
+
+	if(fDeferredEvents>0 && (treeNumber!=fDeferredTreeNumber || localEntry!=fDeferredEvents)){
+		//The sequence of exported events is broken (new file or missing event)
+		FlushDeferredEvents();
+		if(treeNumber==fDeferredTreeNumber) return false;
+	}
+	if(fDeferredEvents==0){
+		if(localEntry!=0) return false;
+		fDeferredTreeNumber = treeNumber;
+		fDeferredOffset = GetCurrentFileOffset();
+		fDeferredFileEntries = fReferenceTree->GetTree()->GetEntries();
+		fDeferredFileName = fReferenceTree->GetFile()->GetName();
+	}
+	++fDeferredEvents;
+	return true;
+}
+
+void IOTree::FlushDeferredEvents(){
+	/// \MemberDescr
+	/// Write the deferred events. If they cover the whole input file, the input trees
+	/// are copied from the file basket by basket. Otherwise the events are read again from
+	/// the input trees already open (without going through the chains) and filled one by
+	/// one, and the current event is read again. The friend trees are read from their own
+	/// file in both cases.
+	/// \EndMemberDescr
+
+	NA62Analysis::NA62Map<TString,TTree*>::type::iterator itTree;
+
+	if(fDeferredEvents==0) return;
+	Long64_t nEvents = fDeferredEvents;
+	fDeferredEvents = 0;
+
+	if(nEvents==fDeferredFileEntries){
+		OutputWriter::GetInstance()->Sync();
+		TDirectory *currentDir = gDirectory;
+		fIOTimeCount.Start();
+		TFile *fd = TFile::Open(fDeferredFileName, "READ");
+		if(fd && !fd->IsZombie()){
+			std::cout << extended() << "Copying baskets of " << fDeferredFileName << std::endl;
+			for(itTree=fExportTrees.begin(); itTree!=fExportTrees.end(); itTree++){
+				if(fFriendTrees.count(itTree->first)>0){
+					CopyDeferredFriendEntries(itTree->first, nEvents);
+					continue;
+				}
+				TTree *inTree = static_cast<TTree*>(fd->Get(fTree[itTree->first]->GetName()));
+				if(inTree) CopyDeferredEntries(itTree->first, inTree, -1, "fast");
+			}
+			fd->Close();
+			delete fd;
+			currentDir->cd();
+			fIOTimeCount.Stop();
+			fNExportedFast += nEvents;
+			return;
+		}
+		delete fd;
+		currentDir->cd();
+		fIOTimeCount.Stop();
+		std::cout << normal() << "Unable to reopen " << fDeferredFileName << ". Exporting events one by one." << std::endl;
+	}
+
+	treeIterator it;
+	fIOTimeCount.Start();
+	if(GetCurrentFileIndex()==fDeferredTreeNumber){
+		//The deferred events are the first entries of the file currently open. The friend
+		//trees come from a single file aligned with the whole chains
+		for(Long64_t i=0; i<nEvents; ++i){
+			for(it=fTree.begin(); it!=fTree.end(); it++){
+				if(!it->second->GetTree()) continue;
+				it->second->GetTree()->GetEntry(fFriendTrees.count(it->first)>0 ? fDeferredOffset+i : i);
+			}
+			FillExportTrees();
+		}
+		Long64_t localEntry = fCurrentEntry - GetCurrentFileOffset();
+		for(it=fTree.begin(); it!=fTree.end(); it++){
+			if(!it->second->GetTree()) continue;
+			it->second->GetTree()->GetEntry(fFriendTrees.count(it->first)>0 ? fCurrentEntry : localEntry);
+		}
+		fIOTimeCount.Stop();
+		return;
+	}
+
+	//The chains already moved to another file (LoadEvent flushes before leaving the file,
+	//only when flushed from elsewhere): read the deferred file separately
+	OutputWriter::GetInstance()->Sync();
+	TDirectory *currentDir = gDirectory;
+	TFile *fd = TFile::Open(fDeferredFileName, "READ");
+	if(fd && !fd->IsZombie()){
+		for(itTree=fExportTrees.begin(); itTree!=fExportTrees.end(); itTree++){
+			if(fFriendTrees.count(itTree->first)>0){
+				CopyDeferredFriendEntries(itTree->first, nEvents);
+				continue;
+			}
+			TTree *inTree = static_cast<TTree*>(fd->Get(fTree[itTree->first]->GetName()));
+			if(inTree) CopyDeferredEntries(itTree->first, inTree, nEvents, "");
+		}
+		fd->Close();
+		fNExported += nEvents;
+	}
+	else std::cout << normal() << "Unable to reopen " << fDeferredFileName << ": " << nEvents << " exported events lost" << std::endl;
+	delete fd;
+	currentDir->cd();
+	fIOTimeCount.Stop();
+}
+
+void IOTree::CopyDeferredEntries(TString treeName, TTree* inTree, Long64_t nEvents, Option_t* option){
+	/// \MemberDescr
+	/// \param treeName : Name of the exported tree
+	/// \param inTree : Input tree read from the deferred file
+	/// \param nEvents : Number of entries to copy (-1 for all)
+	/// \param option : Option of TTree::CopyEntries
+	///
+	/// Copy the entries of the input tree in the exported tree. The copy redirects the branches
+	/// of the exported tree to the objects of the input tree, which are deleted with its file:
+	/// they are then attached again to the objects of the chain.
+	/// \EndMemberDescr
+
+	TTree *exportTree = fExportTrees[treeName];
+	//The background writer recreates its copies with the next entry
+	OutputWriter::GetInstance()->Release(exportTree);
+	exportTree->CopyEntries(inTree, nEvents, option);
+	fTree[treeName]->CopyAddresses(exportTree);
+}
+
+void IOTree::CopyDeferredFriendEntries(TString treeName, Long64_t nEvents){
+	/// \MemberDescr
+	/// \param treeName : Name of the exported friend tree
+	/// \param nEvents : Number of entries to copy
+	///
+	/// Copy the entries of a friend tree corresponding to the deferred events. The friend
+	/// tree is not part of the deferred file: the entries are read from the friend file,
+	/// which is aligned with the whole chains, and the current event is read again.
+	/// \EndMemberDescr
+
+	TTree *exportTree = fExportTrees[treeName];
+	TChain *friendChain = fTree[treeName];
+	//Filled directly: the background writer recreates its copies with the next entry
+	OutputWriter::GetInstance()->Release(exportTree);
+	for(Long64_t i=0; i<nEvents; ++i){
+		if(friendChain->GetEntry(fDeferredOffset+i)<=0){
+			std::cout << normal() << "Unable to read entry " << fDeferredOffset+i << " of friend tree "
+					<< treeName << ": " << nEvents-i << " exported entries missing" << std::endl;
+			break;
+		}
+		exportTree->Fill();
+	}
+	friendChain->GetEntry(fCurrentEntry);
 }
 
 void IOTree::PrintInitSummary() const{
@@ -653,6 +1893,106 @@ void IOTree::PrintInitSummary() const{
 	treeTable.Print("\t");
 }
 
+void IOTree::PrintIOSummary() const{
+	/// \MemberDescr
+	///
+	/// Print the reading statistics of each requested branch at the end of the processing:
+	/// number of entries and baskets read, compressed and uncompressed volume, time spent in
+	/// GetEntry and the fraction of it spent in calls that loaded a new basket (reading and
+	/// decompression).
+	/// \EndMemberDescr
+
+	NA62Analysis::NA62MultiMap<TString,EventTriplet*>::type::const_iterator itEv;
+	NA62Analysis::NA62MultiMap<TString,ObjectTriplet*>::type::const_iterator itObj;
+
+	std::vector<std::pair<TString, const BranchStats*> > stats;
+	for(itEv=fEvent.begin(); itEv!=fEvent.end(); itEv++)
+		stats.push_back(std::make_pair(itEv->second->fTreeName + "->" + itEv->first, &itEv->second->fStats));
+	for(itObj=fObject.begin(); itObj!=fObject.end(); itObj++)
+		stats.push_back(std::make_pair(itObj->first + "->" + itObj->second->fBranchName, &itObj->second->fStats));
+	if(stats.size()==0) return;
+
+	double totalTime = 0;
+	for(auto it : stats) totalTime += it.second->fReadTime;
+
+	StringTable branchTable("Input branches I/O");
+	branchTable.AddColumn("branch", "Branch");
+	branchTable.AddColumn("entries", "Entries");
+	branchTable.AddColumn("baskets", "Baskets");
+	branchTable.AddColumn("zip", "Compressed (MB)");
+	branchTable.AddColumn("unzip", "Uncompressed (MB)");
+	branchTable.AddColumn("ratio", "Ratio");
+	branchTable.AddColumn("read", "GetEntry (s)");
+	branchTable.AddColumn("basket", "Basket loading (s)");
+	branchTable.AddColumn("share", "Share (%)");
+	branchTable << sepr;
+	for(auto it : stats){
+		const BranchStats *s = it.second;
+		branchTable << it.first
+				<< TString::Format("%lld", s->fEntries)
+				<< TString::Format("%lld", s->fBaskets)
+				<< TString::Format("%.2f", s->fZipBytes/1048576.)
+				<< TString::Format("%.2f", s->fBytes/1048576.)
+				<< TString::Format("%.2f", s->fZipBytes>0 ? (double)s->fBytes/s->fZipBytes : 0.)
+				<< TString::Format("%.3f", s->fReadTime)
+				<< TString::Format("%.3f", s->fBasketTime)
+				<< TString::Format("%.1f", totalTime>0 ? 100.*s->fReadTime/totalTime : 0.);
+	}
+	branchTable.Print("\t");
+
+	std::cout << "\tTotal bytes read from files: " << TFile::GetFileBytesRead() << std::endl;
+}
+
+Int_t IOTree::BranchStats::Read(TBranch* branch, Long64_t entry, int treeNumber){
+	/// \MemberDescr
+	/// \param branch : Branch to read (of the currently loaded tree of the TChain)
+	/// \param entry : Local entry in the currently loaded tree
+	/// \param treeNumber : Index of the currently loaded tree in the TChain
+	/// \return Number of bytes read, as returned by TBranch::GetEntry
+	///
+	/// Read the entry and account for it. A new basket is counted each time the basket
+	/// being read by one of the terminal sub-branches changes.
+	/// \EndMemberDescr
+
+	using NA62Analysis::operator -;
+
+	if(treeNumber!=fTreeNumber){
+		//The TChain moved to a new file: the branch and its sub-branches are new objects
+		fTreeNumber = treeNumber;
+		fLeaves.clear();
+		std::vector<TBranch*> toVisit(1, branch);
+		while(toVisit.size()>0){
+			TBranch *b = toVisit.back();
+			toVisit.pop_back();
+			TObjArray *subBranches = b->GetListOfBranches();
+			if(!subBranches || subBranches->GetEntriesFast()==0) fLeaves.push_back(std::make_pair(b, -1));
+			else{
+				for(int i=0; i<subBranches->GetEntriesFast(); ++i)
+					toVisit.push_back((TBranch*)subBranches->UncheckedAt(i));
+			}
+		}
+	}
+
+	struct timespec start = TimeCounter::GetTime();
+	Int_t bytes = branch->GetEntry(entry);
+	bool newBasket = false;
+	for(auto &leaf : fLeaves){
+		int basket = leaf.first->GetReadBasket();
+		if(basket==leaf.second) continue;
+		leaf.second = basket;
+		newBasket = true;
+		++fBaskets;
+		if(basket>=0 && basket<leaf.first->GetMaxBaskets()) fZipBytes += leaf.first->GetBasketBytes()[basket];
+	}
+	float elapsed = TimeCounter::GetTime() - start;
+
+	++fEntries;
+	if(bytes>0) fBytes += bytes;
+	fReadTime += elapsed;
+	if(newBasket) fBasketTime += elapsed;
+	return bytes;
+}
+
 bool IOTree::CheckNewFileOpened(){
 	/// \MemberDescr
 	/// \return True if a new file has been opened
@@ -665,30 +2005,177 @@ bool IOTree::CheckNewFileOpened(){
 	TFile *currFile;
 
 	if(fReferenceTree){
-		openedFileNumber = fReferenceTree->GetTreeNumber();
+		openedFileNumber = GetCurrentFileIndex();
 		currFile = fReferenceTree->GetFile();
 	}
 	else return false;
 
 	if(openedFileNumber>fCurrentFileNumber){
 		IOHandler::NewFileOpened(openedFileNumber, currFile);
+		if(fRollBursts>0){
+			if(fRollBurstCount>=fRollBursts){
+				//Start a new file for the exported trees (and the histograms snapshot)
+				if(!fRollFile && fRollHistograms) OpenRollFile();
+				if(fRollFile) CloseRollFile();
+				fRollBurstCount = 0;
+			}
+			++fRollBurstCount;
+		}
 		return true;
 	}
 	return false;
 }
 
+void IOTree::OpenRollFile(){
+	/// \MemberDescr
+	/// Open the next output file of the exported trees: OutputFile_NNN.root
+	/// \EndMemberDescr
+
+	TString fileName = fOutFileName;
+	if(fileName.EndsWith(".root")) fileName.Remove(fileName.Length()-5);
+	fileName = TString::Format("%s_%03d.root", fileName.Data(), fRollIndex++);
+
+	TDirectory *currentDir = gDirectory;
+	fIOTimeCount.Start();
+	OutputWriter::GetInstance()->Sync();
+	fRollFile = new TFile(fileName, "RECREATE");
+	fIOTimeCount.Stop();
+	OutputTreeSettings::GetInstance()->ApplyToFile(fRollFile);
+	fRollEvents = 0;
+	std::cout << normal() << "Opening output file " << fileName << std::endl;
+	currentDir->cd();
+}
+
+void IOTree::CloseRollFile(){
+	/// \MemberDescr
+	/// Write the exported trees (and the histograms snapshot if requested) in the current
+	/// rolled file and close it. The trees are recreated in a new file with the next
+	/// exported event, so that the memory used by the output does not grow with the run.
+	/// \EndMemberDescr
+
+	FlushDeferredEvents();
+	TraceRecorder::GetInstance()->Begin("RollFile", "Output");
+	fIOTimeCount.Start();
+	for(auto &itTree : fExportTrees){
+		OutputWriter::GetInstance()->Release(itTree.second);
+		//The chain must not access the clone once deleted with its file
+		TChain *chain = fTree[itTree.first];
+		if(chain->GetListOfClones()) chain->GetListOfClones()->Remove(itTree.second);
+		if(chain->GetTree() && chain->GetTree()->GetListOfClones())
+			chain->GetTree()->GetListOfClones()->Remove(itTree.second);
+	}
+	fRollFile->cd();
+	for(auto &itTree : fExportTrees){
+		itTree.second->Write();
+		OutputTreeSettings::GetInstance()->Collect(itTree.second);
+	}
+	if(fRollHistograms) WriteSnapshot(fRollFile);
+	std::cout << normal() << "Closing output file " << fRollFile->GetName() << " (" << fRollEvents << " exported events)" << std::endl;
+	fRollFile->Close();
+	delete fRollFile;
+	fRollFile = nullptr;
+	fExportTrees.clear();
+	fIOTimeCount.Stop();
+	TraceRecorder::GetInstance()->End("RollFile", "Output");
+	if(fOutFile) fOutFile->cd();
+}
+
 Long64_t IOTree::GetNEvents(){
 	/// \MemberDescr
 	/// \return Total number of events. If used with --fast-start, returns kBigNumber
 	/// as long as the last file is not reached.
 	/// \EndMemberDescr
 
+	if(fEntryList) return fEntryListEvents;
 	if(fReferenceTree){
-		return fReferenceTree->GetEntriesFast();
+		Long64_t nEvents = fReferenceTree->GetEntriesFast();
+		if(fStreaming){
+			//Known once the last file is reached
+			if(fStreamFile==(int)fInputfiles.size()-1 && fStreamEntries>=0)
+				nEvents = fStreamOffsets[fStreamFile] + fStreamEntries;
+			else
+				nEvents = TTree::kMaxEntries;
+		}
+		if(fFileEntries.size()==0) return nEvents;
+
+		//All the files have been scanned: the total is known before reaching the last file
+		Long64_t scanned = 0;
+		for(auto nEntries : fFileEntries){
+			if(nEntries==InputScanner::kPending) return nEvents;
+			if(nEntries>0) scanned += nEntries;
+		}
+		return std::min(nEvents, scanned);
 	}
 	else return 0;
 }
 
+Long64_t IOTree::GetNEventsEstimate(){
+	/// \MemberDescr
+	/// \return Estimated total number of events. While the input files are scanned in background
+	/// (--fast-start), the files not scanned yet are assumed to contain the average number of
+	/// entries of the scanned ones. Otherwise same as GetNEvents().
+	/// \EndMemberDescr
+
+	Long64_t nEvents = GetNEvents();
+	Long64_t scanned = 0;
+	int nScanned = 0, nPending = 0;
+	for(auto nEntries : fFileEntries){
+		if(nEntries==InputScanner::kPending) ++nPending;
+		else if(nEntries>=0){
+			scanned += nEntries;
+			++nScanned;
+		}
+	}
+	if(nPending==0 || nScanned==0) return nEvents;
+	return std::min(nEvents, scanned + (scanned/nScanned)*nPending);
+}
+
+Long64_t IOTree::GetEntryListEntry(Long64_t iEvent){
+	/// \MemberDescr
+	/// \param iEvent : Index of the event among the entry list events of the files read (see
+	/// GetNEvents)
+	/// \return Index of the corresponding event in the chains, -1 if its file is not available
+	///
+	/// Translate an index of the entry list events into a global entry of the chains. The
+	/// sub-lists of the files which could not be added to the chains are skipped.
+	/// \EndMemberDescr
+
+	if(!fReferenceTree || iEvent<0 || iEvent>=fEntryListEvents) return -1;
+
+	//Last sub-list starting before the event: the empty ones cannot contain it
+	Int_t subList = std::upper_bound(fEntryListStarts.begin(), fEntryListStarts.end(), iEvent)
+			- fEntryListStarts.begin() - 1;
+	if(subList<0 || fEntryListTrees[subList]<0) return -1;
+	TEntryList *list = fEntryList->GetLists() ? (TEntryList*)fEntryList->GetLists()->At(subList) : fEntryList;
+	Long64_t localEntry = list ? list->GetEntry(iEvent - fEntryListStarts[subList]) : -1;
+	if(localEntry<0) return -1;
+
+	//Start of each file in the chains, from the number of entries given when the file was
+	//added (file catalog) or read when the chain loaded it. Only the preceding files whose
+	//number of entries is still unknown are opened.
+	Int_t treeNumber = fEntryListTrees[subList];
+	TObjArray *files = fReferenceTree->GetListOfFiles();
+	if(fEntryListOffsets.size()==0) fEntryListOffsets.push_back(0);
+	while((Int_t)fEntryListOffsets.size()<=treeNumber){
+		TChainElement *element = (TChainElement*)files->At(fEntryListOffsets.size()-1);
+		Long64_t nEntries = element ? element->GetEntries() : 0;
+		if(nEntries==TTree::kMaxEntries){
+			nEntries = 0;
+			fIOTimeCount.Start();
+			TFile *fd = TFile::Open(element->GetTitle(), "READ");
+			if(fd && !fd->IsZombie()){
+				TTree *tree = (TTree*)fd->Get(element->GetName());
+				if(tree) nEntries = tree->GetEntries();
+				fd->Close();
+			}
+			if(fd) delete fd;
+			fIOTimeCount.Stop();
+		}
+		fEntryListOffsets.push_back(fEntryListOffsets.back() + nEntries);
+	}
+	return fEntryListOffsets[treeNumber] + localEntry;
+}
+
 TString IOTree::DetermineMainTree(TString detName) {
 	/// \MemberDescr
 	/// \param detName : DetectorName (branch) for which the main tree should be identified
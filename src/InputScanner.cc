@@ -0,0 +1,172 @@
+/*
+ * InputScanner.cc
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ncl
+ */
+
+#include "InputScanner.hh"
+
+#include <iostream>
+
+#include <TROOT.h>
+#include <TFile.h>
+#include <TTree.h>
+#include <TThread.h>
+
+#include "TraceRecorder.hh"
+
+namespace NA62Analysis {
+namespace Core {
+
+InputScanner::InputScanner() :
+	fStop(false),
+	fNext(0),
+	fNPending(0)
+{
+	/// \MemberDescr
+	/// Default constructor
+	/// \EndMemberDescr
+}
+
+InputScanner::~InputScanner() {
+	/// \MemberDescr
+	/// Destructor. Stop the threads.
+	/// \EndMemberDescr
+
+	Stop();
+}
+
+bool InputScanner::Start(const std::vector<TString> &fileNames, const std::vector<Long64_t> &entries,
+		TString treeName, int nThreads) {
+	/// \MemberDescr
+	/// \param fileNames : Input files
+	/// \param entries : Number of entries of each file if already known, else kPending
+	/// \param treeName : Name of the tree whose entries are counted
+	/// \param nThreads : Number of scanning threads
+	/// \return False if the threads are already running or if there is nothing to scan
+	///
+	/// Start scanning the files with an unknown number of entries
+	/// \EndMemberDescr
+
+	if(fThreads.size()>0 || nThreads<=0) return false;
+
+	fFileNames = fileNames;
+	fEntries = entries;
+	fEntries.resize(fFileNames.size(), kPending);
+	fTreeName = treeName;
+	fNext = 0;
+	fNPending = 0;
+	for(auto nEntries : fEntries){
+		if(nEntries==kPending) ++fNPending;
+	}
+	if(fNPending==0) return false;
+
+	TThread::Initialize();
+	ROOT::EnableThreadSafety();
+	fStop = false;
+	if(nThreads>fNPending) nThreads = fNPending;
+	for(int i=0; i<nThreads; ++i){
+		TThread *thread = new TThread(TString::Format("InputScanner%i", i), (void (*)(void*))&Run, (void*) this);
+		thread->Run();
+		fThreads.push_back(thread);
+	}
+	std::cout << "Scanning " << fNPending << " input files in background (" << nThreads << " threads)" << std::endl;
+	return true;
+}
+
+void InputScanner::Stop() {
+	/// \MemberDescr
+	/// Stop the threads after the files being scanned are done
+	/// \EndMemberDescr
+
+	if(fThreads.size()==0) return;
+
+	fMutex.Lock();
+	fStop = true;
+	fMutex.UnLock();
+	for(auto thread : fThreads){
+		thread->Join();
+		delete thread;
+	}
+	fThreads.clear();
+}
+
+Long64_t InputScanner::GetEntries(unsigned int index) {
+	/// \MemberDescr
+	/// \param index : Index of the file in the list
+	/// \return Number of entries of the file, kInvalid if it cannot be read, kPending if it
+	/// is not scanned yet
+	/// \EndMemberDescr
+
+	if(index>=fEntries.size()) return kPending;
+	fMutex.Lock();
+	Long64_t nEntries = fEntries[index];
+	fMutex.UnLock();
+	return nEntries;
+}
+
+int InputScanner::GetNPending() {
+	/// \MemberDescr
+	/// \return Number of files not scanned yet
+	/// \EndMemberDescr
+
+	fMutex.Lock();
+	int nPending = fNPending;
+	fMutex.UnLock();
+	return nPending;
+}
+
+Long64_t InputScanner::ScanFile(TString fileName) const {
+	/// \MemberDescr
+	/// \param fileName : Path to the file
+	/// \return Number of entries of the tree, kInvalid if the file or the tree cannot be read
+	/// \EndMemberDescr
+
+	Long64_t nEntries = kInvalid;
+	TFile *fd = TFile::Open(fileName, "READ");
+	if(fd && !fd->IsZombie()){
+		TTree *tree = (TTree*)fd->Get(fTreeName);
+		if(tree) nEntries = tree->GetEntries();
+		fd->Close();
+	}
+	if(fd) delete fd;
+	return nEntries;
+}
+
+void InputScanner::Run(void* args) {
+	/// \MemberDescr
+	/// \param args : Pointer to the InputScanner instance
+	///
+	/// Scanning thread: take the next file to scan until all files are scanned or Stop()
+	/// is called
+	/// \EndMemberDescr
+
+	InputScanner *scanner = static_cast<InputScanner*>(args);
+	TraceRecorder *trace = TraceRecorder::GetInstance();
+	trace->SetThreadName("InputScanner");
+
+	while(true){
+		scanner->fMutex.Lock();
+		while(scanner->fNext<scanner->fEntries.size() && scanner->fEntries[scanner->fNext]!=kPending)
+			++scanner->fNext;
+		if(scanner->fStop || scanner->fNext>=scanner->fEntries.size()){
+			scanner->fMutex.UnLock();
+			break;
+		}
+		unsigned int index = scanner->fNext++;
+		scanner->fMutex.UnLock();
+
+		if(trace->IsEnabled()) trace->Begin("ScanFile", "IO");
+		Long64_t nEntries = scanner->ScanFile(scanner->fFileNames[index]);
+		if(trace->IsEnabled()) trace->End("ScanFile", "IO");
+
+		scanner->fMutex.Lock();
+		scanner->fEntries[index] = nEntries;
+		--scanner->fNPending;
+		scanner->fMutex.UnLock();
+	}
+}
+
+} /* namespace Core */
+} /* namespace NA62Analysis */
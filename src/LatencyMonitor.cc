@@ -0,0 +1,264 @@
+/*
+ * LatencyMonitor.cc
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ncl
+ */
+
+#include "LatencyMonitor.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iostream>
+
+#include <TH1D.h>
+#include <TGraph.h>
+
+#include "StringTable.hh"
+
+namespace NA62Analysis {
+namespace Core {
+
+LatencyMonitor::LatencyMonitor() :
+	fNEvents(0),
+	fTotalTime(0),
+	fMaxTime(0),
+	fBuckets(fgBucketsPerDecade*fgNDecades+2, 0)
+{
+	/// \MemberDescr
+	/// Constructor
+	/// \EndMemberDescr
+}
+
+LatencyMonitor::~LatencyMonitor() {
+	/// \MemberDescr
+	/// Destructor
+	/// \EndMemberDescr
+}
+
+void LatencyMonitor::Reset() {
+	/// \MemberDescr
+	/// Forget all the recorded events and bursts
+	/// \EndMemberDescr
+
+	fNEvents = 0;
+	fTotalTime = 0;
+	fMaxTime = 0;
+	std::fill(fBuckets.begin(), fBuckets.end(), 0);
+	fBursts.clear();
+	fSlowest.clear();
+	fBurstTime.Reset();
+}
+
+void LatencyMonitor::AddEvent(Long64_t iEvent, float time) {
+	/// \MemberDescr
+	/// \param iEvent : Index of the event
+	/// \param time : Processing time of the event in seconds
+	///
+	/// Record the processing time of an event
+	/// \EndMemberDescr
+
+	++fNEvents;
+	fTotalTime += time;
+	if(time>fMaxTime) fMaxTime = time;
+	++fBuckets[GetBucket(time)];
+
+	if(fBursts.size()>0){
+		++fBursts.back().fNEvents;
+		if(time>fBursts.back().fMaxTime) fBursts.back().fMaxTime = time;
+	}
+
+	if(fSlowest.size()<fgNSlowest || time>fSlowest.back().first){
+		fSlowest.push_back(std::make_pair(time, iEvent));
+		std::sort(fSlowest.begin(), fSlowest.end(), std::greater<std::pair<float, Long64_t> >());
+		if(fSlowest.size()>fgNSlowest) fSlowest.pop_back();
+	}
+}
+
+void LatencyMonitor::NewBurst(int burstIndex) {
+	/// \MemberDescr
+	/// \param burstIndex : Index of the new burst
+	///
+	/// Close the current burst (if any) and start recording a new one. The first burst is
+	/// started before the event loop: if no event was recorded yet, it is only restarted
+	/// with the index of the file actually opened.
+	/// \EndMemberDescr
+
+	if(fBursts.size()==1 && fBursts.back().fNEvents==0){
+		fBursts.back().fBurstIndex = burstIndex;
+		fBurstTime.Reset();
+		fBurstTime.Start();
+		return;
+	}
+	EndBurst();
+	BurstRecord burst;
+	burst.fBurstIndex = burstIndex;
+	burst.fNEvents = 0;
+	burst.fDuration = 0;
+	burst.fMaxTime = 0;
+	fBursts.push_back(burst);
+	fBurstTime.Reset();
+	fBurstTime.Start();
+}
+
+void LatencyMonitor::EndBurst() {
+	/// \MemberDescr
+	/// Close the current burst
+	/// \EndMemberDescr
+
+	if(fBursts.size()==0 || fBurstTime.GetNCalls()==0) return;
+	fBurstTime.Stop();
+	fBursts.back().fDuration = fBurstTime.GetTotalTime();
+	fBurstTime.Reset();
+}
+
+float LatencyMonitor::GetPercentile(double q) const {
+	/// \MemberDescr
+	/// \param q : Requested quantile (between 0 and 1)
+	/// \return Upper edge of the bucket containing the requested quantile
+	/// (bounded by the largest recorded time)
+	/// \EndMemberDescr
+
+	if(fNEvents==0) return 0;
+
+	Long64_t target = std::max((Long64_t)1, (Long64_t)std::ceil(q*fNEvents));
+	Long64_t sum = 0;
+	for(unsigned int i=0; i<fBuckets.size()-1; ++i){
+		sum += fBuckets[i];
+		if(sum>=target) return std::min((float)GetBucketLowEdge(i+1), fMaxTime);
+	}
+	return fMaxTime;
+}
+
+void LatencyMonitor::Print() const {
+	/// \MemberDescr
+	/// Print the percentiles of the event processing time and the list of slowest events
+	/// \EndMemberDescr
+
+	if(fNEvents==0) return;
+
+	std::cout << std::endl << "Event processing time (ms): mean " << TString::Format("%.4f", 1000.*GetMean())
+			<< ", p50 " << TString::Format("%.4f", 1000.*GetPercentile(0.5))
+			<< ", p90 " << TString::Format("%.4f", 1000.*GetPercentile(0.9))
+			<< ", p99 " << TString::Format("%.4f", 1000.*GetPercentile(0.99))
+			<< ", max " << TString::Format("%.4f", 1000.*fMaxTime) << std::endl;
+
+	StringTable slowTable("Slowest events");
+	slowTable.AddColumn("event", "Event");
+	slowTable.AddColumn("time", "Time (ms)");
+	slowTable << sepr;
+	for(auto it : fSlowest){
+		slowTable << TString::Format("%lld", it.second) << TString::Format("%.4f", 1000.*it.first);
+	}
+	slowTable.Print("");
+}
+
+void LatencyMonitor::Write() const {
+	/// \MemberDescr
+	/// Write the distribution of the event processing time (EventLatency) and the number
+	/// of events processed per second in each burst (BurstRate, BurstMaxLatency) in the
+	/// current ROOT directory.
+	/// \EndMemberDescr
+
+	int nBuckets = fBuckets.size()-2;
+	std::vector<double> edges(nBuckets+1);
+	for(int i=0; i<=nBuckets; ++i) edges[i] = GetBucketLowEdge(i+1);
+
+	TH1D latency("EventLatency", "Event processing time;Time (s);Events", nBuckets, edges.data());
+	for(unsigned int i=0; i<fBuckets.size(); ++i) latency.SetBinContent(i, fBuckets[i]);
+	latency.SetEntries(fNEvents);
+	latency.Write();
+
+	TGraph rate(fBursts.size());
+	TGraph maxLatency(fBursts.size());
+	rate.SetNameTitle("BurstRate", "Events processed per second;Burst;Events/s");
+	maxLatency.SetNameTitle("BurstMaxLatency", "Largest event processing time;Burst;Time (s)");
+	for(unsigned int i=0; i<fBursts.size(); ++i){
+		rate.SetPoint(i, fBursts[i].fBurstIndex, fBursts[i].fDuration>0 ? fBursts[i].fNEvents/fBursts[i].fDuration : 0);
+		maxLatency.SetPoint(i, fBursts[i].fBurstIndex, fBursts[i].fMaxTime);
+	}
+	rate.Write();
+	maxLatency.Write();
+}
+
+bool LatencyMonitor::WriteJSON(TString fileName) const {
+	/// \MemberDescr
+	/// \param fileName : Path to the JSON file
+	/// \return False if the file cannot be opened
+	///
+	/// Dump the percentiles, non-empty buckets, bursts and slowest events in a JSON file.
+	/// \EndMemberDescr
+
+	std::ofstream fd(fileName.Data(), std::ofstream::out);
+	if(!fd.is_open()){
+		std::cout << "Unable to open latency file " << fileName << std::endl;
+		return false;
+	}
+
+	fd << "{" << std::endl;
+	fd << "  \"events\": " << fNEvents << "," << std::endl;
+	fd << "  \"mean\": " << GetMean() << "," << std::endl;
+	fd << "  \"p50\": " << GetPercentile(0.5) << "," << std::endl;
+	fd << "  \"p90\": " << GetPercentile(0.9) << "," << std::endl;
+	fd << "  \"p99\": " << GetPercentile(0.99) << "," << std::endl;
+	fd << "  \"max\": " << fMaxTime << "," << std::endl;
+
+	fd << "  \"buckets\": [";
+	bool first = true;
+	for(unsigned int i=0; i<fBuckets.size(); ++i){
+		if(fBuckets[i]==0) continue;
+		fd << (first ? "" : ",") << std::endl << "    {\"low\": " << (i==0 ? 0 : GetBucketLowEdge(i))
+				<< ", \"high\": " << (i==fBuckets.size()-1 ? fMaxTime : GetBucketLowEdge(i+1))
+				<< ", \"count\": " << fBuckets[i] << "}";
+		first = false;
+	}
+	fd << std::endl << "  ]," << std::endl;
+
+	fd << "  \"bursts\": [";
+	for(unsigned int i=0; i<fBursts.size(); ++i){
+		fd << (i==0 ? "" : ",") << std::endl << "    {\"burst\": " << fBursts[i].fBurstIndex
+				<< ", \"events\": " << fBursts[i].fNEvents
+				<< ", \"duration\": " << fBursts[i].fDuration
+				<< ", \"rate\": " << (fBursts[i].fDuration>0 ? fBursts[i].fNEvents/fBursts[i].fDuration : 0)
+				<< ", \"max\": " << fBursts[i].fMaxTime << "}";
+	}
+	fd << std::endl << "  ]," << std::endl;
+
+	fd << "  \"slowest\": [";
+	for(unsigned int i=0; i<fSlowest.size(); ++i){
+		fd << (i==0 ? "" : ",") << std::endl << "    {\"event\": " << fSlowest[i].second
+				<< ", \"time\": " << fSlowest[i].first << "}";
+	}
+	fd << std::endl << "  ]" << std::endl;
+	fd << "}" << std::endl;
+	fd.close();
+	return true;
+}
+
+int LatencyMonitor::GetBucket(float time) {
+	/// \MemberDescr
+	/// \param time : Processing time in seconds
+	/// \return Index of the bucket (0 is underflow, last is overflow)
+	/// \EndMemberDescr
+
+	int nBuckets = fgBucketsPerDecade*fgNDecades;
+	if(time<=0) return 0;
+	int bucket = (int)std::floor((std::log10(time)-fgMinExponent)*fgBucketsPerDecade)+1;
+	if(bucket<0) return 0;
+	if(bucket>nBuckets) return nBuckets+1;
+	return bucket;
+}
+
+double LatencyMonitor::GetBucketLowEdge(int bucket) {
+	/// \MemberDescr
+	/// \param bucket : Index of the bucket (1 for the first non-underflow bucket)
+	/// \return Lower edge of the bucket in seconds
+	/// \EndMemberDescr
+
+	return std::pow(10., fgMinExponent + (bucket-1)/(double)fgBucketsPerDecade);
+}
+
+} /* namespace Core */
+} /* namespace NA62Analysis */
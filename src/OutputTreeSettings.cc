@@ -0,0 +1,276 @@
+/*
+ * OutputTreeSettings.cc
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ncl
+ */
+
+#include "OutputTreeSettings.hh"
+
+#include <iostream>
+
+#include <TTree.h>
+#include <TFile.h>
+#include <TBranch.h>
+#include <TObjArray.h>
+#include <TObjString.h>
+#include <TSystem.h>
+
+#include "StringTable.hh"
+
+namespace NA62Analysis {
+namespace Core {
+
+OutputTreeSettings *OutputTreeSettings::fOutputTreeSettings = 0;
+
+OutputTreeSettings* OutputTreeSettings::GetInstance() {
+	/// \MemberDescr
+	/// \return Pointer to the unique instance of OutputTreeSettings
+	/// \EndMemberDescr
+
+	if(!fOutputTreeSettings) fOutputTreeSettings = new OutputTreeSettings();
+	return fOutputTreeSettings;
+}
+
+OutputTreeSettings::OutputTreeSettings() {
+	/// \MemberDescr
+	/// Default private constructor to ensure uniqueness of the instance
+	/// \EndMemberDescr
+}
+
+OutputTreeSettings::~OutputTreeSettings() {
+	/// \MemberDescr
+	/// Destructor
+	/// \EndMemberDescr
+}
+
+bool OutputTreeSettings::SetSettings(TString treeName, TString settings) {
+	/// \MemberDescr
+	/// \param treeName : Name of the tree ("Default" for all trees, "File" for the output file)
+	/// \param settings : algorithm:level[:basketSize[:autoFlush]]
+	/// \return False if the settings cannot be parsed
+	///
+	/// Set the settings of a tree. Replaces the previous settings for this tree.
+	/// \EndMemberDescr
+
+	Settings s;
+	s.fAlgorithm = -1;
+	s.fLevel = -1;
+	s.fBasketSize = 0;
+	s.fAutoFlush = 0;
+	s.fString = settings;
+
+	//Tokenize() would drop the empty fields
+	std::vector<TString> fields;
+	Ssiz_t start = 0, pos;
+	while((pos = settings.Index(":", start))!=kNPOS){
+		fields.push_back(TString(settings(start, pos-start)).Strip(TString::kBoth));
+		start = pos+1;
+	}
+	fields.push_back(TString(settings(start, settings.Length()-start)).Strip(TString::kBoth));
+
+	bool valid = fields.size()<=4 && fields[0].Length()>0;
+	for(unsigned int i=0; valid && i<fields.size(); ++i){
+		TString field = fields[i];
+		if(field.Length()==0) continue;
+		if(i==0){
+			valid = (s.fAlgorithm = GetAlgorithm(field))>=0;
+			continue;
+		}
+		bool negative = (i==3 && field[0]=='-');
+		if(negative) field.Remove(0, 1);
+		if(!field.IsDec()) valid = false;
+		else if(i==1) s.fLevel = field.Atoi();
+		else if(i==2) s.fBasketSize = field.Atoi();
+		else if(i==3) s.fAutoFlush = negative ? -field.Atoll() : field.Atoll();
+	}
+
+	if(!valid){
+		std::cout << "Invalid output settings for " << treeName << ": " << settings << std::endl;
+		std::cout << "Expected algorithm:level[:basketSize[:autoFlush]]" << std::endl;
+		return false;
+	}
+	fSettings[treeName] = s;
+	return true;
+}
+
+bool OutputTreeSettings::SetSettingsList(TString settingsList) {
+	/// \MemberDescr
+	/// \param settingsList : Comma separated list of TreeName=settings
+	/// \return False if one of the settings cannot be parsed
+	/// \EndMemberDescr
+
+	bool valid = true;
+	TObjArray *entries = settingsList.Tokenize(",");
+	for(int i=0; i<entries->GetEntries(); ++i){
+		TString entry = ((TObjString*)entries->At(i))->GetString();
+		Ssiz_t pos = entry.First('=');
+		if(pos==kNPOS){
+			std::cout << "Invalid output settings " << entry << ": expected TreeName=settings" << std::endl;
+			valid = false;
+			continue;
+		}
+		valid = SetSettings(TString(entry(0, pos)).Strip(TString::kBoth), TString(entry(pos+1, entry.Length())).Strip(TString::kBoth)) && valid;
+	}
+	delete entries;
+	return valid;
+}
+
+void OutputTreeSettings::ApplyToFile(TFile* fd) {
+	/// \MemberDescr
+	/// \param fd : Output file
+	///
+	/// Apply the compression settings of "File" to the output file
+	/// \EndMemberDescr
+
+	const Settings *s = GetSettings("File");
+	if(!fd || !s || s->fAlgorithm<0) return;
+	fd->SetCompressionSettings(s->fAlgorithm*100 + (s->fLevel>=0 ? s->fLevel : 1));
+}
+
+void OutputTreeSettings::Apply(TTree* tree) {
+	/// \MemberDescr
+	/// \param tree : Output tree
+	///
+	/// Apply the settings of this tree (or "Default") to all its branches and record the
+	/// tree for the final report. Can be called again when new branches are added.
+	/// \EndMemberDescr
+
+	const Settings *s = GetSettings(tree->GetName());
+	if(!s) s = GetSettings("Default");
+	if(!s) return;
+
+	if(s->fAlgorithm>=0){
+		int compression = s->fAlgorithm*100 + (s->fLevel>=0 ? s->fLevel : 1);
+		TObjArray *branches = tree->GetListOfBranches();
+		for(int i=0; i<branches->GetEntriesFast(); ++i)
+			((TBranch*)branches->UncheckedAt(i))->SetCompressionSettings(compression);
+	}
+	if(s->fBasketSize>0) tree->SetBasketSize("*", s->fBasketSize);
+	if(s->fAutoFlush!=0) tree->SetAutoFlush(s->fAutoFlush);
+
+	fMutex.Lock();
+	if(fTrees.count(tree)==0){
+		TreeRecord record;
+		record.fName = tree->GetName();
+		record.fSettings = s->fString;
+		record.fEntries = 0;
+		record.fTotBytes = 0;
+		record.fZipBytes = 0;
+		record.fFillTime = 0;
+		fTrees.insert(std::pair<TTree*, TreeRecord>(tree, record));
+	}
+	fMutex.UnLock();
+}
+
+void OutputTreeSettings::AddFillTime(TTree* tree, double time) {
+	/// \MemberDescr
+	/// \param tree : Output tree
+	/// \param time : Time spent in TTree::Fill
+	/// \EndMemberDescr
+
+	fMutex.Lock();
+	auto it = fTrees.find(tree);
+	if(it!=fTrees.end()) it->second.fFillTime += time;
+	fMutex.UnLock();
+}
+
+void OutputTreeSettings::Collect() {
+	/// \MemberDescr
+	/// Read the size of the recorded trees. Must be called after the trees are written and
+	/// before the output file is closed.
+	/// \EndMemberDescr
+
+	fMutex.Lock();
+	for(auto &it : fTrees){
+		it.second.fEntries = it.first->GetEntries();
+		it.second.fTotBytes = it.first->GetTotBytes();
+		it.second.fZipBytes = it.first->GetZipBytes();
+		fCollected.push_back(it.second);
+	}
+	fTrees.clear();
+	fMutex.UnLock();
+}
+
+void OutputTreeSettings::Collect(TTree* tree) {
+	/// \MemberDescr
+	/// \param tree : Output tree
+	///
+	/// Read the size of a single recorded tree and forget it. Must be called after the tree
+	/// is written and before its file is closed.
+	/// \EndMemberDescr
+
+	fMutex.Lock();
+	auto it = fTrees.find(tree);
+	if(it!=fTrees.end()){
+		it->second.fEntries = tree->GetEntries();
+		it->second.fTotBytes = tree->GetTotBytes();
+		it->second.fZipBytes = tree->GetZipBytes();
+		if(tree->GetCurrentFile())
+			it->second.fName += TString(" (") + gSystem->BaseName(tree->GetCurrentFile()->GetName()) + ")";
+		fCollected.push_back(it->second);
+		fTrees.erase(it);
+	}
+	fMutex.UnLock();
+}
+
+void OutputTreeSettings::Print() const {
+	/// \MemberDescr
+	/// Print the size, compression ratio and writing throughput of the configured trees
+	/// \EndMemberDescr
+
+	if(fCollected.size()==0) return;
+
+	StringTable outTable("Output trees");
+	outTable.AddColumn("tree", "Tree");
+	outTable.AddColumn("settings", "Settings");
+	outTable.AddColumn("entries", "Entries");
+	outTable.AddColumn("unzip", "Uncompressed (MB)");
+	outTable.AddColumn("zip", "Compressed (MB)");
+	outTable.AddColumn("ratio", "Ratio");
+	outTable.AddColumn("time", "Fill (s)");
+	outTable.AddColumn("rate", "Throughput (MB/s)");
+	outTable << sepr;
+	for(auto record : fCollected){
+		outTable << record.fName
+				<< record.fSettings
+				<< TString::Format("%lld", record.fEntries)
+				<< TString::Format("%.2f", record.fTotBytes/1048576.)
+				<< TString::Format("%.2f", record.fZipBytes/1048576.)
+				<< TString::Format("%.2f", record.fZipBytes>0 ? (double)record.fTotBytes/record.fZipBytes : 0.)
+				<< TString::Format("%.3f", record.fFillTime)
+				<< TString::Format("%.1f", record.fFillTime>0 ? record.fTotBytes/1048576./record.fFillTime : 0.);
+	}
+	std::cout << std::endl;
+	outTable.Print("");
+}
+
+int OutputTreeSettings::GetAlgorithm(TString name) {
+	/// \MemberDescr
+	/// \param name : Name or number of the compression algorithm
+	/// \return ROOT compression algorithm number, -1 if unknown
+	/// \EndMemberDescr
+
+	name.ToLower();
+	if(name.IsDec()) return name.Atoi();
+	if(name.CompareTo("zlib")==0) return 1;
+	if(name.CompareTo("lzma")==0) return 2;
+	if(name.CompareTo("old")==0) return 3;
+	if(name.CompareTo("lz4")==0) return 4;
+	if(name.CompareTo("zstd")==0) return 5;
+	return -1;
+}
+
+const OutputTreeSettings::Settings* OutputTreeSettings::GetSettings(TString treeName) const {
+	/// \MemberDescr
+	/// \param treeName : Name of the tree
+	/// \return Settings of the tree, nullptr if not configured
+	/// \EndMemberDescr
+
+	auto it = fSettings.find(treeName);
+	if(it==fSettings.end()) return nullptr;
+	return &it->second;
+}
+
+} /* namespace Core */
+} /* namespace NA62Analysis */
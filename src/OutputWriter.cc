@@ -0,0 +1,392 @@
+/*
+ * OutputWriter.cc
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ncl
+ */
+
+#include "OutputWriter.hh"
+
+#include <iostream>
+
+#include <TTree.h>
+#include <TBranch.h>
+#include <TBranchElement.h>
+#include <TLeaf.h>
+#include <TLeafC.h>
+#include <TClass.h>
+#include <TBufferFile.h>
+#include <TThread.h>
+#include <TROOT.h>
+
+#include "TimeCounter.h"
+#include "TraceRecorder.hh"
+#include "OutputTreeSettings.hh"
+
+namespace NA62Analysis {
+namespace Core {
+
+OutputWriter *OutputWriter::fOutputWriter = 0;
+
+OutputWriter* OutputWriter::GetInstance() {
+	/// \MemberDescr
+	/// \return Pointer to the unique instance of OutputWriter
+	/// \EndMemberDescr
+
+	if(!fOutputWriter) fOutputWriter = new OutputWriter();
+	return fOutputWriter;
+}
+
+OutputWriter::OutputWriter() :
+	fRunning(false),
+	fStop(false),
+	fBusy(false),
+	fQueueSize(0),
+	fThread(nullptr),
+	fNotEmpty(&fQueueMutex),
+	fNotFull(&fQueueMutex),
+	fIdle(&fQueueMutex),
+	fNJobs(0),
+	fNSync(0),
+	fMaxDepth(0),
+	fNWaits(0),
+	fWaitTime(0),
+	fWriterTime(0)
+{
+	/// \MemberDescr
+	/// Default private constructor to ensure uniqueness of the instance
+	/// \EndMemberDescr
+}
+
+OutputWriter::~OutputWriter() {
+	/// \MemberDescr
+	/// Destructor. Stop the writer thread.
+	/// \EndMemberDescr
+
+	Stop();
+	for(auto it : fSlots) delete it.second;
+	for(auto buffer : fFreeBuffers) delete buffer;
+}
+
+bool OutputWriter::Start(unsigned int queueSize) {
+	/// \MemberDescr
+	/// \param queueSize : Maximum number of entries waiting to be filled
+	/// \return False if the writer is already running
+	///
+	/// Start the writer thread. From now on, the trees filled through Fill() are
+	/// filled by the writer thread. The files and directories must then only be
+	/// created, written or closed from the main thread after Sync().
+	/// \EndMemberDescr
+
+	if(fRunning) return false;
+
+	TThread::Initialize();
+	ROOT::EnableThreadSafety();
+	fQueueSize = queueSize>0 ? queueSize : 1;
+	fStop = false;
+	fBusy = false;
+	fRunning = true;
+	fThread = new TThread("OutputWriter", (void (*)(void*))&Run, (void*) this);
+	fThread->Run();
+	std::cout << "Output trees filled in background (queue size " << fQueueSize << ")" << std::endl;
+	return true;
+}
+
+void OutputWriter::Stop() {
+	/// \MemberDescr
+	/// Process all the pending entries, stop the writer thread and restore the original
+	/// branch addresses of the trees.
+	/// \EndMemberDescr
+
+	if(!fRunning) return;
+
+	fQueueMutex.Lock();
+	fStop = true;
+	fNotEmpty.Broadcast();
+	fQueueMutex.UnLock();
+	fThread->Join();
+	delete fThread;
+	fThread = nullptr;
+	fRunning = false;
+
+	for(auto it : fSlots){
+		if(it.second->fAsync) Detach(it.second);
+	}
+}
+
+void OutputWriter::Sync() {
+	/// \MemberDescr
+	/// Wait until all the pending entries have been filled. As long as Fill() is not
+	/// called again, the output file can then be safely accessed from the calling thread.
+	/// \EndMemberDescr
+
+	if(!fRunning) return;
+
+	fQueueMutex.Lock();
+	while(fQueue.size()>0 || fBusy) fIdle.Wait();
+	fQueueMutex.UnLock();
+}
+
+void OutputWriter::Fill(TTree* tree) {
+	/// \MemberDescr
+	/// \param tree : Tree to fill
+	///
+	/// Fill the tree with the current content of the objects attached to its branches.
+	/// If the writer thread is running and the tree is supported, the content is copied
+	/// and the tree is filled later by the writer thread. Otherwise it is filled immediately.
+	/// \EndMemberDescr
+
+	using NA62Analysis::operator -;
+
+	if(!fRunning){
+		FillTree(tree);
+		return;
+	}
+
+	TreeSlot *slot = GetSlot(tree);
+	if(!slot->fAsync){
+		fFileMutex.Lock();
+		FillTree(tree);
+		fFileMutex.UnLock();
+		++fNSync;
+		return;
+	}
+
+	Job job;
+	job.fSlot = slot;
+	fQueueMutex.Lock();
+	if(fFreeBuffers.size()>0){
+		job.fBuffer = fFreeBuffers.back();
+		fFreeBuffers.pop_back();
+	}
+	else job.fBuffer = nullptr;
+	fQueueMutex.UnLock();
+	if(!job.fBuffer) job.fBuffer = new TBufferFile(TBuffer::kWrite);
+
+	for(unsigned int i=0; i<slot->fSources.size(); ++i){
+		if(slot->fClasses[i]) slot->fClasses[i]->Streamer(slot->fSources[i], *job.fBuffer);
+		else job.fBuffer->WriteFastArray((char*)slot->fSources[i], slot->fSizes[i]);
+	}
+
+	fQueueMutex.Lock();
+	if(fQueue.size()>=fQueueSize){
+		//Back-pressure: the writer is late
+		struct timespec waitStart = TimeCounter::GetTime();
+		++fNWaits;
+		while(fQueue.size()>=fQueueSize) fNotFull.Wait();
+		fWaitTime += TimeCounter::GetTime() - waitStart;
+	}
+	fQueue.push_back(job);
+	if(fQueue.size()>fMaxDepth) fMaxDepth = fQueue.size();
+	fNotEmpty.Signal();
+	fQueueMutex.UnLock();
+}
+
+void OutputWriter::Release(TTree* tree) {
+	/// \MemberDescr
+	/// \param tree : Tree
+	///
+	/// Fill the pending entries and forget the tree, which can then be deleted
+	/// (e.g. when its output file is closed).
+	/// \EndMemberDescr
+
+	auto it = fSlots.find(tree);
+	if(it==fSlots.end()) return;
+	Sync();
+	if(it->second->fTargets.size()>0) Detach(it->second);
+	delete it->second;
+	fSlots.erase(it);
+}
+
+void OutputWriter::PrintSummary() const {
+	/// \MemberDescr
+	/// Print the number of entries filled by the writer and the time the event loop
+	/// spent waiting for it.
+	/// \EndMemberDescr
+
+	if(fNJobs==0 && fNSync==0) return;
+
+	std::cout << std::endl << "Background output writer: " << fNJobs << " entries filled in background, "
+			<< fNSync << " immediately" << std::endl;
+	std::cout << " - Writer busy time: " << TString::Format("%.2f", fWriterTime) << " seconds" << std::endl;
+	std::cout << " - Largest queue depth: " << fMaxDepth << "/" << fQueueSize << std::endl;
+	std::cout << " - Event loop waited " << fNWaits << " times for the writer ("
+			<< TString::Format("%.2f", fWaitTime) << " seconds)" << std::endl;
+	if(fNWaits>0)
+		std::cout << "   The writer is falling behind: consider increasing WriterQueueSize or"
+				" using a faster compression." << std::endl;
+}
+
+OutputWriter::TreeSlot* OutputWriter::GetSlot(TTree* tree) {
+	/// \MemberDescr
+	/// \param tree : Tree
+	/// \return Slot of the tree. Created (and the branches redirected to the writer copies)
+	/// on the first call.
+	/// \EndMemberDescr
+
+	auto it = fSlots.find(tree);
+	if(it!=fSlots.end()){
+		if(it->second->fAsync && it->second->fTargets.size()==0) Attach(it->second);
+		return it->second;
+	}
+
+	TreeSlot *slot = new TreeSlot();
+	slot->fTree = tree;
+	slot->fAsync = true;
+	fSlots.insert(std::pair<TTree*, TreeSlot*>(tree, slot));
+
+	TObjArray *branches = tree->GetListOfBranches();
+	for(int i=0; slot->fAsync && i<branches->GetEntriesFast(); ++i){
+		TBranch *branch = (TBranch*)branches->UncheckedAt(i);
+		TClass *cl = nullptr;
+		void *source = nullptr;
+		void *address = branch->GetAddress();
+		Int_t size = 0;
+		if(branch->InheritsFrom(TBranchElement::Class())){
+			cl = TClass::GetClass(static_cast<TBranchElement*>(branch)->GetClassName());
+			source = static_cast<TBranchElement*>(branch)->GetObject();
+			if(!cl) slot->fAsync = false;
+		}
+		else{
+			source = branch->GetAddress();
+			TObjArray *leaves = branch->GetListOfLeaves();
+			for(int j=0; j<leaves->GetEntriesFast(); ++j){
+				TLeaf *leaf = (TLeaf*)leaves->UncheckedAt(j);
+				if(leaf->GetLeafCount() || leaf->InheritsFrom(TLeafC::Class())) slot->fAsync = false;
+				size += leaf->GetLenType()*leaf->GetLenStatic();
+			}
+		}
+		if(!source) slot->fAsync = false;
+		slot->fBranchNames.push_back(branch->GetName());
+		slot->fClasses.push_back(cl);
+		slot->fSources.push_back(source);
+		slot->fAddresses.push_back(address);
+		slot->fSizes.push_back(size);
+	}
+
+	if(slot->fAsync) Attach(slot);
+	else std::cout << "Tree " << tree->GetName() << " contains branches not supported by the "
+			"background writer. It will be filled immediately." << std::endl;
+	return slot;
+}
+
+void OutputWriter::Attach(TreeSlot* slot) {
+	/// \MemberDescr
+	/// \param slot : Slot of the tree
+	///
+	/// Create the copies owned by the writer and redirect the branches of the tree to them
+	/// \EndMemberDescr
+
+	slot->fTargets.resize(slot->fSources.size());
+	for(unsigned int i=0; i<slot->fSources.size(); ++i){
+		if(slot->fClasses[i]){
+			slot->fTargets[i] = slot->fClasses[i]->New();
+			slot->fTree->SetBranchAddress(slot->fBranchNames[i], (void*)&slot->fTargets[i]);
+		}
+		else{
+			slot->fTargets[i] = new char[slot->fSizes[i]];
+			slot->fTree->SetBranchAddress(slot->fBranchNames[i], slot->fTargets[i]);
+		}
+	}
+}
+
+void OutputWriter::Detach(TreeSlot* slot) {
+	/// \MemberDescr
+	/// \param slot : Slot of the tree
+	///
+	/// Restore the original branch addresses of the tree and delete the copies
+	/// \EndMemberDescr
+
+	for(unsigned int i=0; i<slot->fTargets.size(); ++i){
+		if(slot->fClasses[i]){
+			slot->fTree->SetBranchAddress(slot->fBranchNames[i], slot->fAddresses[i]);
+			slot->fClasses[i]->Destructor(slot->fTargets[i]);
+		}
+		else{
+			slot->fTree->SetBranchAddress(slot->fBranchNames[i], slot->fAddresses[i]);
+			delete[] (char*)slot->fTargets[i];
+		}
+	}
+	slot->fTargets.clear();
+}
+
+void OutputWriter::Process(Job& job) {
+	/// \MemberDescr
+	/// \param job : Job to process
+	///
+	/// Restore the content of the buffer in the copies and fill the tree
+	/// \EndMemberDescr
+
+	TreeSlot *slot = job.fSlot;
+	job.fBuffer->SetReadMode();
+	job.fBuffer->SetBufferOffset(0);
+	job.fBuffer->ResetMap();
+	for(unsigned int i=0; i<slot->fTargets.size(); ++i){
+		if(slot->fClasses[i]) slot->fClasses[i]->Streamer(slot->fTargets[i], *job.fBuffer);
+		else job.fBuffer->ReadFastArray((char*)slot->fTargets[i], slot->fSizes[i]);
+	}
+
+	fFileMutex.Lock();
+	FillTree(slot->fTree);
+	fFileMutex.UnLock();
+
+	job.fBuffer->SetWriteMode();
+	job.fBuffer->SetBufferOffset(0);
+	job.fBuffer->ResetMap();
+}
+
+void OutputWriter::FillTree(TTree* tree) {
+	/// \MemberDescr
+	/// \param tree : Tree to fill
+	///
+	/// Fill the tree and report the time spent to OutputTreeSettings
+	/// \EndMemberDescr
+
+	using NA62Analysis::operator -;
+	struct timespec start = TimeCounter::GetTime();
+	tree->Fill();
+	OutputTreeSettings::GetInstance()->AddFillTime(tree, TimeCounter::GetTime() - start);
+}
+
+void OutputWriter::Run(void* args) {
+	/// \MemberDescr
+	/// \param args : Pointer to the OutputWriter instance
+	///
+	/// Writer thread: process the jobs until Stop() is called and the queue is empty
+	/// \EndMemberDescr
+
+	using NA62Analysis::operator -;
+	OutputWriter *writer = static_cast<OutputWriter*>(args);
+	TraceRecorder *trace = TraceRecorder::GetInstance();
+	trace->SetThreadName("OutputWriter");
+
+	writer->fQueueMutex.Lock();
+	while(true){
+		while(writer->fQueue.size()==0 && !writer->fStop) writer->fNotEmpty.Wait();
+		if(writer->fQueue.size()==0) break;
+
+		Job job = writer->fQueue.front();
+		writer->fQueue.pop_front();
+		writer->fBusy = true;
+		writer->fNotFull.Signal();
+		writer->fQueueMutex.UnLock();
+
+		struct timespec start = TimeCounter::GetTime();
+		if(trace->IsEnabled()) trace->Begin(job.fSlot->fTree->GetName(), "Output");
+		writer->Process(job);
+		if(trace->IsEnabled()) trace->End(job.fSlot->fTree->GetName(), "Output");
+		float elapsed = TimeCounter::GetTime() - start;
+
+		writer->fQueueMutex.Lock();
+		writer->fWriterTime += elapsed;
+		++writer->fNJobs;
+		writer->fFreeBuffers.push_back(job.fBuffer);
+		writer->fBusy = false;
+		if(writer->fQueue.size()==0) writer->fIdle.Broadcast();
+	}
+	writer->fIdle.Broadcast();
+	writer->fQueueMutex.UnLock();
+}
+
+} /* namespace Core */
+} /* namespace NA62Analysis */
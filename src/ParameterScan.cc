@@ -0,0 +1,135 @@
+/*
+ * ParameterScan.cc
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ncl
+ */
+
+#include "ParameterScan.hh"
+
+#include <iostream>
+
+#include <TObjArray.h>
+#include <TObjString.h>
+#include <TSystem.h>
+
+#include "Analyzer.hh"
+
+namespace NA62Analysis {
+namespace Configuration {
+
+ParameterScan::ParameterScan() {
+	/// \MemberDescr
+	/// Default constructor
+	/// \EndMemberDescr
+}
+
+ParameterScan::~ParameterScan() {
+	/// \MemberDescr
+	/// Default destructor
+	/// \EndMemberDescr
+}
+
+void ParameterScan::Parse(TString scan) {
+	/// \MemberDescr
+	/// \param scan : Scan specification, or path to a configuration file containing it
+	/// \EndMemberDescr
+
+	if(!gSystem->AccessPathName(scan)) ParseFile(scan);
+	else ParseCLI(scan);
+}
+
+int ParameterScan::GetNPoints(TString analyzerName) const {
+	/// \MemberDescr
+	/// \param analyzerName : Name of the analyzer
+	/// \return Number of scan points of the analyzer, 0 if the analyzer is not scanned
+	/// \EndMemberDescr
+
+	if(!NamespaceExists(analyzerName)) return 0;
+	int nPoints = 1;
+	for(auto param : GetNamespace(analyzerName).GetParams()){
+		nPoints *= GetValues(param.second).size();
+	}
+	return nPoints;
+}
+
+std::vector<ParamPair> ParameterScan::GetPoint(TString analyzerName, int point) const {
+	/// \MemberDescr
+	/// \param analyzerName : Name of the analyzer
+	/// \param point : Index of the scan point (from 0 to GetNPoints()-1)
+	/// \return Parameter-value pairs of the scan point
+	/// \EndMemberDescr
+
+	std::vector<ParamPair> params;
+	if(point<0 || point>=GetNPoints(analyzerName)) return params;
+	for(auto param : GetNamespace(analyzerName).GetParams()){
+		std::vector<TString> values = GetValues(param.second);
+		params.push_back(ParamPair(param.first, values[point%values.size()]));
+		point /= values.size();
+	}
+	return params;
+}
+
+TString ParameterScan::GetPointDescription(TString analyzerName, int point) const {
+	/// \MemberDescr
+	/// \param analyzerName : Name of the analyzer
+	/// \param point : Index of the scan point
+	/// \return Parameters of the scan point in the command line format (param1=val1;param2=val2)
+	/// \EndMemberDescr
+
+	TString description;
+	for(auto param : GetPoint(analyzerName, point)){
+		if(description.Length()>0) description += ";";
+		description += param.first + "=" + param.second;
+	}
+	return description;
+}
+
+void ParameterScan::ApplyPoint(Analyzer* const analyzer, TString analyzerName, int point) const {
+	/// \MemberDescr
+	/// \param analyzer : Pointer to the analyzer instance of the scan point
+	/// \param analyzerName : Name of the scanned analyzer
+	/// \param point : Index of the scan point
+	///
+	/// Apply the parameters of the scan point to the analyzer (see Analyzer::ApplyParam)
+	/// \EndMemberDescr
+
+	for(auto param : GetPoint(analyzerName, point)){
+		analyzer->ApplyParam(param.first, param.second);
+	}
+}
+
+void ParameterScan::Print() const {
+	/// \MemberDescr
+	/// Print the scanned parameters and the number of scan points of each analyzer
+	/// \EndMemberDescr
+
+	for(auto &ns : fNSList){
+		std::cout << "Parameter scan of " << ns.first << ": " << GetNPoints(ns.first) << " points" << std::endl;
+		for(auto param : ns.second.GetParams()){
+			std::cout << "\t" << param.first << ": " << GetValues(param.second).size() << " values ("
+					<< param.second << ")" << std::endl;
+		}
+	}
+}
+
+std::vector<TString> ParameterScan::GetValues(TString values) {
+	/// \MemberDescr
+	/// \param values : Comma separated list of values
+	/// \return Values of the list
+	/// \EndMemberDescr
+
+	std::vector<TString> list;
+	TObjArray *tokens = values.Tokenize(",");
+	for(int i=0; i<tokens->GetEntries(); i++){
+		TString value = ((TObjString*)tokens->At(i))->GetString().Strip(TString::kBoth);
+		if(value.Length()>0) list.push_back(value);
+	}
+	tokens->Delete();
+	delete tokens;
+	if(list.size()==0) list.push_back("");
+	return list;
+}
+
+} /* namespace Configuration */
+} /* namespace NA62Analysis */
@@ -0,0 +1,558 @@
+/*
+ * StagingCache.cc
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ncl
+ */
+
+#include "StagingCache.hh"
+
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <cstdio>
+#include <cerrno>
+#include <csignal>
+#include <ctime>
+#include <set>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+
+#include <TROOT.h>
+#include <TFile.h>
+#include <TUrl.h>
+#include <TMD5.h>
+#include <TSystem.h>
+#include <TThread.h>
+#include <TObjArray.h>
+#include <TObjString.h>
+
+#include "TraceRecorder.hh"
+
+namespace NA62Analysis {
+namespace Core {
+
+StagingCache::StagingCache(TString directory, Long64_t maxSize, TString remotePrefixes, bool verify) :
+	fDirectory(directory),
+	fMaxSize(maxSize),
+	fVerify(verify),
+	fNext(0),
+	fStop(false),
+	fThread(nullptr),
+	fNHits(0),
+	fNCopied(0),
+	fNFailed(0),
+	fBytesCopied(0)
+{
+	/// \MemberDescr
+	/// \param directory : Staging directory (created if needed)
+	/// \param maxSize : Maximum total size of the copies in bytes
+	/// \param remotePrefixes : Comma separated list of prefixes of the remote paths
+	/// \param verify : Check the MD5 checksum of the copies before using them
+	///
+	/// Read the index of the staging directory
+	/// \EndMemberDescr
+
+	TObjArray *prefixes = remotePrefixes.Tokenize(",");
+	for(int i=0; i<prefixes->GetEntries(); ++i){
+		TString prefix = ((TObjString*)prefixes->At(i))->GetString().Strip(TString::kBoth);
+		if(prefix.Length()>0) fRemotePrefixes.push_back(prefix);
+	}
+	delete prefixes;
+
+	gSystem->mkdir(fDirectory, kTRUE);
+	Load();
+}
+
+StagingCache::~StagingCache() {
+	/// \MemberDescr
+	/// Destructor. Stop the copying thread and write the index.
+	/// \EndMemberDescr
+
+	Stop();
+}
+
+bool StagingCache::IsRemote(TString fileName) const {
+	/// \MemberDescr
+	/// \param fileName : Path to the input file
+	/// \return True if the path starts with one of the remote prefixes
+	/// \EndMemberDescr
+
+	for(auto prefix : fRemotePrefixes){
+		if(fileName.BeginsWith(prefix)) return true;
+	}
+	return false;
+}
+
+TString StagingCache::Resolve(TString fileName) {
+	/// \MemberDescr
+	/// \param fileName : Path to the input file
+	/// \return Path of the local copy of the file if it is staged and valid, else fileName
+	///
+	/// A remote file which is not staged (or whose copy is invalid) is queued to be copied
+	/// by Start(). The copy used is recorded in the lease of the job under the index lock, so
+	/// that the concurrent jobs do not remove it before it is opened.
+	/// \EndMemberDescr
+
+	if(!IsRemote(fileName)) return fileName;
+
+	int lock = LockIndex();
+	fMutex.Lock();
+	auto it = fFiles.find(fileName);
+	if(it!=fFiles.end()){
+		TString localPath = fDirectory + "/" + it->second.fLocalName;
+		FileStat_t st;
+		bool valid = gSystem->GetPathInfo(localPath, st)==0 && st.fSize==it->second.fSize;
+		if(valid && fVerify){
+			TMD5 *md5 = TMD5::FileChecksum(localPath);
+			valid = md5 && it->second.fChecksum.CompareTo(md5->AsString())==0;
+			if(md5) delete md5;
+		}
+		if(valid){
+			it->second.fLastUse = time(nullptr);
+			it->second.fInUse = true;
+			++fNHits;
+			WriteLease();
+			fMutex.UnLock();
+			UnlockIndex(lock);
+			std::cout << "Using staged copy " << localPath << " of " << fileName << std::endl;
+			return localPath;
+		}
+		std::cout << "Staged copy " << localPath << " of " << fileName << " is invalid: removed" << std::endl;
+		gSystem->Unlink(localPath);
+		fFiles.erase(it);
+	}
+	if(std::find(fQueue.begin(), fQueue.end(), fileName)==fQueue.end()) fQueue.push_back(fileName);
+	fMutex.UnLock();
+	UnlockIndex(lock);
+	return fileName;
+}
+
+bool StagingCache::Start() {
+	/// \MemberDescr
+	/// \return False if the thread is already running or if there is nothing to copy
+	///
+	/// Start copying the queued remote files in background
+	/// \EndMemberDescr
+
+	if(fThread || fNext>=fQueue.size()) return false;
+
+	TThread::Initialize();
+	ROOT::EnableThreadSafety();
+	fStop = false;
+	fThread = new TThread("StagingCache", (void (*)(void*))&Run, (void*) this);
+	fThread->Run();
+	std::cout << "Staging " << fQueue.size()-fNext << " remote input files in background to " << fDirectory << std::endl;
+	return true;
+}
+
+void StagingCache::Stop() {
+	/// \MemberDescr
+	/// Stop the copying thread once the copy in progress is done, write the index and release
+	/// the lease of the job
+	/// \EndMemberDescr
+
+	if(fThread){
+		fMutex.Lock();
+		fStop = true;
+		fMutex.UnLock();
+		fThread->Join();
+		delete fThread;
+		fThread = nullptr;
+	}
+	Save();
+	int lock = LockIndex();
+	gSystem->Unlink(GetLeaseName());
+	UnlockIndex(lock);
+}
+
+void StagingCache::PrintSummary() {
+	/// \MemberDescr
+	/// Print the number of input files read from the local copies and the number of files copied
+	/// \EndMemberDescr
+
+	fMutex.Lock();
+	std::cout << "Staging cache " << fDirectory << ": " << fNHits << " input files read from local copies, "
+			<< fNCopied << " files copied (" << fBytesCopied/1048576 << " MB), " << fNFailed << " failed, "
+			<< (fNext<fQueue.size() ? fQueue.size()-fNext : 0) << " not copied" << std::endl;
+	fMutex.UnLock();
+}
+
+bool StagingCache::Load() {
+	/// \MemberDescr
+	/// \return False if the index exists but cannot be read
+	///
+	/// Read the index of the staging directory
+	/// \EndMemberDescr
+
+	fFiles.clear();
+	return ReadIndex(fFiles);
+}
+
+bool StagingCache::Save() {
+	/// \MemberDescr
+	/// \return False if the index cannot be written
+	///
+	/// Update the index of the staging directory under the lock shared by the jobs using it
+	/// \EndMemberDescr
+
+	int lock = LockIndex();
+	bool success = WriteIndex();
+	UnlockIndex(lock);
+	return success;
+}
+
+bool StagingCache::ReadIndex(NA62Analysis::NA62Map<TString, StagedFile>::type &files) const {
+	/// \MemberDescr
+	/// \param files : Filled with the staged files of the index
+	/// \return False if the index exists but cannot be read
+	///
+	/// Each line of the index contains: remote path, local name, size, MD5 checksum and time
+	/// of last use (tab separated). The entries whose copy is missing are dropped.
+	/// \EndMemberDescr
+
+	TString indexName = fDirectory + "/staging.index";
+	if(gSystem->AccessPathName(indexName)) return true;
+
+	std::ifstream fd(indexName.Data());
+	if(!fd.is_open()){
+		std::cout << "Unable to read the staging index " << indexName << std::endl;
+		return false;
+	}
+	TString line;
+	while(line.ReadLine(fd)){
+		TObjArray *fields = line.Tokenize("\t");
+		if(fields->GetEntries()==5){
+			StagedFile staged;
+			staged.fLocalName = ((TObjString*)fields->At(1))->GetString();
+			staged.fSize = ((TObjString*)fields->At(2))->GetString().Atoll();
+			staged.fChecksum = ((TObjString*)fields->At(3))->GetString();
+			staged.fLastUse = ((TObjString*)fields->At(4))->GetString().Atoll();
+			staged.fInUse = false;
+			if(!gSystem->AccessPathName(fDirectory + "/" + staged.fLocalName))
+				files[((TObjString*)fields->At(0))->GetString()] = staged;
+		}
+		delete fields;
+	}
+	fd.close();
+	return true;
+}
+
+bool StagingCache::WriteIndex() {
+	/// \MemberDescr
+	/// \return False if the index cannot be written
+	///
+	/// Merge the staged files with the index written in the meantime by concurrent jobs and
+	/// write it in a temporary file which is then renamed, so that concurrent jobs never read
+	/// a partial index. The files of the directory which are not in the index (e.g. left by an
+	/// interrupted job) are never used: they are removed. Called with the index locked.
+	/// \EndMemberDescr
+
+	NA62Analysis::NA62Map<TString, StagedFile>::type files;
+	ReadIndex(files);
+	fMutex.Lock();
+	for(auto &it : fFiles){
+		//Removed by a concurrent job
+		if(gSystem->AccessPathName(fDirectory + "/" + it.second.fLocalName)) continue;
+		auto other = files.find(it.first);
+		if(other==files.end() || other->second.fLastUse<it.second.fLastUse) files[it.first] = it.second;
+	}
+	fMutex.UnLock();
+
+	TString indexName = fDirectory + "/staging.index";
+	TString tmpName = indexName + TString::Format(".%d.tmp", gSystem->GetPid());
+	std::ofstream fd(tmpName.Data());
+	if(!fd.is_open()){
+		std::cout << "Unable to write the staging index " << tmpName << std::endl;
+		return false;
+	}
+	for(auto &it : files){
+		fd << it.first << "\t" << it.second.fLocalName << "\t" << it.second.fSize << "\t"
+				<< it.second.fChecksum << "\t" << it.second.fLastUse << std::endl;
+	}
+	fd.close();
+
+	if(rename(tmpName.Data(), indexName.Data())!=0){
+		std::cout << "Unable to rename " << tmpName << " to " << indexName << std::endl;
+		return false;
+	}
+
+	//The copies in progress (.part) and the index files (staging.*) are kept
+	std::set<TString> localNames;
+	for(auto &it : files) localNames.insert(it.second.fLocalName);
+	void *dir = gSystem->OpenDirectory(fDirectory);
+	if(!dir) return true;
+	while(const char *entry = gSystem->GetDirEntry(dir)){
+		TString name = entry;
+		if(name.CompareTo(".")==0 || name.CompareTo("..")==0 || name.BeginsWith("staging.")
+				|| name.EndsWith(".part") || localNames.count(name)>0) continue;
+		std::cout << "Removing unindexed file " << name << " from the staging directory" << std::endl;
+		gSystem->Unlink(fDirectory + "/" + name);
+	}
+	gSystem->FreeDirectory(dir);
+	return true;
+}
+
+int StagingCache::LockIndex() const {
+	/// \MemberDescr
+	/// \return Descriptor of the lock file, -1 if the lock cannot be taken
+	///
+	/// Take the exclusive lock of the index, shared by the jobs using the staging directory
+	/// \EndMemberDescr
+
+	TString lockName = fDirectory + "/staging.lock";
+	int fd = open(lockName.Data(), O_CREAT | O_RDWR, 0666);
+	if(fd>=0 && flock(fd, LOCK_EX)!=0){
+		close(fd);
+		fd = -1;
+	}
+	if(fd<0) std::cout << "Unable to lock the staging index " << lockName << ": concurrent updates may be lost" << std::endl;
+	return fd;
+}
+
+void StagingCache::UnlockIndex(int fd) {
+	/// \MemberDescr
+	/// \param fd : Descriptor returned by LockIndex
+	/// \EndMemberDescr
+
+	if(fd<0) return;
+	flock(fd, LOCK_UN);
+	close(fd);
+}
+
+TString StagingCache::GetLeaseName() const {
+	/// \MemberDescr
+	/// \return Path of the lease file of the job: staging.lease.<pid>
+	/// \EndMemberDescr
+
+	return fDirectory + TString::Format("/staging.lease.%d", gSystem->GetPid());
+}
+
+bool StagingCache::WriteLease() const {
+	/// \MemberDescr
+	/// \return False if the lease cannot be written
+	///
+	/// Write the local names of the copies used by the current run in the lease file of the
+	/// job. Called with the index locked and fMutex locked.
+	/// \EndMemberDescr
+
+	std::ofstream fd(GetLeaseName().Data());
+	if(!fd.is_open()){
+		std::cout << "Unable to write the staging lease " << GetLeaseName()
+				<< ": the copies used may be removed by concurrent jobs" << std::endl;
+		return false;
+	}
+	for(auto &it : fFiles){
+		if(it.second.fInUse) fd << it.second.fLocalName << std::endl;
+	}
+	fd.close();
+	return true;
+}
+
+void StagingCache::ReadLeases(std::set<TString> &localNames) const {
+	/// \MemberDescr
+	/// \param localNames : Filled with the local names of the copies leased by the other jobs
+	///
+	/// Read the lease files of the other jobs. The leases of the jobs which are no longer
+	/// running are removed. Called with the index locked.
+	/// \EndMemberDescr
+
+	void *dir = gSystem->OpenDirectory(fDirectory);
+	if(!dir) return;
+	while(const char *entry = gSystem->GetDirEntry(dir)){
+		TString name = entry;
+		if(!name.BeginsWith("staging.lease.")) continue;
+		int pid = TString(name(14, name.Length())).Atoi();
+		if(pid==gSystem->GetPid()) continue;
+		if(pid<=0 || (kill(pid, 0)!=0 && errno==ESRCH)){
+			gSystem->Unlink(fDirectory + "/" + name);
+			continue;
+		}
+		std::ifstream fd((fDirectory + "/" + name).Data());
+		TString line;
+		while(line.ReadLine(fd)){
+			if(line.Length()>0) localNames.insert(line);
+		}
+	}
+	gSystem->FreeDirectory(dir);
+}
+
+TString StagingCache::GetLocalName(TString fileName) const {
+	/// \MemberDescr
+	/// \param fileName : Remote path
+	/// \return Name of the copy in the staging directory: MD5 of the remote path followed by
+	/// the name of the file
+	/// \EndMemberDescr
+
+	TMD5 md5;
+	md5.Update((const UChar_t*)fileName.Data(), fileName.Length());
+	md5.Final();
+	TUrl url(fileName, kTRUE);
+	TString localName = TString(md5.AsString())(0, 16);
+	return localName + "_" + gSystem->BaseName(url.GetFile());
+}
+
+bool StagingCache::MakeRoom(Long64_t size) {
+	/// \MemberDescr
+	/// \param size : Size of the file to copy in bytes
+	/// \return False if the file cannot fit in the staging directory
+	///
+	/// Remove the least recently used copies until the file fits in the maximum size. The
+	/// index is read again first, so that the copies staged and used by the concurrent jobs
+	/// are accounted for. The copies used by the current run or leased by another running job
+	/// are kept. Called with the index locked and fMutex locked.
+	/// \EndMemberDescr
+
+	if(size>fMaxSize) return false;
+
+	NA62Analysis::NA62Map<TString, StagedFile>::type files;
+	ReadIndex(files);
+	for(auto &it : files){
+		auto own = fFiles.find(it.first);
+		if(own==fFiles.end()) fFiles[it.first] = it.second;
+		else if(own->second.fLastUse<it.second.fLastUse) own->second.fLastUse = it.second.fLastUse;
+	}
+	std::set<TString> leased;
+	ReadLeases(leased);
+
+	Long64_t totalSize = 0;
+	for(auto it=fFiles.begin(); it!=fFiles.end();){
+		//Removed by a concurrent job
+		if(gSystem->AccessPathName(fDirectory + "/" + it->second.fLocalName)) it = fFiles.erase(it);
+		else totalSize += (it++)->second.fSize;
+	}
+
+	while(totalSize+size>fMaxSize){
+		auto oldest = fFiles.end();
+		for(auto it=fFiles.begin(); it!=fFiles.end(); ++it){
+			if(it->second.fInUse || leased.count(it->second.fLocalName)>0) continue;
+			if(oldest==fFiles.end() || it->second.fLastUse<oldest->second.fLastUse) oldest = it;
+		}
+		if(oldest==fFiles.end()) return false;
+		std::cout << "Removing staged copy of " << oldest->first << std::endl;
+		gSystem->Unlink(fDirectory + "/" + oldest->second.fLocalName);
+		totalSize -= oldest->second.fSize;
+		fFiles.erase(oldest);
+	}
+	return true;
+}
+
+bool StagingCache::Copy(TString fileName, StagedFile &staged) {
+	/// \MemberDescr
+	/// \param fileName : Remote path
+	/// \param staged : Receives the description of the copy
+	/// \return False if the file cannot be copied
+	///
+	/// Read the remote file as raw bytes, write it in a temporary file while computing its
+	/// MD5 checksum, check the checksum of the written file, rename it and add it to the index.
+	/// \EndMemberDescr
+
+	TUrl url(fileName, kTRUE);
+	TString options = url.GetOptions();
+	url.SetOptions(options.Length()>0 ? options + "&filetype=raw" : TString("filetype=raw"));
+	TFile *input = TFile::Open(url.GetUrl(), "READ");
+	if(!input || input->IsZombie()){
+		if(input) delete input;
+		return false;
+	}
+
+	Long64_t size = input->GetSize();
+	int lock = LockIndex();
+	fMutex.Lock();
+	bool room = size>0 && MakeRoom(size);
+	fMutex.UnLock();
+	UnlockIndex(lock);
+	if(!room){
+		std::cout << "No room to stage " << fileName << " (" << size/1048576 << " MB)" << std::endl;
+		input->Close();
+		delete input;
+		return false;
+	}
+
+	staged.fLocalName = GetLocalName(fileName);
+	staged.fSize = size;
+	TString localPath = fDirectory + "/" + staged.fLocalName;
+	TString tmpName = localPath + TString::Format(".%d.part", gSystem->GetPid());
+	FILE *output = fopen(tmpName.Data(), "wb");
+	bool success = output!=nullptr;
+
+	TMD5 md5;
+	std::vector<char> buffer(8*1048576);
+	for(Long64_t pos=0; success && pos<size; pos+=buffer.size()){
+		Int_t length = std::min((Long64_t)buffer.size(), size-pos);
+		success = !input->ReadBuffer(buffer.data(), pos, length)
+				&& fwrite(buffer.data(), 1, length, output)==(size_t)length;
+		if(success) md5.Update((const UChar_t*)buffer.data(), length);
+	}
+	input->Close();
+	delete input;
+	if(output && fclose(output)!=0) success = false;
+	md5.Final();
+	staged.fChecksum = md5.AsString();
+
+	if(success){
+		TMD5 *written = TMD5::FileChecksum(tmpName);
+		success = written && staged.fChecksum.CompareTo(written->AsString())==0;
+		if(written) delete written;
+		if(!success) std::cout << "Checksum mismatch in the staged copy of " << fileName << std::endl;
+	}
+	if(success){
+		//Renamed and indexed together: a concurrent job never sees an unindexed copy
+		lock = LockIndex();
+		success = rename(tmpName.Data(), localPath.Data())==0;
+		if(success){
+			staged.fLastUse = time(nullptr);
+			staged.fInUse = true;
+			fMutex.Lock();
+			fFiles[fileName] = staged;
+			fMutex.UnLock();
+			WriteIndex();
+		}
+		UnlockIndex(lock);
+	}
+	if(!success) gSystem->Unlink(tmpName);
+	return success;
+}
+
+void StagingCache::Run(void* args) {
+	/// \MemberDescr
+	/// \param args : Pointer to the StagingCache instance
+	///
+	/// Copying thread: copy the queued files one after the other until all are copied or
+	/// Stop() is called
+	/// \EndMemberDescr
+
+	StagingCache *cache = static_cast<StagingCache*>(args);
+	TraceRecorder *trace = TraceRecorder::GetInstance();
+	trace->SetThreadName("StagingCache");
+
+	while(true){
+		cache->fMutex.Lock();
+		if(cache->fStop || cache->fNext>=cache->fQueue.size()){
+			cache->fMutex.UnLock();
+			break;
+		}
+		TString fileName = cache->fQueue[cache->fNext++];
+		cache->fMutex.UnLock();
+
+		if(trace->IsEnabled()) trace->Begin("StageFile", "IO");
+		StagedFile staged;
+		bool copied = cache->Copy(fileName, staged);
+		if(trace->IsEnabled()) trace->End("StageFile", "IO");
+
+		cache->fMutex.Lock();
+		if(copied){
+			++cache->fNCopied;
+			cache->fBytesCopied += staged.fSize;
+		}
+		else{
+			++cache->fNFailed;
+			std::cout << "Unable to stage " << fileName << std::endl;
+		}
+		cache->fMutex.UnLock();
+	}
+}
+
+} /* namespace Core */
+} /* namespace NA62Analysis */
@@ -12,6 +12,7 @@ namespace NA62Analysis {
 
 TimeCounter::TimeCounter() :
 	fIsRunning(0),
+	fNCalls(0),
 	fStartTime(),
 	fTotalTime(0)
 {
@@ -21,7 +22,9 @@ TimeCounter::TimeCounter() :
 }
 
 TimeCounter::TimeCounter(bool startNow) :
-	fIsRunning(1),
+	fIsRunning(0),
+	fNCalls(0),
+	fStartTime(),
 	fTotalTime(0)
 {
 	/// \MemberDescr
@@ -30,7 +33,7 @@ TimeCounter::TimeCounter(bool startNow) :
 	/// Start constructor.
 	/// \EndMemberDescr
 
-	if(startNow) gettimeofday(&fStartTime, NULL);
+	if(startNow) Start();
 }
 
 
@@ -45,7 +48,8 @@ void TimeCounter::Start() {
 	/// Start the counter if not already started
 	/// \EndMemberDescr
 	if(IncrementStart()){
-		gettimeofday(&fStartTime, NULL);
+		++fNCalls;
+		fStartTime = GetTime();
 	}
 }
 
@@ -62,6 +66,7 @@ void TimeCounter::Reset() {
 	/// \EndMemberDescr
 	fTotalTime = 0;
 	fIsRunning = 0;
+	fNCalls = 0;
 }
 
 bool TimeCounter::IncrementStart() {
@@ -88,22 +93,28 @@ void TimeCounter::Print() const {
 	/// \MemberDescr
 	/// Print of the internal values of the counter
 	/// \EndMemberDescr
-	std::cout << "Started at: " << fStartTime.tv_sec + fStartTime.tv_usec/1000000. << std::endl;
+	std::cout << "Started at: " << fStartTime.tv_sec + fStartTime.tv_nsec/1000000000. << std::endl;
 	std::cout << "Total time is: " << fTotalTime << std::endl;
 	std::cout << "IsRunning is: " << fIsRunning << std::endl;
+	std::cout << "Number of calls is: " << fNCalls << std::endl;
 }
 
-struct timeval TimeCounter::GetTime() {
+struct timespec TimeCounter::GetTime() {
 	/// \MemberDescr
-	/// \return timeval struct representing the current time
+	/// \return timespec struct representing the current time of the monotonic clock
 	/// \EndMemberDescr
 
-	struct timeval s;
-	gettimeofday(&s, NULL);
+	struct timespec s;
+	clock_gettime(CLOCK_MONOTONIC, &s);
 	return s;
 }
 
-inline float operator-(struct timeval t1, struct timeval t2){
-	return (float)(t1.tv_sec-t2.tv_sec) + (t1.tv_usec-t2.tv_usec)/1000000.;
+double operator-(struct timespec t1, struct timespec t2){
+	/// \MemberDescr
+	/// \param t1 : Later timestamp
+	/// \param t2 : Earlier timestamp
+	/// \return Difference t1-t2 in seconds
+	/// \EndMemberDescr
+	return (double)(t1.tv_sec-t2.tv_sec) + (t1.tv_nsec-t2.tv_nsec)/1000000000.;
 }
 } /* namespace NA62Analysis */
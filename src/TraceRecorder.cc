@@ -0,0 +1,151 @@
+/*
+ * TraceRecorder.cc
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ncl
+ */
+
+#include "TraceRecorder.hh"
+
+#include <iostream>
+#include <iomanip>
+#include <unistd.h>
+
+#include <TThread.h>
+
+namespace NA62Analysis {
+namespace Core {
+
+TraceRecorder *TraceRecorder::fTraceRecorder = 0;
+
+TraceRecorder* TraceRecorder::GetInstance() {
+	/// \MemberDescr
+	/// \return Pointer to the unique instance of TraceRecorder
+	/// \EndMemberDescr
+
+	if(!fTraceRecorder) fTraceRecorder = new TraceRecorder();
+	return fTraceRecorder;
+}
+
+TraceRecorder::TraceRecorder() :
+	fEnabled(false),
+	fFirstRecord(true),
+	fPid(getpid()),
+	fOrigin(TimeCounter::GetTime())
+{
+	/// \MemberDescr
+	/// Default private constructor to ensure uniqueness of the instance
+	/// \EndMemberDescr
+}
+
+TraceRecorder::~TraceRecorder() {
+	/// \MemberDescr
+	/// Destructor. Close the trace file.
+	/// \EndMemberDescr
+
+	Close();
+}
+
+bool TraceRecorder::Open(TString fileName) {
+	/// \MemberDescr
+	/// \param fileName : Path to the trace file
+	/// \return False if the file cannot be opened
+	///
+	/// Open the trace file and start recording. The time origin of the
+	/// trace is the moment this method is called.
+	/// \EndMemberDescr
+
+	fFile.open(fileName.Data(), std::ofstream::out);
+	if(!fFile.is_open()){
+		std::cout << "Unable to open trace file " << fileName << std::endl;
+		return false;
+	}
+	std::cout << "Recording trace in " << fileName << std::endl;
+	fFile << "[";
+	fFile << std::fixed << std::setprecision(3);
+	fFirstRecord = true;
+	fOrigin = TimeCounter::GetTime();
+	fEnabled = true;
+	SetThreadName("Main");
+	return true;
+}
+
+void TraceRecorder::Close() {
+	/// \MemberDescr
+	/// Stop recording and close the trace file
+	/// \EndMemberDescr
+
+	if(!fEnabled) return;
+	fMutex.Lock();
+	fEnabled = false;
+	fFile << std::endl << "]" << std::endl;
+	fFile.close();
+	fMutex.UnLock();
+}
+
+void TraceRecorder::SetThreadName(const TString &name) {
+	/// \MemberDescr
+	/// \param name : Name of the calling thread
+	///
+	/// Name the track of the calling thread in the timeline
+	/// \EndMemberDescr
+
+	if(!fEnabled) return;
+	fMutex.Lock();
+	fFile << (fFirstRecord ? "" : ",") << std::endl
+			<< "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << fPid
+			<< ",\"tid\":" << TThread::SelfId()
+			<< ",\"args\":{\"name\":\"" << Escape(name) << "\"}}";
+	fFirstRecord = false;
+	fMutex.UnLock();
+}
+
+void TraceRecorder::AddRecord(char phase, const TString &name, const char* category,
+		Long64_t iEvent, const TString &detail) {
+	/// \MemberDescr
+	/// \param phase : Trace-event phase ('B' begin, 'E' end, 'i' instant)
+	/// \param name : Name of the event
+	/// \param category : Category of the event
+	/// \param iEvent : Event index attached to the record (not attached if negative)
+	/// \param detail : Additional text attached to the record (not attached if empty)
+	///
+	/// Write one record in the trace file. The timestamp is in microseconds
+	/// since Open() was called.
+	/// \EndMemberDescr
+
+	//Integer arithmetic on the timespec fields: no loss of resolution on long jobs
+	struct timespec now = TimeCounter::GetTime();
+	Long64_t ts = ((Long64_t)(now.tv_sec - fOrigin.tv_sec)*1000000000LL + (now.tv_nsec - fOrigin.tv_nsec))/1000;
+	Long_t tid = TThread::SelfId();
+
+	fMutex.Lock();
+	fFile << (fFirstRecord ? "" : ",") << std::endl
+			<< "{\"name\":\"" << Escape(name) << "\",\"cat\":\"" << category
+			<< "\",\"ph\":\"" << phase << "\",\"ts\":" << ts
+			<< ",\"pid\":" << fPid << ",\"tid\":" << tid;
+	if(phase=='i') fFile << ",\"s\":\"p\"";
+	if(iEvent>=0 || detail.Length()>0){
+		fFile << ",\"args\":{";
+		if(iEvent>=0) fFile << "\"event\":" << iEvent;
+		if(detail.Length()>0) fFile << (iEvent>=0 ? "," : "") << "\"detail\":\"" << Escape(detail) << "\"";
+		fFile << "}";
+	}
+	fFile << "}";
+	fFirstRecord = false;
+	fMutex.UnLock();
+}
+
+TString TraceRecorder::Escape(const TString &s) {
+	/// \MemberDescr
+	/// \param s : String to escape
+	/// \return String with the JSON special characters escaped
+	/// \EndMemberDescr
+
+	TString r(s);
+	r.ReplaceAll("\\", "\\\\");
+	r.ReplaceAll("\"", "\\\"");
+	return r;
+}
+
+} /* namespace Core */
+} /* namespace NA62Analysis */
@@ -12,6 +12,7 @@
 #include "BaseAnalysis.hh"
 #include "CanvasOrganizer.hh"
 #include "IOPrimitive.hh"
+#include "IOColumns.hh"
 #include "TPrimitive.hh"
 #include "PrimitiveReader.hh"
 
@@ -652,6 +653,77 @@ void UserMethods::RequestTree(TString detectorName, TDetectorVEvent *evt,
 		std::cout << user() << "[WARNING] Not reading TTrees" << std::endl;
 }
 
+void UserMethods::RequestProjection(TString detectorName, TString member,
+		TString outputStage) {
+	/// \MemberDescr
+	/// \param detectorName : Name of the Detector branch
+	/// \param member : Data member to read, as the name of its split sub-branch relative to the
+	/// detector branch (e.g. fCandidates.fMomentum, fCandidates.fTime)
+	/// \param outputStage : Name of the tree (Reco, Digis, MC)
+	///
+	/// Request the values of a single data member of the detector events, retrieved as an array
+	/// with GetProjection. If the detector branch is not requested with RequestTree by any
+	/// analyzer, only the split sub-branches of the projected members are read.
+	/// \EndMemberDescr
+
+	if (fParent->IsTreeType())
+		fParent->GetIOTree()->RequestProjection(outputStage, detectorName, member);
+	else if (fParent->IsColumnType()) {
+		TString field = outputStage + ":" + detectorName + "." + member;
+		if (fParent->GetIOColumns()->GetFieldIndex(field) < 0)
+			std::cout << user() << "[WARNING] Column " << field
+					<< " not in the input files" << std::endl;
+	} else
+		std::cout << user() << "[WARNING] Not reading TTrees" << std::endl;
+}
+
+const std::vector<double>& UserMethods::GetProjection(TString detectorName,
+		TString member, TString outputStage) {
+	/// \MemberDescr
+	/// \param detectorName : Name of the Detector branch
+	/// \param member : Data member requested with RequestProjection
+	/// \param outputStage : Name of the tree (Reco, Digis, MC)
+	/// \return Values of the data member for the current event: one value per object for a
+	/// member of the objects of a TClonesArray (e.g. one momentum per candidate)
+	/// \EndMemberDescr
+
+	static const std::vector<double> empty;
+	const std::vector<double> *values = nullptr;
+	if (fParent->IsTreeType())
+		values = fParent->GetIOTree()->GetProjection(outputStage, detectorName, member);
+	if (!values) {
+		std::cout << normal() << "[WARNING] Projection " << detectorName << "." << member
+				<< " not requested" << std::endl;
+		return empty;
+	}
+	return *values;
+}
+
+Core::ColumnView UserMethods::GetColumn(TString detectorName, TString member,
+		TString outputStage) {
+	/// \MemberDescr
+	/// \param detectorName : Name of the Detector branch
+	/// \param member : Data member requested with RequestProjection
+	/// \param outputStage : Name of the tree (Reco, Digis, MC)
+	/// \return View of the values of the data member for the current event, valid until the
+	/// next event. When reading column files (--columns), the view points directly in the
+	/// mapped file; when reading TTrees, it points to the values of the projection.
+	/// \EndMemberDescr
+
+	if (fParent->IsColumnType()) {
+		Core::IOColumns *columns = fParent->GetIOColumns();
+		int field = columns->GetFieldIndex(outputStage + ":" + detectorName + "." + member);
+		if (field < 0) {
+			std::cout << normal() << "[WARNING] Column " << outputStage << ":" << detectorName
+					<< "." << member << " not in the input files" << std::endl;
+			return Core::ColumnView();
+		}
+		return columns->GetValues(field);
+	}
+	const std::vector<double> &values = GetProjection(detectorName, member, outputStage);
+	return Core::ColumnView(values.data(), values.size());
+}
+
 L0TPData* UserMethods::GetL0Data() {
 	/// \MemberDescr
 	/// \return L0TPData object
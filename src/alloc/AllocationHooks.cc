@@ -0,0 +1,79 @@
+/*
+ * AllocationHooks.cc
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: ncl
+ */
+
+// Replacement of the global allocation functions reporting to AllocationCounter, which
+// ignores them unless the calling thread is counting. Only built and linked in the
+// executable with the ALLOCATION_COUNTER build option (NA62AnalysisBuilder.py
+// --count-allocations): the other builds keep the default allocation functions.
+
+#include <cstdlib>
+#include <new>
+
+#include "AllocationCounter.hh"
+
+namespace {
+/// \class AllocationHooks
+/// \Brief
+/// Tell AllocationCounter that the allocation functions are replaced
+/// \EndBrief
+struct AllocationHooks {
+	AllocationHooks() {
+		/// \MemberDescr
+		/// Constructor
+		/// \EndMemberDescr
+		NA62Analysis::Core::AllocationCounter::SetAvailable();
+	}
+} gAllocationHooks;
+}
+
+void* operator new(std::size_t size) {
+	NA62Analysis::Core::AllocationCounter::RecordAllocation(size);
+	if(size==0) size = 1;
+	//Same as the default operator new: call the new handler until the allocation succeeds
+	while(true){
+		void *p = std::malloc(size);
+		if(p) return p;
+		std::new_handler handler = std::get_new_handler();
+		if(!handler) throw std::bad_alloc();
+		handler();
+	}
+}
+
+void* operator new[](std::size_t size) {
+	return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+	try{
+		return operator new(size);
+	}
+	catch(...){
+		return nullptr;
+	}
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+	return operator new(size, std::nothrow);
+}
+
+void operator delete(void* p) noexcept {
+	if(!p) return;
+	NA62Analysis::Core::AllocationCounter::RecordFree();
+	std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+	operator delete(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+	operator delete(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+	operator delete(p);
+}